@@ -0,0 +1,321 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Mini-app: conjugate gradient iteration, dominated by small allreduces.
+   * The matrix is the 1-D Laplacian shifted by EECG_SHIFT on the diagonal,
+   * distributed by blocks of n rows. Each iteration exchanges one boundary
+   * value with each neighbor (EEPROBE_Recv) and computes two dot products with
+   * EEPROBE_Allreduce, so that ranks wait for the slowest one twice per
+   * iteration. Rank 0 prints the time to solution, the number of iterations,
+   * the CPU time of all ranks, the EEProbe sleep time and the final residual.
+   *
+   * mpirun -np 8 ./eecg -n 100000
+   * mpirun -np 8 ./eecg -n 100000 -m disable
+   *
+   * -n rows      rows per rank (10000)
+   * -i count     maximum number of iterations (1000)
+   * -e value     relative residual tolerance (1e-8)
+   * -m enable|disable|auto  micro-sleep mode (enable)
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc, strtol, strtod */
+#include <stdlib.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* strcmp */
+#include <string.h>
+
+/* sqrt */
+#include <math.h>
+
+/* clock_gettime */
+#include <time.h>
+
+/* getopt */
+#include <unistd.h>
+
+/* getrusage */
+#include <sys/resource.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EECG_NB_ROW 10000
+
+#define EECG_NB_ITER 1000
+
+#define EECG_TOLERANCE 1e-8
+
+  /* diagonal shift, bounds the condition number of the matrix */
+#define EECG_SHIFT 0.01
+
+#define EECG_TAG 0
+
+/* ---------------------------------------------------------------------------------- */
+
+static double
+EECG_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+
+}
+
+static double
+EECG_getCpuTime() {
+
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+
+}
+
+static EEPROBE_Enable
+EECG_parseMode(const char * name, int * valid) {
+  if (strcmp(name, "disable") == 0) {
+    return EEPROBE_DISABLE;
+  }
+  if (strcmp(name, "auto") == 0) {
+    return EEPROBE_AUTO;
+  }
+  *valid = *valid && (strcmp(name, "enable") == 0);
+  return EEPROBE_ENABLE;
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * q = A p. p holds n rows with one ghost value at each end, received from
+   * the neighbors, and 0 at the ends of the domain.
+   */
+static void
+EECG_multiply(double * p, double * q, int n, int rank, int nr, EEPROBE_Enable enable) {
+
+  MPI_Request requests[2];
+
+  int errno = MPI_SUCCESS;
+
+  int i = 0;
+
+  requests[0] = requests[1] = MPI_REQUEST_NULL;
+
+  if (rank > 0) {
+    errno = MPI_Isend(&p[1], 1, MPI_DOUBLE, rank - 1, EECG_TAG, MPI_COMM_WORLD, &requests[0]);
+    assert(errno == MPI_SUCCESS);
+  }
+  if (rank < nr - 1) {
+    errno = MPI_Isend(&p[n], 1, MPI_DOUBLE, rank + 1, EECG_TAG, MPI_COMM_WORLD, &requests[1]);
+    assert(errno == MPI_SUCCESS);
+  }
+  if (rank > 0) {
+    errno = EEPROBE_Recv_Switch(&p[0], 1, MPI_DOUBLE, rank - 1, EECG_TAG, MPI_COMM_WORLD,
+				MPI_STATUS_IGNORE, enable);
+    assert(errno == MPI_SUCCESS);
+  }
+  if (rank < nr - 1) {
+    errno = EEPROBE_Recv_Switch(&p[n + 1], 1, MPI_DOUBLE, rank + 1, EECG_TAG, MPI_COMM_WORLD,
+				MPI_STATUS_IGNORE, enable);
+    assert(errno == MPI_SUCCESS);
+  }
+
+  MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+
+  for (i = 1; i <= n; i++) {
+    q[i] = (2.0 + EECG_SHIFT) * p[i] - p[i - 1] - p[i + 1];
+  }
+
+}
+
+static double
+EECG_dot(const double * x, const double * y, int n, EEPROBE_Enable enable) {
+
+  double local = 0.0;
+
+  double global = 0.0;
+
+  int errno = MPI_SUCCESS;
+
+  int i = 0;
+
+  for (i = 1; i <= n; i++) {
+    local += x[i] * y[i];
+  }
+
+  errno = EEPROBE_Allreduce_Switch(&local, &global, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD,
+				   enable);
+  assert(errno == MPI_SUCCESS);
+
+  return global;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  EEPROBE_Enable enable = EEPROBE_ENABLE;
+
+  double * x = NULL;
+
+  double * r = NULL;
+
+  double * p = NULL;
+
+  double * q = NULL;
+
+  double tolerance = EECG_TOLERANCE;
+
+  double local[3];
+
+  double global[3];
+
+  double wall_time = 0.0;
+
+  double rr = 0.0;
+
+  double rr_new = 0.0;
+
+  double rr_start = 0.0;
+
+  double alpha = 0.0;
+
+  double beta = 0.0;
+
+  int n = EECG_NB_ROW;
+
+  int nb_iter = EECG_NB_ITER;
+
+  int valid = 1;
+
+  int option = 0;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int it = 0;
+
+  int i = 0;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  while ((option = getopt(argc, argv, "n:i:e:m:")) != -1) {
+    switch (option) {
+    case 'n': n = strtol(optarg, NULL, 10); break;
+    case 'i': nb_iter = strtol(optarg, NULL, 10); break;
+    case 'e': tolerance = strtod(optarg, NULL); break;
+    case 'm': enable = EECG_parseMode(optarg, &valid); break;
+    default: valid = 0; break;
+    }
+  }
+
+  if (!valid || (n < 1) || (nb_iter < 1) || (tolerance <= 0.0)) {
+    if (rank == 0) {
+      fprintf(stderr, "Usage: mpirun -np <n> %s [-n rows] [-i max_iterations] [-e tolerance] [-m enable|disable|auto]\n", argv[0]);
+    }
+    MPI_Finalize();
+    return 1;
+  }
+
+  /* ghost values at both ends */
+  x = calloc(n + 2, sizeof(double));
+  r = calloc(n + 2, sizeof(double));
+  p = calloc(n + 2, sizeof(double));
+  q = calloc(n + 2, sizeof(double));
+  assert((x != NULL) && (r != NULL) && (p != NULL) && (q != NULL));
+
+  /* x = 0, r = p = b = 1 */
+  for (i = 1; i <= n; i++) {
+    r[i] = p[i] = 1.0;
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  wall_time = EECG_getTime();
+  local[0] = EECG_getCpuTime();
+
+  rr = rr_start = EECG_dot(r, r, n, enable);
+
+  for (it = 0; (it < nb_iter) && (rr > tolerance * tolerance * rr_start); it++) {
+    EECG_multiply(p, q, n, rank, nr, enable);
+    alpha = rr / EECG_dot(p, q, n, enable);
+    for (i = 1; i <= n; i++) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+    }
+    rr_new = EECG_dot(r, r, n, enable);
+    beta = rr_new / rr;
+    rr = rr_new;
+    for (i = 1; i <= n; i++) {
+      p[i] = r[i] + beta * p[i];
+    }
+  }
+
+  wall_time = EECG_getTime() - wall_time;
+
+  local[0] = EECG_getCpuTime() - local[0];
+  /* the sleep times are counted in microseconds */
+  local[1] = EEPROBE_getTotalSleepTimeRecv() / 1e6;
+  local[2] = EEPROBE_getTotalSleepTimeAllreduce() / 1e6;
+
+  MPI_Reduce(local, global, 3, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &wall_time, &wall_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+	     MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    fprintf(stdout, "app cg ranks %d rows %d iterations %d mode %s time_s %.6f cpu_s %.6f sleep_recv_s %.6f sleep_allreduce_s %.6f residual %.6e\n",
+	    nr, n * nr, it,
+	    (enable == EEPROBE_ENABLE) ? "enable" : ((enable == EEPROBE_DISABLE) ? "disable" : "auto"),
+	    wall_time, global[0], global[1], global[2], sqrt(rr / rr_start));
+  }
+
+  free(x);
+  free(r);
+  free(p);
+  free(q);
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
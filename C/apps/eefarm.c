@@ -0,0 +1,321 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Mini-app: master-worker task farm with irregular task times. Rank 0 hands
+   * out tasks one at a time and waits for any result with EEPROBE_Recv from
+   * MPI_ANY_SOURCE. The workers wait for their next task with EEPROBE_Recv and
+   * compute for an exponentially distributed duration. The master is idle
+   * most of the time, and the workers are idle while the master is slow to
+   * answer. Rank 0 prints the time to solution, the CPU time of all ranks, the
+   * EEProbe sleep time and whether all results were received.
+   *
+   * mpirun -np 8 ./eefarm -n 2000 -t 500
+   * mpirun -np 8 ./eefarm -n 2000 -t 500 -m disable
+   *
+   * -n count     number of tasks (1000)
+   * -t us        mean task time (1000)
+   * -r seed      random seed (1)
+   * -m enable|disable|auto  micro-sleep mode (enable)
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc, strtol, rand_r */
+#include <stdlib.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* strcmp */
+#include <string.h>
+
+/* log */
+#include <math.h>
+
+/* clock_gettime */
+#include <time.h>
+
+/* getopt */
+#include <unistd.h>
+
+/* getrusage */
+#include <sys/resource.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEFARM_NB_TASK 1000
+
+#define EEFARM_TASK_TIME_US 1000
+
+#define EEFARM_MASTER 0
+
+#define EEFARM_TAG_TASK 0
+
+#define EEFARM_TAG_RESULT 1
+
+#define EEFARM_TAG_STOP 2
+
+/* ---------------------------------------------------------------------------------- */
+
+  /* task sent to a worker, and result sent back */
+typedef struct {
+  double id;
+  double duration;
+} EEFARM_Task;
+
+/* ---------------------------------------------------------------------------------- */
+
+static double
+EEFARM_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+
+}
+
+static double
+EEFARM_getCpuTime() {
+
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+
+}
+
+static EEPROBE_Enable
+EEFARM_parseMode(const char * name, int * valid) {
+  if (strcmp(name, "disable") == 0) {
+    return EEPROBE_DISABLE;
+  }
+  if (strcmp(name, "auto") == 0) {
+    return EEPROBE_AUTO;
+  }
+  *valid = *valid && (strcmp(name, "enable") == 0);
+  return EEPROBE_ENABLE;
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Compute for the duration of the task, in seconds. Returns the result of
+   * the task, twice its identifier.
+   */
+static double
+EEFARM_compute(const EEFARM_Task * task) {
+
+  volatile double x = 1.0;
+
+  double end = EEFARM_getTime() + task->duration;
+
+  int i = 0;
+
+  while (EEFARM_getTime() < end) {
+    for (i = 0; i < 1000; i++) {
+      x = x * 0.999999 + 0.000001;
+    }
+  }
+
+  return 2.0 * task->id;
+
+}
+
+static void
+EEFARM_worker(EEPROBE_Enable enable) {
+
+  EEFARM_Task task;
+
+  MPI_Status status;
+
+  int errno = MPI_SUCCESS;
+
+  for (;;) {
+    errno = EEPROBE_Recv_Switch(&task, 2, MPI_DOUBLE, EEFARM_MASTER, MPI_ANY_TAG,
+				MPI_COMM_WORLD, &status, enable);
+    assert(errno == MPI_SUCCESS);
+    if (status.MPI_TAG == EEFARM_TAG_STOP) {
+      break;
+    }
+    task.duration = EEFARM_compute(&task);
+    errno = MPI_Send(&task, 2, MPI_DOUBLE, EEFARM_MASTER, EEFARM_TAG_RESULT,
+		     MPI_COMM_WORLD);
+    assert(errno == MPI_SUCCESS);
+  }
+
+}
+
+  /**
+   * Hand out the tasks and check the results. Returns 1 if every result is
+   * correct.
+   */
+static int
+EEFARM_master(int nb_task, double task_time, unsigned int seed, int nr,
+	      EEPROBE_Enable enable) {
+
+  EEFARM_Task task;
+
+  MPI_Status status;
+
+  double uniform = 0.0;
+
+  int nb_sent = 0;
+
+  int nb_result = 0;
+
+  int valid = 1;
+
+  int errno = MPI_SUCCESS;
+
+  int w = 0;
+
+  /* first task of each worker, then one task per result */
+  for (w = 1; w < nr; w++) {
+    if (nb_sent < nb_task) {
+      uniform = ((double) rand_r(&seed) + 1.0) / ((double) RAND_MAX + 1.0);
+      task.id = nb_sent++;
+      task.duration = -task_time * log(uniform);
+      errno = MPI_Send(&task, 2, MPI_DOUBLE, w, EEFARM_TAG_TASK, MPI_COMM_WORLD);
+    } else {
+      errno = MPI_Send(&task, 0, MPI_DOUBLE, w, EEFARM_TAG_STOP, MPI_COMM_WORLD);
+    }
+    assert(errno == MPI_SUCCESS);
+  }
+
+  while (nb_result < nb_task) {
+    errno = EEPROBE_Recv_Switch(&task, 2, MPI_DOUBLE, MPI_ANY_SOURCE, EEFARM_TAG_RESULT,
+				MPI_COMM_WORLD, &status, enable);
+    assert(errno == MPI_SUCCESS);
+    valid = valid && (task.duration == 2.0 * task.id);
+    nb_result++;
+    if (nb_sent < nb_task) {
+      uniform = ((double) rand_r(&seed) + 1.0) / ((double) RAND_MAX + 1.0);
+      task.id = nb_sent++;
+      task.duration = -task_time * log(uniform);
+      errno = MPI_Send(&task, 2, MPI_DOUBLE, status.MPI_SOURCE, EEFARM_TAG_TASK,
+		       MPI_COMM_WORLD);
+    } else {
+      errno = MPI_Send(&task, 0, MPI_DOUBLE, status.MPI_SOURCE, EEFARM_TAG_STOP,
+		       MPI_COMM_WORLD);
+    }
+    assert(errno == MPI_SUCCESS);
+  }
+
+  return valid;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  EEPROBE_Enable enable = EEPROBE_ENABLE;
+
+  unsigned int seed = 1;
+
+  double task_time = EEFARM_TASK_TIME_US;
+
+  double local[2];
+
+  double global[2];
+
+  double wall_time = 0.0;
+
+  int nb_task = EEFARM_NB_TASK;
+
+  int valid = 1;
+
+  int option = 0;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  while ((option = getopt(argc, argv, "n:t:r:m:")) != -1) {
+    switch (option) {
+    case 'n': nb_task = strtol(optarg, NULL, 10); break;
+    case 't': task_time = strtod(optarg, NULL); break;
+    case 'r': seed = strtoul(optarg, NULL, 10); break;
+    case 'm': enable = EEFARM_parseMode(optarg, &valid); break;
+    default: valid = 0; break;
+    }
+  }
+
+  if (!valid || (nr < 2) || (nb_task < 0) || (task_time < 0.0)) {
+    if (rank == 0) {
+      fprintf(stderr, "Usage: mpirun -np <n >= 2> %s [-n tasks] [-t task_time_us] [-r seed] [-m enable|disable|auto]\n", argv[0]);
+    }
+    MPI_Finalize();
+    return 1;
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  wall_time = EEFARM_getTime();
+  local[0] = EEFARM_getCpuTime();
+
+  if (rank == EEFARM_MASTER) {
+    valid = EEFARM_master(nb_task, task_time / 1e6, seed, nr, enable);
+  } else {
+    EEFARM_worker(enable);
+  }
+
+  wall_time = EEFARM_getTime() - wall_time;
+
+  local[0] = EEFARM_getCpuTime() - local[0];
+  /* the sleep time is counted in microseconds */
+  local[1] = EEPROBE_getTotalSleepTimeRecv() / 1e6;
+
+  MPI_Reduce(local, global, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &wall_time, &wall_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+	     MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    fprintf(stdout, "app farm ranks %d tasks %d task_time_us %.0f mode %s time_s %.6f cpu_s %.6f sleep_recv_s %.6f valid %d\n",
+	    nr, nb_task, task_time,
+	    (enable == EEPROBE_ENABLE) ? "enable" : ((enable == EEPROBE_DISABLE) ? "disable" : "auto"),
+	    wall_time, global[0], global[1], valid);
+  }
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
@@ -0,0 +1,418 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Mini-app: 3-D Jacobi stencil with halo exchange. Each rank owns an n^3
+   * block of a Cartesian process grid, exchanges its six faces with its
+   * neighbors at each iteration (MPI_Isend/MPI_Irecv, EEPROBE_Wait) and
+   * computes the global residual every EESTENCIL_RESIDUAL_PERIOD iterations
+   * (EEPROBE_Allreduce). The domain boundary is held at 1. An imbalance makes
+   * the odd ranks work longer, so that their neighbors wait in the halo
+   * exchange. Rank 0 prints the time to solution, the CPU time of all ranks,
+   * the EEProbe sleep time and a checksum of the solution.
+   *
+   * mpirun -np 8 ./eestencil -n 64 -i 200
+   * mpirun -np 8 ./eestencil -n 64 -i 200 -m disable
+   *
+   * -n size      block edge per rank (32)
+   * -i count     number of iterations (100)
+   * -b percent   extra work of the odd ranks (20)
+   * -m enable|disable|auto  micro-sleep mode (enable)
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc, strtol */
+#include <stdlib.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* strcmp */
+#include <string.h>
+
+/* clock_gettime */
+#include <time.h>
+
+/* getopt */
+#include <unistd.h>
+
+/* getrusage */
+#include <sys/resource.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EESTENCIL_SIZE 32
+
+#define EESTENCIL_NB_ITER 100
+
+#define EESTENCIL_IMBALANCE 20
+
+#define EESTENCIL_RESIDUAL_PERIOD 10
+
+#define EESTENCIL_TAG 0
+
+/* ---------------------------------------------------------------------------------- */
+
+static double
+EESTENCIL_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+
+}
+
+static double
+EESTENCIL_getCpuTime() {
+
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+
+}
+
+static EEPROBE_Enable
+EESTENCIL_parseMode(const char * name, int * valid) {
+  if (strcmp(name, "disable") == 0) {
+    return EEPROBE_DISABLE;
+  }
+  if (strcmp(name, "auto") == 0) {
+    return EEPROBE_AUTO;
+  }
+  *valid = *valid && (strcmp(name, "enable") == 0);
+  return EEPROBE_ENABLE;
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Face datatypes of a (n + 2)^3 block: for each dimension, the low and high
+   * layers sent to the neighbors and the low and high ghost layers received.
+   */
+static void
+EESTENCIL_createFaces(int n, MPI_Datatype send[3][2], MPI_Datatype recv[3][2]) {
+
+  int sizes[3] = {n + 2, n + 2, n + 2};
+
+  int subsizes[3];
+
+  int starts[3];
+
+  int d = 0;
+
+  int side = 0;
+
+  for (d = 0; d < 3; d++) {
+    for (side = 0; side < 2; side++) {
+      subsizes[0] = subsizes[1] = subsizes[2] = n;
+      starts[0] = starts[1] = starts[2] = 1;
+      subsizes[d] = 1;
+      starts[d] = (side == 0) ? 1 : n;
+      MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE,
+			       &send[d][side]);
+      MPI_Type_commit(&send[d][side]);
+      starts[d] = (side == 0) ? 0 : n + 1;
+      MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE,
+			       &recv[d][side]);
+      MPI_Type_commit(&recv[d][side]);
+    }
+  }
+
+}
+
+  /**
+   * Exchange the six faces with the neighbors. The receives are completed
+   * with EEPROBE_Wait, where the ranks wait for their slower neighbors.
+   */
+static void
+EESTENCIL_exchange(double * u, int neighbors[3][2], MPI_Datatype send[3][2],
+		   MPI_Datatype recv[3][2], MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request requests[12];
+
+  int errno = MPI_SUCCESS;
+
+  int d = 0;
+
+  int side = 0;
+
+  int i = 0;
+
+  for (d = 0; d < 3; d++) {
+    for (side = 0; side < 2; side++) {
+      errno = MPI_Irecv(u, 1, recv[d][side], neighbors[d][side], EESTENCIL_TAG, comm,
+			&requests[i++]);
+      assert(errno == MPI_SUCCESS);
+      errno = MPI_Isend(u, 1, send[d][side], neighbors[d][side], EESTENCIL_TAG, comm,
+			&requests[i++]);
+      assert(errno == MPI_SUCCESS);
+    }
+  }
+
+  for (i = 0; i < 12; i += 2) {
+    errno = EEPROBE_Wait_Switch(&requests[i], MPI_STATUS_IGNORE, enable);
+    assert(errno == MPI_SUCCESS);
+  }
+
+  for (i = 1; i < 12; i += 2) {
+    errno = MPI_Wait(&requests[i], MPI_STATUS_IGNORE);
+    assert(errno == MPI_SUCCESS);
+  }
+
+}
+
+  /**
+   * One Jacobi sweep from u to v over the first planes of the block. Returns
+   * the squared norm of the update.
+   */
+static double
+EESTENCIL_sweep(const double * u, double * v, int n, int planes) {
+
+  int m = n + 2;
+
+  double delta = 0.0;
+
+  double value = 0.0;
+
+  int i = 0;
+
+  int j = 0;
+
+  int k = 0;
+
+  int c = 0;
+
+  for (i = 1; i <= planes; i++) {
+    for (j = 1; j <= n; j++) {
+      for (k = 1; k <= n; k++) {
+	c = (i * m + j) * m + k;
+	value = (u[c - m * m] + u[c + m * m] + u[c - m] + u[c + m] + u[c - 1] + u[c + 1])
+	  / 6.0;
+	delta += (value - u[c]) * (value - u[c]);
+	v[c] = value;
+      }
+    }
+  }
+
+  return delta;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  MPI_Datatype send[3][2];
+
+  MPI_Datatype recv[3][2];
+
+  EEPROBE_Enable enable = EEPROBE_ENABLE;
+
+  int neighbors[3][2];
+
+  int dims[3] = {0, 0, 0};
+
+  int periods[3] = {0, 0, 0};
+
+  double * u = NULL;
+
+  double * v = NULL;
+
+  double * swap = NULL;
+
+  double local[4];
+
+  double global[4];
+
+  double wall_time = 0.0;
+
+  double residual = 0.0;
+
+  double delta = 0.0;
+
+  double checksum = 0.0;
+
+  int n = EESTENCIL_SIZE;
+
+  int nb_iter = EESTENCIL_NB_ITER;
+
+  int imbalance = EESTENCIL_IMBALANCE;
+
+  int extra = 0;
+
+  int valid = 1;
+
+  int option = 0;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int m = 0;
+
+  int d = 0;
+
+  int side = 0;
+
+  int it = 0;
+
+  int i = 0;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  while ((option = getopt(argc, argv, "n:i:b:m:")) != -1) {
+    switch (option) {
+    case 'n': n = strtol(optarg, NULL, 10); break;
+    case 'i': nb_iter = strtol(optarg, NULL, 10); break;
+    case 'b': imbalance = strtol(optarg, NULL, 10); break;
+    case 'm': enable = EESTENCIL_parseMode(optarg, &valid); break;
+    default: valid = 0; break;
+    }
+  }
+
+  if (!valid || (n < 1) || (nb_iter < 1) || (imbalance < 0)) {
+    if (rank == 0) {
+      fprintf(stderr, "Usage: mpirun -np <n> %s [-n size] [-i iterations] [-b imbalance_percent] [-m enable|disable|auto]\n", argv[0]);
+    }
+    MPI_Finalize();
+    return 1;
+  }
+
+  MPI_Dims_create(nr, 3, dims);
+  MPI_Cart_create(MPI_COMM_WORLD, 3, dims, periods, 0, &comm);
+  for (d = 0; d < 3; d++) {
+    MPI_Cart_shift(comm, d, 1, &neighbors[d][0], &neighbors[d][1]);
+  }
+
+  EESTENCIL_createFaces(n, send, recv);
+
+  m = n + 2;
+  u = calloc((size_t) m * m * m, sizeof(double));
+  v = calloc((size_t) m * m * m, sizeof(double));
+  assert((u != NULL) && (v != NULL));
+
+  /* the ghost layers on the domain boundary hold the boundary value */
+  for (i = 0; i < m * m * m; i++) {
+    d = i / (m * m);
+    side = (i / m) % m;
+    if (((d == 0) && (neighbors[0][0] == MPI_PROC_NULL))
+	|| ((d == m - 1) && (neighbors[0][1] == MPI_PROC_NULL))
+	|| ((side == 0) && (neighbors[1][0] == MPI_PROC_NULL))
+	|| ((side == m - 1) && (neighbors[1][1] == MPI_PROC_NULL))
+	|| (((i % m) == 0) && (neighbors[2][0] == MPI_PROC_NULL))
+	|| (((i % m) == m - 1) && (neighbors[2][1] == MPI_PROC_NULL))) {
+      u[i] = v[i] = 1.0;
+    }
+  }
+
+  /* extra planes swept by the odd ranks */
+  extra = (rank % 2 == 1) ? (n * imbalance) / 100 : 0;
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  wall_time = EESTENCIL_getTime();
+  local[1] = EESTENCIL_getCpuTime();
+
+  for (it = 0; it < nb_iter; it++) {
+
+    EESTENCIL_exchange(u, neighbors, send, recv, comm, enable);
+
+    delta = EESTENCIL_sweep(u, v, n, n);
+    /* the extra sweeps write the same values again */
+    for (i = extra; i > 0; i -= n) {
+      EESTENCIL_sweep(u, v, n, (i < n) ? i : n);
+    }
+
+    if ((it + 1) % EESTENCIL_RESIDUAL_PERIOD == 0) {
+      EEPROBE_Allreduce_Switch(&delta, &residual, 1, MPI_DOUBLE, MPI_SUM, comm, enable);
+    }
+
+    swap = u;
+    u = v;
+    v = swap;
+
+  }
+
+  wall_time = EESTENCIL_getTime() - wall_time;
+
+  for (i = 0; i < m * m * m; i++) {
+    d = i / (m * m);
+    side = (i / m) % m;
+    if ((d >= 1) && (d <= n) && (side >= 1) && (side <= n) && ((i % m) >= 1)
+	&& ((i % m) <= n)) {
+      checksum += u[i];
+    }
+  }
+
+  local[0] = checksum;
+  local[1] = EESTENCIL_getCpuTime() - local[1];
+  /* the sleep times are counted in microseconds */
+  local[2] = EEPROBE_getTotalSleepTimeWait() / 1e6;
+  local[3] = EEPROBE_getTotalSleepTimeAllreduce() / 1e6;
+
+  MPI_Reduce(local, global, 4, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &wall_time, &wall_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+	     MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    fprintf(stdout, "app stencil ranks %d grid %dx%dx%d size %d iterations %d imbalance %d mode %s time_s %.6f cpu_s %.6f sleep_wait_s %.6f sleep_allreduce_s %.6f residual %.6e checksum %.6e\n",
+	    nr, dims[0], dims[1], dims[2], n, nb_iter, imbalance,
+	    (enable == EEPROBE_ENABLE) ? "enable" : ((enable == EEPROBE_DISABLE) ? "disable" : "auto"),
+	    wall_time, global[1], global[2], global[3], residual, global[0]);
+  }
+
+  for (d = 0; d < 3; d++) {
+    for (side = 0; side < 2; side++) {
+      MPI_Type_free(&send[d][side]);
+      MPI_Type_free(&recv[d][side]);
+    }
+  }
+
+  MPI_Comm_free(&comm);
+
+  free(u);
+  free(v);
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
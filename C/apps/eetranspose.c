@@ -0,0 +1,369 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Mini-app: distributed matrix transpose, as in the transpose steps of a
+   * parallel 2-D FFT. An N x N matrix is distributed by blocks of rows, of
+   * uneven sizes when N is not a multiple of the number of ranks. Each
+   * iteration runs a compute pass over the local rows, then transposes the
+   * matrix with EEPROBE_Alltoallv. Rank 0 prints the time to solution, the CPU
+   * time of all ranks, the EEProbe sleep time and whether the final matrix
+   * holds the expected values.
+   *
+   * mpirun -np 8 ./eetranspose -n 2048 -i 20
+   * mpirun -np 8 ./eetranspose -n 2048 -i 20 -m disable
+   *
+   * -n size      matrix size N (1024)
+   * -i count     number of iterations (10)
+   * -c count     compute passes over the local rows per iteration (4)
+   * -m enable|disable|auto  micro-sleep mode (enable)
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc, strtol */
+#include <stdlib.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* strcmp */
+#include <string.h>
+
+/* sqrt, fabs */
+#include <math.h>
+
+/* clock_gettime */
+#include <time.h>
+
+/* getopt */
+#include <unistd.h>
+
+/* getrusage */
+#include <sys/resource.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EETRANSPOSE_SIZE 1024
+
+#define EETRANSPOSE_NB_ITER 10
+
+#define EETRANSPOSE_NB_PASS 4
+
+  /* scaling of the compute pass, checked at the end */
+#define EETRANSPOSE_SCALE 1.000001
+
+/* ---------------------------------------------------------------------------------- */
+
+static double
+EETRANSPOSE_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+
+}
+
+static double
+EETRANSPOSE_getCpuTime() {
+
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+
+}
+
+static EEPROBE_Enable
+EETRANSPOSE_parseMode(const char * name, int * valid) {
+  if (strcmp(name, "disable") == 0) {
+    return EEPROBE_DISABLE;
+  }
+  if (strcmp(name, "auto") == 0) {
+    return EEPROBE_AUTO;
+  }
+  *valid = *valid && (strcmp(name, "enable") == 0);
+  return EEPROBE_ENABLE;
+}
+
+  /* rows of a rank, the first ranks holding one more row when n % nr != 0 */
+static int
+EETRANSPOSE_getNbRow(int n, int nr, int rank) {
+  return n / nr + ((rank < n % nr) ? 1 : 0);
+}
+
+static int
+EETRANSPOSE_getFirstRow(int n, int nr, int rank) {
+  return rank * (n / nr) + ((rank < n % nr) ? rank : n % nr);
+}
+
+static double
+EETRANSPOSE_getInitialValue(int n, int i, int j) {
+  return (double) i * n + j;
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Compute pass: the passes accumulate into a sink, then the rows are scaled
+   * once, so that the final values are known.
+   */
+static void
+EETRANSPOSE_compute(double * a, int nb_row, int n, int nb_pass) {
+
+  volatile double sink = 0.0;
+
+  double sum = 0.0;
+
+  long i = 0;
+
+  int pass = 0;
+
+  for (pass = 0; pass < nb_pass; pass++) {
+    sum = 0.0;
+    for (i = 0; i < (long) nb_row * n; i++) {
+      sum += sqrt(a[i]);
+    }
+    sink += sum;
+  }
+
+  for (i = 0; i < (long) nb_row * n; i++) {
+    a[i] *= EETRANSPOSE_SCALE;
+  }
+
+}
+
+  /**
+   * Transpose the matrix from a to b. The block of a sent to rank d holds the
+   * columns of the rows of d, row by row.
+   */
+static void
+EETRANSPOSE_transpose(const double * a, double * b, double * sendbuf, double * recvbuf,
+		      int * counts, int * displs, int n, int rank, int nr,
+		      EEPROBE_Enable enable) {
+
+  int nb_row = EETRANSPOSE_getNbRow(n, nr, rank);
+
+  int first = 0;
+
+  int cols = 0;
+
+  int errno = MPI_SUCCESS;
+
+  int d = 0;
+
+  int i = 0;
+
+  int j = 0;
+
+  for (d = 0; d < nr; d++) {
+    first = EETRANSPOSE_getFirstRow(n, nr, d);
+    cols = EETRANSPOSE_getNbRow(n, nr, d);
+    counts[d] = nb_row * cols;
+    displs[d] = (d == 0) ? 0 : displs[d - 1] + counts[d - 1];
+    for (i = 0; i < nb_row; i++) {
+      for (j = 0; j < cols; j++) {
+	sendbuf[displs[d] + i * cols + j] = a[(long) i * n + first + j];
+      }
+    }
+  }
+
+  /* each rank sends as many elements to d as it receives from d */
+  errno = EEPROBE_Alltoallv_Switch(sendbuf, counts, displs, MPI_DOUBLE,
+				   recvbuf, counts, displs, MPI_DOUBLE, MPI_COMM_WORLD, enable);
+  assert(errno == MPI_SUCCESS);
+
+  /* the block from s holds rows first..first+rows of s, restricted to my columns */
+  for (d = 0; d < nr; d++) {
+    first = EETRANSPOSE_getFirstRow(n, nr, d);
+    cols = EETRANSPOSE_getNbRow(n, nr, d);
+    for (i = 0; i < cols; i++) {
+      for (j = 0; j < nb_row; j++) {
+	b[(long) j * n + first + i] = recvbuf[displs[d] + i * nb_row + j];
+      }
+    }
+  }
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  EEPROBE_Enable enable = EEPROBE_ENABLE;
+
+  double * a = NULL;
+
+  double * b = NULL;
+
+  double * swap = NULL;
+
+  double * sendbuf = NULL;
+
+  double * recvbuf = NULL;
+
+  int * counts = NULL;
+
+  int * displs = NULL;
+
+  double local[2];
+
+  double global[2];
+
+  double wall_time = 0.0;
+
+  double scale = 1.0;
+
+  double expected = 0.0;
+
+  int n = EETRANSPOSE_SIZE;
+
+  int nb_iter = EETRANSPOSE_NB_ITER;
+
+  int nb_pass = EETRANSPOSE_NB_PASS;
+
+  int nb_row = 0;
+
+  int first = 0;
+
+  int valid = 1;
+
+  int option = 0;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int it = 0;
+
+  int i = 0;
+
+  int j = 0;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  while ((option = getopt(argc, argv, "n:i:c:m:")) != -1) {
+    switch (option) {
+    case 'n': n = strtol(optarg, NULL, 10); break;
+    case 'i': nb_iter = strtol(optarg, NULL, 10); break;
+    case 'c': nb_pass = strtol(optarg, NULL, 10); break;
+    case 'm': enable = EETRANSPOSE_parseMode(optarg, &valid); break;
+    default: valid = 0; break;
+    }
+  }
+
+  if (!valid || (n < nr) || (nb_iter < 1) || (nb_pass < 0)) {
+    if (rank == 0) {
+      fprintf(stderr, "Usage: mpirun -np <n> %s [-n size >= np] [-i iterations] [-c compute_passes] [-m enable|disable|auto]\n", argv[0]);
+    }
+    MPI_Finalize();
+    return 1;
+  }
+
+  nb_row = EETRANSPOSE_getNbRow(n, nr, rank);
+  first = EETRANSPOSE_getFirstRow(n, nr, rank);
+
+  a = malloc((size_t) nb_row * n * sizeof(double));
+  b = malloc((size_t) nb_row * n * sizeof(double));
+  sendbuf = malloc((size_t) nb_row * n * sizeof(double));
+  recvbuf = malloc((size_t) nb_row * n * sizeof(double));
+  counts = malloc(nr * sizeof(int));
+  displs = malloc(nr * sizeof(int));
+  assert((a != NULL) && (b != NULL) && (sendbuf != NULL) && (recvbuf != NULL)
+	 && (counts != NULL) && (displs != NULL));
+
+  for (i = 0; i < nb_row; i++) {
+    for (j = 0; j < n; j++) {
+      a[(long) i * n + j] = EETRANSPOSE_getInitialValue(n, first + i, j);
+    }
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  wall_time = EETRANSPOSE_getTime();
+  local[0] = EETRANSPOSE_getCpuTime();
+
+  for (it = 0; it < nb_iter; it++) {
+    EETRANSPOSE_compute(a, nb_row, n, nb_pass);
+    EETRANSPOSE_transpose(a, b, sendbuf, recvbuf, counts, displs, n, rank, nr, enable);
+    swap = a;
+    a = b;
+    b = swap;
+    scale *= EETRANSPOSE_SCALE;
+  }
+
+  wall_time = EETRANSPOSE_getTime() - wall_time;
+
+  /* transposed an odd number of times: element (i, j) started at (j, i) */
+  for (i = 0; i < nb_row; i++) {
+    for (j = 0; j < n; j++) {
+      expected = scale * ((nb_iter % 2 == 0) ?
+			  EETRANSPOSE_getInitialValue(n, first + i, j) :
+			  EETRANSPOSE_getInitialValue(n, j, first + i));
+      valid = valid && (fabs(a[(long) i * n + j] - expected) <= 1e-9 * (1.0 + expected));
+    }
+  }
+
+  local[0] = EETRANSPOSE_getCpuTime() - local[0];
+  /* the sleep time is counted in microseconds */
+  local[1] = EEPROBE_getTotalSleepTimeAlltoallv() / 1e6;
+
+  MPI_Reduce(local, global, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &wall_time, &wall_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+	     MPI_COMM_WORLD);
+  MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &valid, &valid, 1, MPI_INT, MPI_LAND, 0,
+	     MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    fprintf(stdout, "app transpose ranks %d size %d iterations %d passes %d mode %s time_s %.6f cpu_s %.6f sleep_alltoallv_s %.6f valid %d\n",
+	    nr, n, nb_iter, nb_pass,
+	    (enable == EEPROBE_ENABLE) ? "enable" : ((enable == EEPROBE_DISABLE) ? "disable" : "auto"),
+	    wall_time, global[0], global[1], valid);
+  }
+
+  free(a);
+  free(b);
+  free(sendbuf);
+  free(recvbuf);
+  free(counts);
+  free(displs);
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
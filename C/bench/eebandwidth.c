@@ -0,0 +1,232 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Bandwidth benchmark: rank 0 sends messages of increasing size to rank 1
+   * after a delay, so that rank 1 waits long enough to reach the maximum yield
+   * time, and measures the time until rank 1 acknowledges the message. Rank 1
+   * receives with MPI_Recv (mpi), with EEPROBE_Recv without the progress
+   * schedule (sleep), and with EEPROBE_Recv with the progress schedule
+   * (progress). Each line gives the size in bytes and the bandwidth of each
+   * mode in MB/s:
+   *
+   * mpirun -np 2 ./eebandwidth
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc */
+#include <stdlib.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* clock_gettime, clock_nanosleep */
+#include <time.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEBANDWIDTH_TAG 0
+
+#define EEBANDWIDTH_TAG_ACK 1
+
+#define EEBANDWIDTH_RANK_SEND 0
+
+#define EEBANDWIDTH_RANK_RECV 1
+
+#define EEBANDWIDTH_MIN_SIZE 1024
+
+#define EEBANDWIDTH_MAX_SIZE (64 * 1024 * 1024)
+
+#define EEBANDWIDTH_NB_ITER 10
+
+  /* delay before each send, long enough for the receiver to reach the maximum
+     yield time */
+#define EEBANDWIDTH_DELAY_NS 20000000
+
+#define EEBANDWIDTH_MIN_YIELD_TIME 0
+
+#define EEBANDWIDTH_INC_YIELD_TIME 10000
+
+#define EEBANDWIDTH_MAX_YIELD_TIME 1000000
+
+  /* progress threshold when not set with EEPROBE_PROGRESS */
+#define EEBANDWIDTH_PROGRESS_THRESHOLD 1048576
+
+typedef enum {
+	      EEBANDWIDTH_MPI,
+	      EEBANDWIDTH_SLEEP,
+	      EEBANDWIDTH_PROGRESS,
+	      EEBANDWIDTH_NB_MODE
+} EEBANDWIDTH_Mode;
+
+/* ---------------------------------------------------------------------------------- */
+
+static unsigned long
+EEBANDWIDTH_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (unsigned long) ts.tv_sec * 1000000000UL + ts.tv_nsec;
+
+}
+
+  /**
+   * Returns the bandwidth in MB/s on the sender, 0 on the receiver.
+   */
+static double
+EEBANDWIDTH_run(int rank, char * buffer, int size, EEBANDWIDTH_Mode mode,
+		long progress_threshold, long progress_yield_time) {
+
+  struct timespec delay;
+
+  unsigned long elapsed = 0;
+
+  unsigned long start = 0;
+
+  int ack = 0;
+
+  int i = 0;
+
+  delay.tv_sec = 0;
+  delay.tv_nsec = EEBANDWIDTH_DELAY_NS;
+
+  if (mode == EEBANDWIDTH_SLEEP) {
+    EEPROBE_setProgressParams(0, progress_yield_time);
+  } else {
+    EEPROBE_setProgressParams(progress_threshold, progress_yield_time);
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  for (i = 0; i < EEBANDWIDTH_NB_ITER; i++) {
+
+    if (rank == EEBANDWIDTH_RANK_SEND) {
+
+      clock_nanosleep(CLOCK_MONOTONIC, 0, &delay, NULL);
+      start = EEBANDWIDTH_getTime();
+      MPI_Send(buffer, size, MPI_CHAR, EEBANDWIDTH_RANK_RECV, EEBANDWIDTH_TAG, MPI_COMM_WORLD);
+      MPI_Recv(&ack, 1, MPI_INT, EEBANDWIDTH_RANK_RECV, EEBANDWIDTH_TAG_ACK, MPI_COMM_WORLD,
+	       MPI_STATUS_IGNORE);
+      elapsed += EEBANDWIDTH_getTime() - start;
+
+    } else if (rank == EEBANDWIDTH_RANK_RECV) {
+
+      if (mode == EEBANDWIDTH_MPI) {
+	MPI_Recv(buffer, size, MPI_CHAR, EEBANDWIDTH_RANK_SEND, EEBANDWIDTH_TAG, MPI_COMM_WORLD,
+		 MPI_STATUS_IGNORE);
+      } else {
+	EEPROBE_Recv(buffer, size, MPI_CHAR, EEBANDWIDTH_RANK_SEND, EEBANDWIDTH_TAG, MPI_COMM_WORLD,
+		     MPI_STATUS_IGNORE);
+      }
+      MPI_Send(&ack, 1, MPI_INT, EEBANDWIDTH_RANK_SEND, EEBANDWIDTH_TAG_ACK, MPI_COMM_WORLD);
+
+    }
+
+  }
+
+  if (elapsed == 0) {
+    return 0.0;
+  }
+
+  return ((double) size * EEBANDWIDTH_NB_ITER / 1e6) / ((double) elapsed / 1e9);
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int size = 0;
+
+  int mode = 0;
+
+  char * buffer = NULL;
+
+  double bandwidth[EEBANDWIDTH_NB_MODE];
+
+  long progress_threshold = 0;
+
+  long progress_yield_time = 0;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  EEPROBE_setMinYieldTime(EEBANDWIDTH_MIN_YIELD_TIME);
+  EEPROBE_setIncYieldTime(EEBANDWIDTH_INC_YIELD_TIME);
+  EEPROBE_setMaxYieldTime(EEBANDWIDTH_MAX_YIELD_TIME);
+
+  EEPROBE_getProgressParams(&progress_threshold, &progress_yield_time);
+  if (progress_threshold == 0) {
+    progress_threshold = EEBANDWIDTH_PROGRESS_THRESHOLD;
+  }
+
+  if (nr >= 2) {
+
+    buffer = malloc(EEBANDWIDTH_MAX_SIZE);
+    assert(buffer);
+
+    if (rank == EEBANDWIDTH_RANK_SEND) {
+      fprintf(stdout, "size mpi_mbps sleep_mbps progress_mbps\n");
+    }
+
+    for (size = EEBANDWIDTH_MIN_SIZE; size <= EEBANDWIDTH_MAX_SIZE; size *= 4) {
+      for (mode = 0; mode < EEBANDWIDTH_NB_MODE; mode++) {
+	bandwidth[mode] = EEBANDWIDTH_run(rank, buffer, size, (EEBANDWIDTH_Mode) mode,
+					  progress_threshold, progress_yield_time);
+      }
+      if (rank == EEBANDWIDTH_RANK_SEND) {
+	fprintf(stdout, "%d %.1f %.1f %.1f\n", size, bandwidth[EEBANDWIDTH_MPI],
+		bandwidth[EEBANDWIDTH_SLEEP], bandwidth[EEBANDWIDTH_PROGRESS]);
+	fflush(stdout);
+      }
+    }
+
+    free(buffer);
+
+  } else {
+    fprintf(stdout, "Warning: MPI task nr is %d. Expected >= 2. Usage:\nmpirun -np 2 %s\n",
+	    nr, argv[0]);
+  }
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
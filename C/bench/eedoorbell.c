@@ -0,0 +1,168 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Doorbell benchmark: rank 0 sends a message to every other rank of the node
+   * after a pseudo-random delay, stamped with its CLOCK_MONOTONIC send time.
+   * The receivers return from EEPROBE_Recv and measure the detection latency.
+   * Each rank prints the mean and maximum latency, its sleep time and, with the
+   * doorbell, its doorbell counters. Run with the timer backoff and with the
+   * doorbell to compare:
+   *
+   * mpirun -np 4 ./eedoorbell
+   * mpirun -np 4 ./eedoorbell 10000000
+   */
+
+/* strtol, rand_r */
+#include <stdlib.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* clock_gettime, clock_nanosleep */
+#include <time.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEDOORBELL_TAG 0
+
+#define EEDOORBELL_NB_ITER 200
+
+#define EEDOORBELL_MAX_DELAY_NS 5000000
+
+/* ---------------------------------------------------------------------------------- */
+
+static unsigned long
+EEDOORBELL_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (unsigned long) ts.tv_sec * 1000000000UL + ts.tv_nsec;
+
+}
+
+static void
+EEDOORBELL_sender(int nr) {
+
+  struct timespec delay;
+
+  unsigned int seed = 1;
+
+  unsigned long stamp = 0;
+
+  int i = 0;
+
+  int r = 0;
+
+  for (i = 0; i < EEDOORBELL_NB_ITER; i++) {
+    delay.tv_sec = 0;
+    delay.tv_nsec = rand_r(&seed) % EEDOORBELL_MAX_DELAY_NS;
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &delay, NULL);
+    for (r = 1; r < nr; r++) {
+      stamp = EEDOORBELL_getTime();
+      EEPROBE_Send(&stamp, 1, MPI_UNSIGNED_LONG, r, EEDOORBELL_TAG, MPI_COMM_WORLD);
+    }
+  }
+
+}
+
+static void
+EEDOORBELL_receiver(int rank, int doorbell) {
+
+  EEPROBE_DoorbellStats stats;
+
+  unsigned long stamp = 0;
+
+  unsigned long latency = 0;
+
+  unsigned long sum = 0;
+
+  unsigned long max = 0;
+
+  int i = 0;
+
+  for (i = 0; i < EEDOORBELL_NB_ITER; i++) {
+    EEPROBE_Recv(&stamp, 1, MPI_UNSIGNED_LONG, 0, EEDOORBELL_TAG, MPI_COMM_WORLD,
+		 MPI_STATUS_IGNORE);
+    latency = EEDOORBELL_getTime() - stamp;
+    sum += latency;
+    if (latency > max) {
+      max = latency;
+    }
+  }
+
+  fprintf(stdout, "rank %d %s latency_mean_ns %lu latency_max_ns %lu sleep_time %lu",
+	  rank, doorbell ? "doorbell" : "timer", sum / EEDOORBELL_NB_ITER, max,
+	  EEPROBE_getTotalSleepTimeRecv());
+
+  if (doorbell) {
+    EEPROBE_getDoorbellStats(&stats);
+    fprintf(stdout, " nb_wait %lu nb_timeout %lu", stats.nb_wait, stats.nb_timeout);
+  }
+
+  fprintf(stdout, "\n");
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  long timeout = 0;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  if (argc > 1) {
+    timeout = strtol(argv[1], NULL, 10);
+    EEPROBE_Doorbell_init(MPI_COMM_WORLD, timeout);
+  }
+
+  if (rank == 0) {
+    EEDOORBELL_sender(nr);
+  } else {
+    EEDOORBELL_receiver(rank, timeout > 0);
+  }
+
+  EEPROBE_Doorbell_free();
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
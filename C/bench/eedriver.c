@@ -0,0 +1,936 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Parameterized benchmark driver. Rank 0 releases a message, or enters a
+   * collective, after a gap drawn from an inter-arrival distribution, while
+   * the other ranks wait for it with the EEProbe wrappers (for reduce and
+   * gather, the last rank is late and the root waits). The same random
+   * sequence is drawn on all ranks, and all ranks synchronize with a plain
+   * MPI_Barrier before each gap, so that the latency of a waiting rank is its
+   * time to completion minus the gap, without comparing clocks. In the bursty
+   * distribution, rank 0 releases EEDRIVER_BURST_SIZE operations back to back
+   * after a gap EEDRIVER_BURST_SIZE times longer, and the latency of the first
+   * one is recorded. The ping-pong pattern runs between ranks 0 and 1 alone,
+   * rank 0 sleeps the gap before each ping, and the latency is half the round
+   * trip time.
+   *
+   * For each pattern and message size, rank 0 writes the latency percentiles,
+   * the wall clock time, the CPU time of all ranks (getrusage), the number of
+   * context switches (wake-ups), the EEProbe sleep time and, when the RAPL
+   * counter of the package is readable, the energy of the node, as CSV or JSON.
+   *
+   * mpirun -np 4 ./eedriver -p pingpong,fanout -s 8,1024,65536 -d poisson -g 1000000
+   * mpirun -np 4 ./eedriver -p collectives -m disable -o json -f disable.json
+   *
+   * -p list      comma separated patterns: pingpong fanout reduce allreduce bcast
+   *              barrier alltoall allgather gather scatter, or collectives (pingpong)
+   * -s list      comma separated message sizes in bytes (8)
+   * -d periodic|poisson|bursty  inter-arrival distribution (periodic)
+   * -g ns        mean gap between two releases (1000000)
+   * -n count     number of releases per pattern and size (1000)
+   * -w probe|wait|recv  receive primitive of fanout (recv)
+   * -m enable|disable|auto  micro-sleep mode (enable)
+   * -y min:inc:max[:policy]  yield times in ns and ramp policy (library settings)
+   * -r seed      random seed (1)
+   * -l label     configuration label, generated from -m and -y by default
+   * -o csv|json  output format (csv)
+   * -f file      output file (standard output)
+   *
+   * The EEPROBE_ environment variables apply, EEPROBE_PREDICTOR=1 for instance.
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc, qsort, strtol, rand_r */
+#include <stdlib.h>
+
+/* fprintf, fopen, snprintf */
+#include <stdio.h>
+
+/* strcmp, strtok */
+#include <string.h>
+
+/* log */
+#include <math.h>
+
+/* clock_gettime, clock_nanosleep */
+#include <time.h>
+
+/* getopt */
+#include <unistd.h>
+
+/* getrusage */
+#include <sys/resource.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEDRIVER_TAG 0
+
+#define EEDRIVER_ROOT 0
+
+#define EEDRIVER_NB_ITER 1000
+
+#define EEDRIVER_GAP_NS 1000000
+
+#define EEDRIVER_BURST_SIZE 10
+
+#define EEDRIVER_LIST_SIZE 256
+
+#define EEDRIVER_LABEL_SIZE 128
+
+#define EEDRIVER_RAPL_ENERGY "/sys/class/powercap/intel-rapl:0/energy_uj"
+
+#define EEDRIVER_RAPL_RANGE "/sys/class/powercap/intel-rapl:0/max_energy_range_uj"
+
+/* ---------------------------------------------------------------------------------- */
+
+typedef enum {
+  EEDRIVER_PINGPONG,
+  EEDRIVER_FANOUT,
+  EEDRIVER_REDUCE,
+  EEDRIVER_ALLREDUCE,
+  EEDRIVER_BCAST,
+  EEDRIVER_BARRIER,
+  EEDRIVER_ALLTOALL,
+  EEDRIVER_ALLGATHER,
+  EEDRIVER_GATHER,
+  EEDRIVER_SCATTER,
+  EEDRIVER_NB_PATTERN
+} EEDRIVER_Pattern;
+
+static const char * EEDRIVER_PATTERN_NAME[EEDRIVER_NB_PATTERN] =
+  {"pingpong", "fanout", "reduce", "allreduce", "bcast", "barrier", "alltoall",
+   "allgather", "gather", "scatter"};
+
+typedef enum {
+  EEDRIVER_PERIODIC,
+  EEDRIVER_POISSON,
+  EEDRIVER_BURSTY
+} EEDRIVER_Distribution;
+
+static const char * EEDRIVER_DISTRIBUTION_NAME[] = {"periodic", "poisson", "bursty"};
+
+typedef enum {
+  EEDRIVER_PRIMITIVE_PROBE,
+  EEDRIVER_PRIMITIVE_WAIT,
+  EEDRIVER_PRIMITIVE_RECV
+} EEDRIVER_Primitive;
+
+static const char * EEDRIVER_POLICY_NAME[] = {"linear", "exponential", "constant", "spin"};
+
+static const char * EEDRIVER_MODE_NAME[] = {"enable", "disable", "auto"};
+
+  /**
+   * Settings of a run, identical on all ranks.
+   */
+typedef struct {
+  EEDRIVER_Distribution distribution;
+  EEDRIVER_Primitive primitive;
+  EEPROBE_Enable enable;
+  EEPROBE_Policy policy;
+  double gap;
+  int nb_iter;
+  unsigned int seed;
+  int json;
+  const char * label;
+} EEDRIVER_Settings;
+
+  /**
+   * Measures of one pattern and size, summed over the ranks except the wall
+   * clock time and the energy, measured by rank 0.
+   */
+typedef struct {
+  double latency_mean;
+  unsigned long latency_p50;
+  unsigned long latency_p90;
+  unsigned long latency_p99;
+  unsigned long latency_max;
+  double wall_time;
+  double cpu_time;
+  long nb_wakeup;
+  double sleep_time;
+  double energy;
+} EEDRIVER_Result;
+
+/* ---------------------------------------------------------------------------------- */
+
+static unsigned long
+EEDRIVER_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (unsigned long) ts.tv_sec * 1000000000UL + ts.tv_nsec;
+
+}
+
+static void
+EEDRIVER_sleep(unsigned long duration) {
+
+  struct timespec ts;
+
+  ts.tv_sec = duration / 1000000000UL;
+  ts.tv_nsec = duration % 1000000000UL;
+
+  clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, NULL);
+
+}
+
+static int
+EEDRIVER_compare(const void * a, const void * b) {
+
+  unsigned long x = *((const unsigned long *) a);
+
+  unsigned long y = *((const unsigned long *) b);
+
+  return (x > y) - (x < y);
+
+}
+
+  /**
+   * Gap before the next release. All ranks draw the same sequence from the
+   * same seed.
+   */
+static unsigned long
+EEDRIVER_getGap(const EEDRIVER_Settings * settings, unsigned int * seed) {
+
+  double uniform = 0.0;
+
+  switch (settings->distribution) {
+  case EEDRIVER_POISSON:
+    /* ]0;1] */
+    uniform = ((double) rand_r(seed) + 1.0) / ((double) RAND_MAX + 1.0);
+    return (unsigned long) (-settings->gap * log(uniform));
+  case EEDRIVER_BURSTY:
+    return (unsigned long) (settings->gap * EEDRIVER_BURST_SIZE);
+  default:
+    return (unsigned long) settings->gap;
+  }
+
+}
+
+  /**
+   * CPU time of the process in seconds and number of context switches, as
+   * reported by getrusage.
+   */
+static void
+EEDRIVER_getUsage(double * cpu_time, long * nb_switch) {
+
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  *cpu_time = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+  *nb_switch = usage.ru_nvcsw + usage.ru_nivcsw;
+
+}
+
+  /**
+   * Returns the energy counter of the package in microjoules, or -1 if RAPL is
+   * not available or not readable.
+   */
+static double
+EEDRIVER_readRapl(const char * path) {
+
+  FILE * file = NULL;
+
+  double value = -1.0;
+
+  file = fopen(path, "r");
+  if (file != NULL) {
+    if (fscanf(file, "%lf", &value) != 1) {
+      value = -1.0;
+    }
+    fclose(file);
+  }
+
+  return value;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Wait for the message of the fanout pattern with the selected primitive.
+   */
+static void
+EEDRIVER_receive(const EEDRIVER_Settings * settings, char * buffer, int size) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+
+  int errno = MPI_SUCCESS;
+
+  switch (settings->primitive) {
+  case EEDRIVER_PRIMITIVE_PROBE:
+    errno = EEPROBE_Probe_Switch(EEDRIVER_ROOT, EEDRIVER_TAG, MPI_COMM_WORLD, &status,
+				 settings->enable);
+    assert(errno == MPI_SUCCESS);
+    errno = MPI_Recv(buffer, size, MPI_BYTE, EEDRIVER_ROOT, EEDRIVER_TAG, MPI_COMM_WORLD,
+		     MPI_STATUS_IGNORE);
+    break;
+  case EEDRIVER_PRIMITIVE_WAIT:
+    errno = MPI_Irecv(buffer, size, MPI_BYTE, EEDRIVER_ROOT, EEDRIVER_TAG, MPI_COMM_WORLD,
+		      &request);
+    assert(errno == MPI_SUCCESS);
+    errno = EEPROBE_Wait_Switch(&request, MPI_STATUS_IGNORE, settings->enable);
+    break;
+  default:
+    errno = EEPROBE_Recv_Switch(buffer, size, MPI_BYTE, EEDRIVER_ROOT, EEDRIVER_TAG,
+				MPI_COMM_WORLD, MPI_STATUS_IGNORE, settings->enable);
+    break;
+  }
+
+  assert(errno == MPI_SUCCESS);
+
+}
+
+  /**
+   * Run one operation of a pattern other than ping-pong. Rank 0 sends the
+   * messages of the fanout pattern with plain MPI calls.
+   */
+static void
+EEDRIVER_operate(const EEDRIVER_Settings * settings, EEDRIVER_Pattern pattern,
+		 char * sendbuf, char * recvbuf, int size, int rank, int nr) {
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  EEPROBE_Enable enable = settings->enable;
+
+  int errno = MPI_SUCCESS;
+
+  int r = 0;
+
+  switch (pattern) {
+  case EEDRIVER_FANOUT:
+    if (rank == EEDRIVER_ROOT) {
+      for (r = 0; r < nr; r++) {
+	if (r != EEDRIVER_ROOT) {
+	  errno = MPI_Send(sendbuf, size, MPI_BYTE, r, EEDRIVER_TAG, comm);
+	  assert(errno == MPI_SUCCESS);
+	}
+      }
+    } else {
+      EEDRIVER_receive(settings, recvbuf, size);
+    }
+    break;
+  case EEDRIVER_REDUCE:
+    errno = EEPROBE_Reduce_Switch(sendbuf, recvbuf, size, MPI_BYTE, MPI_BOR, EEDRIVER_ROOT,
+				  comm, enable);
+    break;
+  case EEDRIVER_ALLREDUCE:
+    errno = EEPROBE_Allreduce_Switch(sendbuf, recvbuf, size, MPI_BYTE, MPI_BOR, comm,
+				     enable);
+    break;
+  case EEDRIVER_BCAST:
+    errno = EEPROBE_Bcast_Switch(sendbuf, size, MPI_BYTE, EEDRIVER_ROOT, comm, enable);
+    break;
+  case EEDRIVER_BARRIER:
+    errno = EEPROBE_Barrier_Switch(comm, enable);
+    break;
+  case EEDRIVER_ALLTOALL:
+    errno = EEPROBE_Alltoall_Switch(sendbuf, size, MPI_BYTE, recvbuf, size, MPI_BYTE, comm,
+				    enable);
+    break;
+  case EEDRIVER_ALLGATHER:
+    errno = EEPROBE_Allgather_Switch(sendbuf, size, MPI_BYTE, recvbuf, size, MPI_BYTE, comm,
+				     enable);
+    break;
+  case EEDRIVER_GATHER:
+    errno = EEPROBE_Gather_Switch(sendbuf, size, MPI_BYTE, recvbuf, size, MPI_BYTE,
+				  EEDRIVER_ROOT, comm, enable);
+    break;
+  case EEDRIVER_SCATTER:
+    errno = EEPROBE_Scatter_Switch(sendbuf, size, MPI_BYTE, recvbuf, size, MPI_BYTE,
+				   EEDRIVER_ROOT, comm, enable);
+    break;
+  default:
+    break;
+  }
+
+  assert(errno == MPI_SUCCESS);
+
+}
+
+  /**
+   * Rank releasing the operation. Reduce and gather complete on the other
+   * ranks without waiting for the root, so that the root waits for the last
+   * rank instead.
+   */
+static int
+EEDRIVER_getLateRank(EEDRIVER_Pattern pattern, int nr) {
+  if ((pattern == EEDRIVER_REDUCE) || (pattern == EEDRIVER_GATHER)) {
+    return nr - 1;
+  }
+  return EEDRIVER_ROOT;
+}
+
+static int
+EEDRIVER_isWaiting(EEDRIVER_Pattern pattern, int rank, int nr) {
+  if ((pattern == EEDRIVER_REDUCE) || (pattern == EEDRIVER_GATHER)) {
+    return rank == EEDRIVER_ROOT;
+  }
+  return rank != EEDRIVER_ROOT;
+}
+
+  /**
+   * Run a pattern other than ping-pong and record the latency of the waiting
+   * ranks. Returns the number of samples.
+   */
+static int
+EEDRIVER_runReleases(const EEDRIVER_Settings * settings, EEDRIVER_Pattern pattern,
+		     char * sendbuf, char * recvbuf, int size, int rank, int nr,
+		     unsigned long * samples) {
+
+  unsigned int seed = settings->seed;
+
+  unsigned long start = 0;
+
+  unsigned long gap = 0;
+
+  unsigned long elapsed = 0;
+
+  int burst = (settings->distribution == EEDRIVER_BURSTY) ? EEDRIVER_BURST_SIZE : 1;
+
+  int nb_sample = 0;
+
+  int i = 0;
+
+  int b = 0;
+
+  for (i = 0; i < settings->nb_iter; i++) {
+
+    gap = EEDRIVER_getGap(settings, &seed);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = EEDRIVER_getTime();
+
+    if (rank == EEDRIVER_getLateRank(pattern, nr)) {
+      EEDRIVER_sleep(gap);
+    }
+
+    for (b = 0; b < burst; b++) {
+      EEDRIVER_operate(settings, pattern, sendbuf, recvbuf, size, rank, nr);
+      if ((b == 0) && EEDRIVER_isWaiting(pattern, rank, nr)) {
+	/* a rank leaving the barrier late may see less than the gap */
+	elapsed = EEDRIVER_getTime() - start;
+	samples[nb_sample++] = (elapsed > gap) ? elapsed - gap : 0;
+      }
+    }
+
+  }
+
+  return nb_sample;
+
+}
+
+  /**
+   * Ping-pong between ranks 0 and 1, both waiting with EEPROBE_Recv. Returns
+   * the number of samples, recorded by rank 0.
+   */
+static int
+EEDRIVER_runPingpong(const EEDRIVER_Settings * settings, char * buffer, int size,
+		     int rank, unsigned long * samples) {
+
+  unsigned int seed = settings->seed;
+
+  unsigned long start = 0;
+
+  unsigned long gap = 0;
+
+  int burst = (settings->distribution == EEDRIVER_BURSTY) ? EEDRIVER_BURST_SIZE : 1;
+
+  int errno = MPI_SUCCESS;
+
+  int i = 0;
+
+  int b = 0;
+
+  for (i = 0; i < settings->nb_iter; i++) {
+
+    gap = EEDRIVER_getGap(settings, &seed);
+
+    for (b = 0; b < burst; b++) {
+      if (rank == 0) {
+	if (b == 0) {
+	  EEDRIVER_sleep(gap);
+	}
+	start = EEDRIVER_getTime();
+	errno = MPI_Send(buffer, size, MPI_BYTE, 1, EEDRIVER_TAG, MPI_COMM_WORLD);
+	assert(errno == MPI_SUCCESS);
+	errno = EEPROBE_Recv_Switch(buffer, size, MPI_BYTE, 1, EEDRIVER_TAG, MPI_COMM_WORLD,
+				    MPI_STATUS_IGNORE, settings->enable);
+	assert(errno == MPI_SUCCESS);
+	if (b == 0) {
+	  samples[i] = (EEDRIVER_getTime() - start) / 2;
+	}
+      } else if (rank == 1) {
+	errno = EEPROBE_Recv_Switch(buffer, size, MPI_BYTE, 0, EEDRIVER_TAG, MPI_COMM_WORLD,
+				    MPI_STATUS_IGNORE, settings->enable);
+	assert(errno == MPI_SUCCESS);
+	errno = MPI_Send(buffer, size, MPI_BYTE, 0, EEDRIVER_TAG, MPI_COMM_WORLD);
+	assert(errno == MPI_SUCCESS);
+      }
+    }
+
+  }
+
+  return (rank == 0) ? settings->nb_iter : 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Run a pattern with a message size on all ranks, and compute the result on
+   * rank 0.
+   */
+static void
+EEDRIVER_run(const EEDRIVER_Settings * settings, EEDRIVER_Pattern pattern, int size,
+	     int rank, int nr, EEDRIVER_Result * result) {
+
+  char * sendbuf = NULL;
+
+  char * recvbuf = NULL;
+
+  unsigned long * samples = NULL;
+
+  unsigned long * all_samples = NULL;
+
+  int * counts = NULL;
+
+  int * displs = NULL;
+
+  int nb_sample = 0;
+
+  int total = 0;
+
+  double sum = 0.0;
+
+  double cpu_start = 0.0;
+
+  double cpu_end = 0.0;
+
+  double local[2];
+
+  double global[2];
+
+  long switch_start = 0;
+
+  long switch_end = 0;
+
+  long nb_switch = 0;
+
+  unsigned long sleep_start = 0;
+
+  unsigned long wall_start = 0;
+
+  double energy_start = 0.0;
+
+  double energy_end = 0.0;
+
+  double range = 0.0;
+
+  int i = 0;
+
+  sendbuf = calloc((size_t) size * nr + 1, 1);
+  recvbuf = calloc((size_t) size * nr + 1, 1);
+  samples = malloc(settings->nb_iter * sizeof(unsigned long));
+  assert((sendbuf != NULL) && (recvbuf != NULL) && (samples != NULL));
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  energy_start = EEDRIVER_readRapl(EEDRIVER_RAPL_ENERGY);
+  EEDRIVER_getUsage(&cpu_start, &switch_start);
+  sleep_start = EEPROBE_getTotalSleepTime();
+  wall_start = EEDRIVER_getTime();
+
+  if (pattern == EEDRIVER_PINGPONG) {
+    if (rank <= 1) {
+      nb_sample = EEDRIVER_runPingpong(settings, sendbuf, size, rank, samples);
+    }
+    /* the ranks left out of the ping-pong are idle waiters as well */
+    EEPROBE_Barrier_Switch(MPI_COMM_WORLD, settings->enable);
+  } else {
+    nb_sample = EEDRIVER_runReleases(settings, pattern, sendbuf, recvbuf, size, rank, nr,
+				     samples);
+    MPI_Barrier(MPI_COMM_WORLD);
+  }
+
+  result->wall_time = (EEDRIVER_getTime() - wall_start) / 1e9;
+  EEDRIVER_getUsage(&cpu_end, &switch_end);
+  energy_end = EEDRIVER_readRapl(EEDRIVER_RAPL_ENERGY);
+
+  local[0] = cpu_end - cpu_start;
+  /* the sleep time is counted in microseconds */
+  local[1] = (EEPROBE_getTotalSleepTime() - sleep_start) / 1e6;
+  nb_switch = switch_end - switch_start;
+
+  MPI_Reduce(local, global, 2, MPI_DOUBLE, MPI_SUM, EEDRIVER_ROOT, MPI_COMM_WORLD);
+  MPI_Reduce(&nb_switch, &result->nb_wakeup, 1, MPI_LONG, MPI_SUM, EEDRIVER_ROOT,
+	     MPI_COMM_WORLD);
+  result->cpu_time = global[0];
+  result->sleep_time = global[1];
+
+  result->energy = -1.0;
+  if ((energy_start >= 0.0) && (energy_end >= 0.0)) {
+    if (energy_end < energy_start) {
+      range = EEDRIVER_readRapl(EEDRIVER_RAPL_RANGE);
+      energy_end += (range > 0.0) ? range : 0.0;
+    }
+    result->energy = (energy_end - energy_start) / 1e6;
+  }
+
+  /* gather the latency samples on rank 0 */
+  if (rank == EEDRIVER_ROOT) {
+    counts = malloc(nr * sizeof(int));
+    displs = malloc(nr * sizeof(int));
+    assert((counts != NULL) && (displs != NULL));
+  }
+
+  MPI_Gather(&nb_sample, 1, MPI_INT, counts, 1, MPI_INT, EEDRIVER_ROOT, MPI_COMM_WORLD);
+
+  if (rank == EEDRIVER_ROOT) {
+    for (i = 0; i < nr; i++) {
+      displs[i] = total;
+      total += counts[i];
+    }
+    all_samples = malloc((total + 1) * sizeof(unsigned long));
+    assert(all_samples != NULL);
+  }
+
+  MPI_Gatherv(samples, nb_sample, MPI_UNSIGNED_LONG, all_samples, counts, displs,
+	      MPI_UNSIGNED_LONG, EEDRIVER_ROOT, MPI_COMM_WORLD);
+
+  if ((rank == EEDRIVER_ROOT) && (total > 0)) {
+    qsort(all_samples, total, sizeof(unsigned long), EEDRIVER_compare);
+    for (i = 0; i < total; i++) {
+      sum += all_samples[i];
+    }
+    result->latency_mean = sum / total;
+    result->latency_p50 = all_samples[total / 2];
+    result->latency_p90 = all_samples[(total * 90) / 100];
+    result->latency_p99 = all_samples[(total * 99) / 100];
+    result->latency_max = all_samples[total - 1];
+  }
+
+  free(all_samples);
+  free(counts);
+  free(displs);
+  free(samples);
+  free(sendbuf);
+  free(recvbuf);
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+static void
+EEDRIVER_print(FILE * out, const EEDRIVER_Settings * settings, EEDRIVER_Pattern pattern,
+	       int size, int nr, const EEDRIVER_Result * result, int first) {
+
+  const char * format = NULL;
+
+  if (settings->json) {
+    format = "%s  {\"config\": \"%s\", \"pattern\": \"%s\", \"distribution\": \"%s\", "
+      "\"bytes\": %d, \"gap_ns\": %.0f, \"iterations\": %d, \"ranks\": %d, "
+      "\"mode\": \"%s\", \"min_yield_ns\": %ld, \"inc_yield_ns\": %ld, "
+      "\"max_yield_ns\": %ld, \"policy\": \"%s\", \"latency_mean_ns\": %.0f, "
+      "\"latency_p50_ns\": %lu, \"latency_p90_ns\": %lu, \"latency_p99_ns\": %lu, "
+      "\"latency_max_ns\": %lu, \"wall_s\": %.6f, \"cpu_s\": %.6f, \"cpu_util\": %.4f, "
+      "\"wakeups\": %ld, \"sleep_s\": %.6f, \"energy_j\": %.3f}";
+  } else {
+    format = "%s%s,%s,%s,%d,%.0f,%d,%d,%s,%ld,%ld,%ld,%s,%.0f,%lu,%lu,%lu,%lu,"
+      "%.6f,%.6f,%.4f,%ld,%.6f,%.3f\n";
+  }
+
+  fprintf(out, format, settings->json ? (first ? "" : ",\n") : "", settings->label,
+	  EEDRIVER_PATTERN_NAME[pattern], EEDRIVER_DISTRIBUTION_NAME[settings->distribution],
+	  size, settings->gap, settings->nb_iter, nr, EEDRIVER_MODE_NAME[settings->enable],
+	  EEPROBE_getMinYieldTime(), EEPROBE_getIncYieldTime(), EEPROBE_getMaxYieldTime(),
+	  EEDRIVER_POLICY_NAME[settings->policy], result->latency_mean, result->latency_p50,
+	  result->latency_p90, result->latency_p99, result->latency_max, result->wall_time,
+	  result->cpu_time, result->cpu_time / (result->wall_time * nr), result->nb_wakeup,
+	  result->sleep_time, result->energy);
+  fflush(out);
+
+}
+
+static int
+EEDRIVER_parsePattern(const char * name, EEDRIVER_Pattern * pattern) {
+
+  int p = 0;
+
+  for (p = 0; p < EEDRIVER_NB_PATTERN; p++) {
+    if (strcmp(name, EEDRIVER_PATTERN_NAME[p]) == 0) {
+      *pattern = p;
+      return 1;
+    }
+  }
+
+  return 0;
+
+}
+
+static int
+EEDRIVER_parsePolicy(const char * name, EEPROBE_Policy * policy) {
+
+  if (strcmp(name, "linear") == 0) {
+    *policy = EEPROBE_POLICY_LINEAR;
+  } else if (strcmp(name, "exponential") == 0) {
+    *policy = EEPROBE_POLICY_EXPONENTIAL;
+  } else if (strcmp(name, "constant") == 0) {
+    *policy = EEPROBE_POLICY_CONSTANT;
+  } else if (strcmp(name, "spin") == 0) {
+    *policy = EEPROBE_POLICY_SPIN;
+  } else {
+    return 0;
+  }
+
+  return 1;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  EEDRIVER_Settings settings;
+
+  EEDRIVER_Result result;
+
+  EEDRIVER_Pattern patterns[EEDRIVER_NB_PATTERN * EEDRIVER_LIST_SIZE];
+
+  int sizes[EEDRIVER_LIST_SIZE];
+
+  char pattern_list[EEDRIVER_LIST_SIZE] = "pingpong";
+
+  char size_list[EEDRIVER_LIST_SIZE] = "8";
+
+  char policy_name[EEDRIVER_LABEL_SIZE] = "";
+
+  char label[EEDRIVER_LABEL_SIZE] = "";
+
+  const char * path = NULL;
+
+  char * name = NULL;
+
+  FILE * out = stdout;
+
+  long min_yield_time = -1;
+
+  long inc_yield_time = -1;
+
+  long max_yield_time = -1;
+
+  int nb_pattern = 0;
+
+  int nb_size = 0;
+
+  int valid = 1;
+
+  int option = 0;
+
+  int first = 1;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int p = 0;
+
+  int s = 0;
+
+  int a = 0;
+
+  settings.distribution = EEDRIVER_PERIODIC;
+  settings.primitive = EEDRIVER_PRIMITIVE_RECV;
+  settings.enable = EEPROBE_ENABLE;
+  settings.policy = EEPROBE_POLICY_LINEAR;
+  settings.gap = EEDRIVER_GAP_NS;
+  settings.nb_iter = EEDRIVER_NB_ITER;
+  settings.seed = 1;
+  settings.json = 0;
+  settings.label = NULL;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  while ((option = getopt(argc, argv, "p:s:d:g:n:w:m:y:r:l:o:f:")) != -1) {
+    switch (option) {
+    case 'p': snprintf(pattern_list, sizeof(pattern_list), "%s", optarg); break;
+    case 's': snprintf(size_list, sizeof(size_list), "%s", optarg); break;
+    case 'd':
+      if (strcmp(optarg, "poisson") == 0) {
+	settings.distribution = EEDRIVER_POISSON;
+      } else if (strcmp(optarg, "bursty") == 0) {
+	settings.distribution = EEDRIVER_BURSTY;
+      } else {
+	valid = valid && (strcmp(optarg, "periodic") == 0);
+      }
+      break;
+    case 'g': settings.gap = strtod(optarg, NULL); break;
+    case 'n': settings.nb_iter = strtol(optarg, NULL, 10); break;
+    case 'w':
+      if (strcmp(optarg, "probe") == 0) {
+	settings.primitive = EEDRIVER_PRIMITIVE_PROBE;
+      } else if (strcmp(optarg, "wait") == 0) {
+	settings.primitive = EEDRIVER_PRIMITIVE_WAIT;
+      } else {
+	valid = valid && (strcmp(optarg, "recv") == 0);
+      }
+      break;
+    case 'm':
+      if (strcmp(optarg, "disable") == 0) {
+	settings.enable = EEPROBE_DISABLE;
+      } else if (strcmp(optarg, "auto") == 0) {
+	settings.enable = EEPROBE_AUTO;
+      } else {
+	valid = valid && (strcmp(optarg, "enable") == 0);
+      }
+      break;
+    case 'y':
+      policy_name[0] = '\0';
+      valid = valid && (sscanf(optarg, "%ld:%ld:%ld:%127s", &min_yield_time,
+			       &inc_yield_time, &max_yield_time, policy_name) >= 3);
+      if (policy_name[0] != '\0') {
+	valid = valid && EEDRIVER_parsePolicy(policy_name, &settings.policy);
+      }
+      break;
+    case 'r': settings.seed = strtoul(optarg, NULL, 10); break;
+    case 'l': snprintf(label, sizeof(label), "%s", optarg); break;
+    case 'o': settings.json = (strcmp(optarg, "json") == 0); break;
+    case 'f': path = optarg; break;
+    default: valid = 0; break;
+    }
+  }
+
+  for (name = strtok(pattern_list, ","); name != NULL; name = strtok(NULL, ",")) {
+    if (strcmp(name, "collectives") == 0) {
+      for (p = EEDRIVER_REDUCE; p < EEDRIVER_NB_PATTERN; p++) {
+	patterns[nb_pattern++] = p;
+      }
+    } else if ((nb_pattern < EEDRIVER_LIST_SIZE)
+	       && EEDRIVER_parsePattern(name, &patterns[nb_pattern])) {
+      nb_pattern++;
+    } else {
+      valid = 0;
+    }
+  }
+
+  for (name = strtok(size_list, ","); (name != NULL) && (nb_size < EEDRIVER_LIST_SIZE);
+       name = strtok(NULL, ",")) {
+    sizes[nb_size] = strtol(name, NULL, 10);
+    valid = valid && (sizes[nb_size] >= 0);
+    nb_size++;
+  }
+
+  valid = valid && (nr >= 2) && (settings.nb_iter > 0) && (settings.gap >= 0.0);
+
+  if (!valid) {
+    if (rank == 0) {
+      fprintf(stderr, "Usage: mpirun -np <n >= 2> %s [-p patterns] [-s sizes] [-d periodic|poisson|bursty] [-g gap_ns] [-n count] [-w probe|wait|recv] [-m enable|disable|auto] [-y min:inc:max[:policy]] [-r seed] [-l label] [-o csv|json] [-f file]\n", argv[0]);
+    }
+    MPI_Finalize();
+    return 1;
+  }
+
+  if (min_yield_time >= 0) {
+    EEPROBE_setMinYieldTime(min_yield_time);
+    EEPROBE_setIncYieldTime(inc_yield_time);
+    EEPROBE_setMaxYieldTime(max_yield_time);
+    if (policy_name[0] != '\0') {
+      for (a = 0; a < EEPROBE_NB_ACTION; a++) {
+	EEPROBE_setActionParams(a, min_yield_time, inc_yield_time, max_yield_time,
+				settings.policy);
+      }
+    }
+  }
+
+  if (label[0] == '\0') {
+    snprintf(label, sizeof(label), "%s-%s-%ld:%ld:%ld", EEDRIVER_MODE_NAME[settings.enable],
+	     EEDRIVER_POLICY_NAME[settings.policy], EEPROBE_getMinYieldTime(),
+	     EEPROBE_getIncYieldTime(), EEPROBE_getMaxYieldTime());
+  }
+  settings.label = label;
+
+  if (rank == 0) {
+    if (path != NULL) {
+      out = fopen(path, "w");
+      assert(out != NULL);
+    }
+    if (settings.json) {
+      fprintf(out, "[\n");
+    } else {
+      fprintf(out, "config,pattern,distribution,bytes,gap_ns,iterations,ranks,mode,"
+	      "min_yield_ns,inc_yield_ns,max_yield_ns,policy,latency_mean_ns,latency_p50_ns,"
+	      "latency_p90_ns,latency_p99_ns,latency_max_ns,wall_s,cpu_s,cpu_util,wakeups,"
+	      "sleep_s,energy_j\n");
+    }
+  }
+
+  for (p = 0; p < nb_pattern; p++) {
+    for (s = 0; s < nb_size; s++) {
+      /* the barrier moves no data */
+      if ((patterns[p] == EEDRIVER_BARRIER) && (s > 0)) {
+	break;
+      }
+      memset(&result, 0, sizeof(EEDRIVER_Result));
+      EEDRIVER_run(&settings, patterns[p], (patterns[p] == EEDRIVER_BARRIER) ? 0 : sizes[s],
+		   rank, nr, &result);
+      if (rank == 0) {
+	EEDRIVER_print(out, &settings, patterns[p],
+		       (patterns[p] == EEDRIVER_BARRIER) ? 0 : sizes[s], nr, &result, first);
+	first = 0;
+      }
+    }
+  }
+
+  if (rank == 0) {
+    if (settings.json) {
+      fprintf(out, "\n]\n");
+    }
+    if (out != stdout) {
+      fclose(out);
+    }
+  }
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
@@ -0,0 +1,236 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * MPI-IO benchmark, run on a local filesystem: rank 0 writes and reads a
+   * large block while the other ranks move a small one, with the collective
+   * _at_all wrappers, so that the other ranks wait for rank 0. The data read
+   * back is checked. The individual, _at and shared-pointer wrappers are then
+   * exercised once. Each rank prints the sleep time and the bytes moved per
+   * second of sleep of the collective write and read:
+   *
+   * mpirun -np 4 ./eeio /tmp/eeio.dat
+   * mpirun -np 4 ./eeio /tmp/eeio.dat disable
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc */
+#include <stdlib.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* strcmp */
+#include <string.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEIO_LARGE_COUNT (32 * 1024 * 1024)
+
+#define EEIO_SMALL_COUNT 4096
+
+#define EEIO_NB_ITER 4
+
+/* ---------------------------------------------------------------------------------- */
+
+static void
+EEIO_fill(char * buffer, int count, int rank, int iter) {
+
+  int i = 0;
+
+  for (i = 0; i < count; i++) {
+    buffer[i] = (char) (rank + iter + i);
+  }
+
+}
+
+static int
+EEIO_check(const char * buffer, int count, int rank, int iter) {
+
+  int i = 0;
+
+  for (i = 0; i < count; i++) {
+    if (buffer[i] != (char) (rank + iter + i)) {
+      return 0;
+    }
+  }
+
+  return 1;
+
+}
+
+  /**
+   * Collective write and read back with the _at_all wrappers. Rank r writes
+   * its block after the blocks of the ranks before it.
+   */
+static int
+EEIO_collective(MPI_File fh, int rank, int nr, char * buffer, EEPROBE_Enable enable) {
+
+  MPI_Offset offset = 0;
+
+  int count = (rank == 0) ? EEIO_LARGE_COUNT : EEIO_SMALL_COUNT;
+
+  int valid = 1;
+
+  int i = 0;
+
+  if (rank > 0) {
+    offset = EEIO_LARGE_COUNT + (MPI_Offset) (rank - 1) * EEIO_SMALL_COUNT;
+  }
+
+  for (i = 0; i < EEIO_NB_ITER; i++) {
+    EEIO_fill(buffer, count, rank, i);
+    EEPROBE_File_write_at_all_Switch(fh, offset, buffer, count, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+    memset(buffer, 0, count);
+    EEPROBE_File_read_at_all_Switch(fh, offset, buffer, count, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+    valid = valid && EEIO_check(buffer, count, rank, i);
+  }
+
+  return valid;
+
+}
+
+  /**
+   * Exercise the individual, _at, _all, shared and ordered wrappers once.
+   */
+static int
+EEIO_others(MPI_File fh, int rank, char * buffer, EEPROBE_Enable enable) {
+
+  MPI_Offset offset = (MPI_Offset) rank * EEIO_SMALL_COUNT;
+
+  int valid = 1;
+
+  EEIO_fill(buffer, EEIO_SMALL_COUNT, rank, 0);
+  EEPROBE_File_write_at_Switch(fh, offset, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+  MPI_Barrier(MPI_COMM_WORLD);
+  memset(buffer, 0, EEIO_SMALL_COUNT);
+  EEPROBE_File_read_at_Switch(fh, offset, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+  valid = valid && EEIO_check(buffer, EEIO_SMALL_COUNT, rank, 0);
+
+  MPI_File_seek(fh, offset, MPI_SEEK_SET);
+  EEPROBE_File_read_Switch(fh, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+  valid = valid && EEIO_check(buffer, EEIO_SMALL_COUNT, rank, 0);
+
+  MPI_File_seek(fh, offset, MPI_SEEK_SET);
+  EEPROBE_File_write_Switch(fh, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+  MPI_File_seek(fh, offset, MPI_SEEK_SET);
+  EEPROBE_File_read_all_Switch(fh, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+  valid = valid && EEIO_check(buffer, EEIO_SMALL_COUNT, rank, 0);
+  MPI_File_seek(fh, offset, MPI_SEEK_SET);
+  EEPROBE_File_write_all_Switch(fh, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+
+  /* ordered then shared-pointer accesses, each rank moving the same amount */
+  MPI_File_seek_shared(fh, 0, MPI_SEEK_SET);
+  EEPROBE_File_write_ordered_Switch(fh, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+  MPI_File_seek_shared(fh, 0, MPI_SEEK_SET);
+  EEPROBE_File_read_ordered_Switch(fh, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+  valid = valid && EEIO_check(buffer, EEIO_SMALL_COUNT, rank, 0);
+  MPI_File_seek_shared(fh, 0, MPI_SEEK_SET);
+  EEPROBE_File_write_shared_Switch(fh, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_File_seek_shared(fh, 0, MPI_SEEK_SET);
+  EEPROBE_File_read_shared_Switch(fh, buffer, EEIO_SMALL_COUNT, MPI_CHAR, MPI_STATUS_IGNORE, enable);
+
+  return valid;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  MPI_File fh;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int valid = 0;
+
+  char * buffer = NULL;
+
+  EEPROBE_Enable enable = EEPROBE_ENABLE;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  if (argc < 2) {
+    if (rank == 0) {
+      fprintf(stdout, "Usage:\nmpirun -np 4 %s file\nmpirun -np 4 %s file disable\n", argv[0], argv[0]);
+    }
+    MPI_Finalize();
+    return 0;
+  }
+
+  if ((argc > 2) && (strcmp(argv[2], "disable") == 0)) {
+    enable = EEPROBE_DISABLE;
+  }
+
+  buffer = malloc(EEIO_LARGE_COUNT);
+  assert(buffer);
+
+  MPI_File_open(MPI_COMM_WORLD, argv[1], MPI_MODE_CREATE | MPI_MODE_RDWR,
+		MPI_INFO_NULL, &fh);
+
+  valid = EEIO_collective(fh, rank, nr, buffer, enable);
+
+  /* sync-barrier-sync, the next accesses overlap the block of rank 0 */
+  MPI_File_sync(fh);
+  MPI_Barrier(MPI_COMM_WORLD);
+  MPI_File_sync(fh);
+
+  valid = EEIO_others(fh, rank, buffer, enable) && valid;
+
+  MPI_File_close(&fh);
+
+  fprintf(stdout, "rank %d %s write_at_all sleep %lu bytes %lu bytes_per_sleep_s %.0f read_at_all sleep %lu bytes %lu bytes_per_sleep_s %.0f\n",
+	  rank, valid ? "valid" : "INVALID",
+	  EEPROBE_getTotalSleepTimeFileWriteAtAll(), EEPROBE_getFileBytes(EEPROBE_FILE_WRITE_AT_ALL),
+	  EEPROBE_getFileBytesPerSleep(EEPROBE_FILE_WRITE_AT_ALL),
+	  EEPROBE_getTotalSleepTimeFileReadAtAll(), EEPROBE_getFileBytes(EEPROBE_FILE_READ_AT_ALL),
+	  EEPROBE_getFileBytesPerSleep(EEPROBE_FILE_READ_AT_ALL));
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    MPI_File_delete(argv[1], MPI_INFO_NULL);
+  }
+
+  free(buffer);
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
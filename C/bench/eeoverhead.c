@@ -0,0 +1,1078 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Wrapper overhead benchmark: measures the time spent in each wrapper of
+   * eeprobe.h when the operation is immediately ready, so that no micro-sleep
+   * takes place and only the cost of the wrapper itself remains. Every wrapper
+   * is called through its _Switch function with EEPROBE_DISABLE, EEPROBE_ENABLE
+   * and EEPROBE_AUTO, and compared to the plain MPI routine. Readiness is
+   * arranged before each call and outside of the timed region: receives are
+   * pre-posted, messages are sent to the calling process itself and windows
+   * are exposed to it.
+   *
+   * The wrappers run on MPI_COMM_WORLD, then on MPI_COMM_SELF on rank 0 alone.
+   * On more than one process, the collective rows also include the arrival
+   * skew between processes, the self rows give the cost of the wrapper alone.
+   * The eeoverhead_noinst binary is built with EEPROBE_ENABLE_TOTAL_SLEEP_TIME
+   * set to 0, to compare with the instrumentation turned off. Results are
+   * written by rank 0 in CSV format, in ns per call, the timer overhead being
+   * subtracted:
+   *
+   * mpirun -np 1 ./eeoverhead > overhead.csv
+   * mpirun -np 1 ./eeoverhead_noinst | tail -n +2 >> overhead.csv
+   * mpirun -np 4 ./eeoverhead 10000 /tmp/eeoverhead.dat
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc, atoi, qsort */
+#include <stdlib.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* clock_gettime */
+#include <time.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEOVERHEAD_TAG 0
+
+#define EEOVERHEAD_COUNT 1
+
+#define EEOVERHEAD_NB_ITER 10000
+
+#define EEOVERHEAD_NB_WARMUP 100
+
+#define EEOVERHEAD_FILE "/tmp/eeoverhead.dat"
+
+#if MPI_VERSION >= 4
+#define EEOVERHEAD_NB_PARTITION 4
+#endif
+
+/* ---------------------------------------------------------------------------------- */
+
+typedef enum {
+  EEOVERHEAD_MPI,
+  EEOVERHEAD_DISABLE,
+  EEOVERHEAD_ENABLE,
+  EEOVERHEAD_AUTO,
+  EEOVERHEAD_NB_VARIANT
+} EEOVERHEAD_Variant;
+
+static const char * EEOVERHEAD_VARIANT_NAME[EEOVERHEAD_NB_VARIANT] =
+  {"mpi", "disable", "enable", "auto"};
+
+  /* the MPI variant does not call the _Switch functions */
+static const EEPROBE_Enable EEOVERHEAD_VARIANT_ENABLE[EEOVERHEAD_NB_VARIANT] =
+  {EEPROBE_DISABLE, EEPROBE_DISABLE, EEPROBE_ENABLE, EEPROBE_AUTO};
+
+  /**
+   * Everything the wrappers operate on, for one communicator. request and
+   * pending are started by the setup hooks and completed by the cleanup hooks.
+   */
+typedef struct {
+  MPI_Comm comm;
+  int rank;
+  int nr;
+  int iteration;
+  int * sendbuf;
+  int * recvbuf;
+  int * counts;
+  int * displs;
+  MPI_Datatype * types;
+  MPI_Request request;
+  MPI_Request pending;
+  MPI_File fh;
+  MPI_Offset region;
+  MPI_Win passive_win;
+  int * passive_base;
+  MPI_Win active_win;
+  int * active_base;
+  MPI_Group self_group;
+#if MPI_VERSION >= 4
+  MPI_Request psend;
+  MPI_Request precv;
+  int partitions[EEOVERHEAD_NB_PARTITION];
+#endif
+} EEOVERHEAD_Context;
+
+typedef void (*EEOVERHEAD_Hook)(EEOVERHEAD_Context * ctx);
+
+typedef int (*EEOVERHEAD_Call)(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant);
+
+  /**
+   * One benchmarked wrapper. start and finish run once around the iterations
+   * of a variant, setup and cleanup around each call. Hooks may be NULL.
+   */
+typedef struct {
+  const char * name;
+  EEOVERHEAD_Call call;
+  EEOVERHEAD_Hook setup;
+  EEOVERHEAD_Hook cleanup;
+  EEOVERHEAD_Hook start;
+  EEOVERHEAD_Hook finish;
+} EEOVERHEAD_Wrapper;
+
+/* ---------------------------------------------------------------------------------- */
+
+static unsigned long
+EEOVERHEAD_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (unsigned long) ts.tv_sec * 1000000000UL + ts.tv_nsec;
+
+}
+
+static int
+EEOVERHEAD_compare(const void * a, const void * b) {
+
+  unsigned long x = *((const unsigned long *) a);
+
+  unsigned long y = *((const unsigned long *) b);
+
+  return (x > y) - (x < y);
+
+}
+
+  /**
+   * Median of the time taken by two consecutive reads of the clock, subtracted
+   * from every sample.
+   */
+static unsigned long
+EEOVERHEAD_getTimerOverhead(unsigned long * samples, int n) {
+
+  unsigned long start = 0;
+
+  int i = 0;
+
+  for (i = 0; i < n; i++) {
+    start = EEOVERHEAD_getTime();
+    samples[i] = EEOVERHEAD_getTime() - start;
+  }
+
+  qsort(samples, n, sizeof(unsigned long), EEOVERHEAD_compare);
+
+  return samples[n / 2];
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /* point-to-point: messages are sent by the calling process to itself */
+
+static void
+EEOVERHEAD_postRecv(EEOVERHEAD_Context * ctx) {
+  MPI_Irecv(ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, EEOVERHEAD_TAG,
+	    ctx->comm, &ctx->request);
+}
+
+static void
+EEOVERHEAD_postSend(EEOVERHEAD_Context * ctx) {
+  MPI_Isend(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, EEOVERHEAD_TAG,
+	    ctx->comm, &ctx->request);
+}
+
+static void
+EEOVERHEAD_postBoth(EEOVERHEAD_Context * ctx) {
+  EEOVERHEAD_postRecv(ctx);
+  MPI_Isend(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, EEOVERHEAD_TAG,
+	    ctx->comm, &ctx->pending);
+}
+
+static void
+EEOVERHEAD_waitRequest(EEOVERHEAD_Context * ctx) {
+  MPI_Wait(&ctx->request, MPI_STATUS_IGNORE);
+}
+
+static void
+EEOVERHEAD_waitPending(EEOVERHEAD_Context * ctx) {
+  MPI_Wait(&ctx->pending, MPI_STATUS_IGNORE);
+}
+
+static void
+EEOVERHEAD_receiveProbed(EEOVERHEAD_Context * ctx) {
+  MPI_Recv(ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, EEOVERHEAD_TAG,
+	   ctx->comm, MPI_STATUS_IGNORE);
+  MPI_Wait(&ctx->request, MPI_STATUS_IGNORE);
+}
+
+static int
+EEOVERHEAD_probe(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Probe(ctx->rank, EEOVERHEAD_TAG, ctx->comm, MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_Probe_Switch(ctx->rank, EEOVERHEAD_TAG, ctx->comm, MPI_STATUS_IGNORE,
+			      EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_probeAny(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+
+  EEPROBE_Pattern pattern;
+
+  int index = 0;
+
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Probe(ctx->rank, EEOVERHEAD_TAG, ctx->comm, MPI_STATUS_IGNORE);
+  }
+
+  pattern.source = ctx->rank;
+  pattern.tag = EEOVERHEAD_TAG;
+  pattern.comm = ctx->comm;
+
+  return EEPROBE_Probe_any_Switch(&pattern, 1, NULL, &index, MPI_STATUS_IGNORE,
+				  EEOVERHEAD_VARIANT_ENABLE[variant]);
+
+}
+
+static int
+EEOVERHEAD_wait(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Wait(&ctx->request, MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_Wait_Switch(&ctx->request, MPI_STATUS_IGNORE,
+			     EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_recv(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Recv(ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, EEOVERHEAD_TAG,
+		    ctx->comm, MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_Recv_Switch(ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank,
+			     EEOVERHEAD_TAG, ctx->comm, MPI_STATUS_IGNORE,
+			     EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_send(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Send(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, EEOVERHEAD_TAG,
+		    ctx->comm);
+  }
+  return EEPROBE_Send_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank,
+			     EEOVERHEAD_TAG, ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_ssend(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Ssend(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, EEOVERHEAD_TAG,
+		     ctx->comm);
+  }
+  return EEPROBE_Ssend_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank,
+			      EEOVERHEAD_TAG, ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_rsend(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Rsend(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, EEOVERHEAD_TAG,
+		     ctx->comm);
+  }
+  return EEPROBE_Rsend_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank,
+			      EEOVERHEAD_TAG, ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /* collectives: the processes are synchronized before each call */
+
+static void
+EEOVERHEAD_synchronize(EEOVERHEAD_Context * ctx) {
+  MPI_Barrier(ctx->comm);
+}
+
+static int
+EEOVERHEAD_reduce(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Reduce(ctx->sendbuf, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, MPI_SUM, 0,
+		      ctx->comm);
+  }
+  return EEPROBE_Reduce_Switch(ctx->sendbuf, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+			       MPI_SUM, 0, ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_allreduce(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Allreduce(ctx->sendbuf, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, MPI_SUM,
+			 ctx->comm);
+  }
+  return EEPROBE_Allreduce_Switch(ctx->sendbuf, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+				  MPI_SUM, ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_alltoall(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Alltoall(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+			ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->comm);
+  }
+  return EEPROBE_Alltoall_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+				 ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->comm,
+				 EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_alltoallv(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Alltoallv(ctx->sendbuf, ctx->counts, ctx->displs, MPI_INT,
+			 ctx->recvbuf, ctx->counts, ctx->displs, MPI_INT, ctx->comm);
+  }
+  return EEPROBE_Alltoallv_Switch(ctx->sendbuf, ctx->counts, ctx->displs, MPI_INT,
+				  ctx->recvbuf, ctx->counts, ctx->displs, MPI_INT,
+				  ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_alltoallw(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Alltoallw(ctx->sendbuf, ctx->counts, ctx->displs, ctx->types,
+			 ctx->recvbuf, ctx->counts, ctx->displs, ctx->types, ctx->comm);
+  }
+  return EEPROBE_Alltoallw_Switch(ctx->sendbuf, ctx->counts, ctx->displs, ctx->types,
+				  ctx->recvbuf, ctx->counts, ctx->displs, ctx->types,
+				  ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_bcast(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Bcast(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, 0, ctx->comm);
+  }
+  return EEPROBE_Bcast_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, 0, ctx->comm,
+			      EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_scatter(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Scatter(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+		       ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, 0, ctx->comm);
+  }
+  return EEPROBE_Scatter_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+				ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, 0, ctx->comm,
+				EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_scatterv(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Scatterv(ctx->sendbuf, ctx->counts, ctx->displs, MPI_INT,
+			ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, 0, ctx->comm);
+  }
+  return EEPROBE_Scatterv_Switch(ctx->sendbuf, ctx->counts, ctx->displs, MPI_INT,
+				 ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, 0, ctx->comm,
+				 EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_gather(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Gather(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+		      ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, 0, ctx->comm);
+  }
+  return EEPROBE_Gather_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+			       ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, 0, ctx->comm,
+			       EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_gatherv(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Gatherv(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+		       ctx->recvbuf, ctx->counts, ctx->displs, MPI_INT, 0, ctx->comm);
+  }
+  return EEPROBE_Gatherv_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+				ctx->recvbuf, ctx->counts, ctx->displs, MPI_INT, 0,
+				ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_allgather(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Allgather(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+			 ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->comm);
+  }
+  return EEPROBE_Allgather_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+				  ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->comm,
+				  EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_allgatherv(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Allgatherv(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+			  ctx->recvbuf, ctx->counts, ctx->displs, MPI_INT, ctx->comm);
+  }
+  return EEPROBE_Allgatherv_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+				   ctx->recvbuf, ctx->counts, ctx->displs, MPI_INT,
+				   ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_barrier(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Barrier(ctx->comm);
+  }
+  return EEPROBE_Barrier_Switch(ctx->comm, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * MPI-IO: each process writes to and reads from its own region of the file,
+   * one element per call. Operations on the shared file pointer start at the
+   * beginning of the file.
+   */
+
+static MPI_Offset
+EEOVERHEAD_getOffset(EEOVERHEAD_Context * ctx) {
+  return ctx->region * ctx->rank + (MPI_Offset) (ctx->iteration * sizeof(int));
+}
+
+static void
+EEOVERHEAD_seek(EEOVERHEAD_Context * ctx) {
+  MPI_File_seek(ctx->fh, ctx->region * ctx->rank, MPI_SEEK_SET);
+}
+
+static void
+EEOVERHEAD_seekShared(EEOVERHEAD_Context * ctx) {
+  MPI_File_seek_shared(ctx->fh, 0, MPI_SEEK_SET);
+}
+
+static int
+EEOVERHEAD_fileWrite(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_write(ctx->fh, ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+			  MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_write_Switch(ctx->fh, ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+				   MPI_STATUS_IGNORE, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileWriteAt(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_write_at(ctx->fh, EEOVERHEAD_getOffset(ctx), ctx->sendbuf,
+			     EEOVERHEAD_COUNT, MPI_INT, MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_write_at_Switch(ctx->fh, EEOVERHEAD_getOffset(ctx), ctx->sendbuf,
+				      EEOVERHEAD_COUNT, MPI_INT, MPI_STATUS_IGNORE,
+				      EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileWriteAll(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_write_all(ctx->fh, ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+			      MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_write_all_Switch(ctx->fh, ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+				       MPI_STATUS_IGNORE, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileWriteAtAll(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_write_at_all(ctx->fh, EEOVERHEAD_getOffset(ctx), ctx->sendbuf,
+				 EEOVERHEAD_COUNT, MPI_INT, MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_write_at_all_Switch(ctx->fh, EEOVERHEAD_getOffset(ctx), ctx->sendbuf,
+					  EEOVERHEAD_COUNT, MPI_INT, MPI_STATUS_IGNORE,
+					  EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileWriteShared(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_write_shared(ctx->fh, ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+				 MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_write_shared_Switch(ctx->fh, ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+					  MPI_STATUS_IGNORE,
+					  EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileWriteOrdered(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_write_ordered(ctx->fh, ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+				  MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_write_ordered_Switch(ctx->fh, ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT,
+					   MPI_STATUS_IGNORE,
+					   EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileRead(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_read(ctx->fh, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+			 MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_read_Switch(ctx->fh, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+				  MPI_STATUS_IGNORE, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileReadAt(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_read_at(ctx->fh, EEOVERHEAD_getOffset(ctx), ctx->recvbuf,
+			    EEOVERHEAD_COUNT, MPI_INT, MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_read_at_Switch(ctx->fh, EEOVERHEAD_getOffset(ctx), ctx->recvbuf,
+				     EEOVERHEAD_COUNT, MPI_INT, MPI_STATUS_IGNORE,
+				     EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileReadAll(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_read_all(ctx->fh, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+			     MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_read_all_Switch(ctx->fh, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+				      MPI_STATUS_IGNORE, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileReadAtAll(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_read_at_all(ctx->fh, EEOVERHEAD_getOffset(ctx), ctx->recvbuf,
+				EEOVERHEAD_COUNT, MPI_INT, MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_read_at_all_Switch(ctx->fh, EEOVERHEAD_getOffset(ctx), ctx->recvbuf,
+					 EEOVERHEAD_COUNT, MPI_INT, MPI_STATUS_IGNORE,
+					 EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileReadShared(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_read_shared(ctx->fh, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+				MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_read_shared_Switch(ctx->fh, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+					 MPI_STATUS_IGNORE,
+					 EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_fileReadOrdered(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_File_read_ordered(ctx->fh, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+				 MPI_STATUS_IGNORE);
+  }
+  return EEPROBE_File_read_ordered_Switch(ctx->fh, ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT,
+					  MPI_STATUS_IGNORE,
+					  EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * One-sided communication: request-based operations target the window of
+   * the calling process, in a passive target epoch opened once. The active
+   * target window is exposed to the calling process alone for Win_wait.
+   */
+
+static int
+EEOVERHEAD_rput(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+
+  MPI_Request request = MPI_REQUEST_NULL;
+
+  if (variant == EEOVERHEAD_MPI) {
+    MPI_Rput(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, 0, EEOVERHEAD_COUNT,
+	     MPI_INT, ctx->passive_win, &request);
+    return MPI_Wait(&request, MPI_STATUS_IGNORE);
+  }
+
+  return EEPROBE_Rput_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, 0,
+			     EEOVERHEAD_COUNT, MPI_INT, ctx->passive_win,
+			     EEOVERHEAD_VARIANT_ENABLE[variant]);
+
+}
+
+static int
+EEOVERHEAD_rget(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+
+  MPI_Request request = MPI_REQUEST_NULL;
+
+  if (variant == EEOVERHEAD_MPI) {
+    MPI_Rget(ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, 0, EEOVERHEAD_COUNT,
+	     MPI_INT, ctx->passive_win, &request);
+    return MPI_Wait(&request, MPI_STATUS_IGNORE);
+  }
+
+  return EEPROBE_Rget_Switch(ctx->recvbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, 0,
+			     EEOVERHEAD_COUNT, MPI_INT, ctx->passive_win,
+			     EEOVERHEAD_VARIANT_ENABLE[variant]);
+
+}
+
+static int
+EEOVERHEAD_raccumulate(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+
+  MPI_Request request = MPI_REQUEST_NULL;
+
+  if (variant == EEOVERHEAD_MPI) {
+    MPI_Raccumulate(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, 0,
+		    EEOVERHEAD_COUNT, MPI_INT, MPI_SUM, ctx->passive_win, &request);
+    return MPI_Wait(&request, MPI_STATUS_IGNORE);
+  }
+
+  return EEPROBE_Raccumulate_Switch(ctx->sendbuf, EEOVERHEAD_COUNT, MPI_INT, ctx->rank, 0,
+				    EEOVERHEAD_COUNT, MPI_INT, MPI_SUM, ctx->passive_win,
+				    EEOVERHEAD_VARIANT_ENABLE[variant]);
+
+}
+
+static int
+EEOVERHEAD_winWaitFlag(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+
+  volatile int * flag = &(ctx->passive_base[EEOVERHEAD_COUNT]);
+
+  int err = MPI_SUCCESS;
+
+  if (variant == EEOVERHEAD_MPI) {
+    do {
+      err = MPI_Win_sync(ctx->passive_win);
+    } while ((err == MPI_SUCCESS) && (*flag != 1));
+    return err;
+  }
+
+  return EEPROBE_Win_wait_flag_Switch(flag, 1, ctx->passive_win,
+				      EEOVERHEAD_VARIANT_ENABLE[variant]);
+
+}
+
+static void
+EEOVERHEAD_exposeSelf(EEOVERHEAD_Context * ctx) {
+  MPI_Win_post(ctx->self_group, 0, ctx->active_win);
+  MPI_Win_start(ctx->self_group, 0, ctx->active_win);
+  MPI_Win_complete(ctx->active_win);
+}
+
+static int
+EEOVERHEAD_winWait(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Win_wait(ctx->active_win);
+  }
+  return EEPROBE_Win_wait_Switch(ctx->active_win, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+static int
+EEOVERHEAD_winFence(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+  if (variant == EEOVERHEAD_MPI) {
+    return MPI_Win_fence(0, ctx->active_win);
+  }
+  return EEPROBE_Win_fence_Switch(0, ctx->active_win, EEOVERHEAD_VARIANT_ENABLE[variant]);
+}
+
+  /* close the fence epochs, so that the next variant starts from a clean window */
+static void
+EEOVERHEAD_closeFence(EEOVERHEAD_Context * ctx) {
+  MPI_Win_fence(MPI_MODE_NOSUCCEED, ctx->active_win);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+#if MPI_VERSION >= 4
+
+  /**
+   * Partitioned communication: a persistent partitioned send to the calling
+   * process, all partitions being marked ready before the partition is waited
+   * for.
+   */
+
+static void
+EEOVERHEAD_initPartitioned(EEOVERHEAD_Context * ctx) {
+
+  int p = 0;
+
+  MPI_Precv_init(ctx->recvbuf, EEOVERHEAD_NB_PARTITION, 1, MPI_INT, ctx->rank,
+		 EEOVERHEAD_TAG, ctx->comm, MPI_INFO_NULL, &ctx->precv);
+  MPI_Psend_init(ctx->sendbuf, EEOVERHEAD_NB_PARTITION, 1, MPI_INT, ctx->rank,
+		 EEOVERHEAD_TAG, ctx->comm, MPI_INFO_NULL, &ctx->psend);
+
+  for (p = 0; p < EEOVERHEAD_NB_PARTITION; p++) {
+    ctx->partitions[p] = p;
+  }
+
+}
+
+static void
+EEOVERHEAD_startPartitioned(EEOVERHEAD_Context * ctx) {
+  MPI_Start(&ctx->precv);
+  MPI_Start(&ctx->psend);
+  MPI_Pready_range(0, EEOVERHEAD_NB_PARTITION - 1, ctx->psend);
+}
+
+static void
+EEOVERHEAD_completePartitioned(EEOVERHEAD_Context * ctx) {
+  MPI_Wait(&ctx->psend, MPI_STATUS_IGNORE);
+  MPI_Wait(&ctx->precv, MPI_STATUS_IGNORE);
+}
+
+static void
+EEOVERHEAD_freePartitioned(EEOVERHEAD_Context * ctx) {
+  MPI_Request_free(&ctx->psend);
+  MPI_Request_free(&ctx->precv);
+}
+
+static int
+EEOVERHEAD_parrivedWait(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+
+  int flag = 0;
+
+  int err = MPI_SUCCESS;
+
+  if (variant == EEOVERHEAD_MPI) {
+    do {
+      err = MPI_Parrived(ctx->precv, 0, &flag);
+    } while ((err == MPI_SUCCESS) && (flag == 0));
+    return err;
+  }
+
+  return EEPROBE_Parrived_wait_Switch(ctx->precv, 0, EEOVERHEAD_VARIANT_ENABLE[variant]);
+
+}
+
+static int
+EEOVERHEAD_parrivedWaitany(EEOVERHEAD_Context * ctx, EEOVERHEAD_Variant variant) {
+
+  int index = 0;
+
+  int flag = 0;
+
+  int err = MPI_SUCCESS;
+
+  if (variant == EEOVERHEAD_MPI) {
+    do {
+      err = MPI_Parrived(ctx->precv, ctx->partitions[index], &flag);
+      index = (index + 1) % EEOVERHEAD_NB_PARTITION;
+    } while ((err == MPI_SUCCESS) && (flag == 0));
+    return err;
+  }
+
+  return EEPROBE_Parrived_waitany_Switch(ctx->precv, EEOVERHEAD_NB_PARTITION,
+					 ctx->partitions, &index,
+					 EEOVERHEAD_VARIANT_ENABLE[variant]);
+
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------------- */
+
+  /* writes come before reads, so that reads find data in the file */
+static const EEOVERHEAD_Wrapper EEOVERHEAD_WRAPPERS[] = {
+  {"Probe", EEOVERHEAD_probe, EEOVERHEAD_postSend, EEOVERHEAD_receiveProbed, NULL, NULL},
+  {"Probe_any", EEOVERHEAD_probeAny, EEOVERHEAD_postSend, EEOVERHEAD_receiveProbed,
+   NULL, NULL},
+  {"Wait", EEOVERHEAD_wait, EEOVERHEAD_postBoth, EEOVERHEAD_waitPending, NULL, NULL},
+  {"Recv", EEOVERHEAD_recv, EEOVERHEAD_postSend, EEOVERHEAD_waitRequest, NULL, NULL},
+  {"Send", EEOVERHEAD_send, EEOVERHEAD_postRecv, EEOVERHEAD_waitRequest, NULL, NULL},
+  {"Ssend", EEOVERHEAD_ssend, EEOVERHEAD_postRecv, EEOVERHEAD_waitRequest, NULL, NULL},
+  {"Rsend", EEOVERHEAD_rsend, EEOVERHEAD_postRecv, EEOVERHEAD_waitRequest, NULL, NULL},
+  {"Reduce", EEOVERHEAD_reduce, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Allreduce", EEOVERHEAD_allreduce, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Alltoall", EEOVERHEAD_alltoall, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Alltoallv", EEOVERHEAD_alltoallv, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Alltoallw", EEOVERHEAD_alltoallw, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Bcast", EEOVERHEAD_bcast, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Scatter", EEOVERHEAD_scatter, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Scatterv", EEOVERHEAD_scatterv, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Gather", EEOVERHEAD_gather, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Gatherv", EEOVERHEAD_gatherv, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Allgather", EEOVERHEAD_allgather, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Allgatherv", EEOVERHEAD_allgatherv, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"Barrier", EEOVERHEAD_barrier, EEOVERHEAD_synchronize, NULL, NULL, NULL},
+  {"File_write", EEOVERHEAD_fileWrite, NULL, NULL, EEOVERHEAD_seek, NULL},
+  {"File_write_at", EEOVERHEAD_fileWriteAt, NULL, NULL, NULL, NULL},
+  {"File_write_all", EEOVERHEAD_fileWriteAll, NULL, NULL, EEOVERHEAD_seek, NULL},
+  {"File_write_at_all", EEOVERHEAD_fileWriteAtAll, NULL, NULL, NULL, NULL},
+  {"File_write_shared", EEOVERHEAD_fileWriteShared, NULL, NULL, EEOVERHEAD_seekShared, NULL},
+  {"File_write_ordered", EEOVERHEAD_fileWriteOrdered, NULL, NULL, EEOVERHEAD_seekShared,
+   NULL},
+  {"File_read", EEOVERHEAD_fileRead, NULL, NULL, EEOVERHEAD_seek, NULL},
+  {"File_read_at", EEOVERHEAD_fileReadAt, NULL, NULL, NULL, NULL},
+  {"File_read_all", EEOVERHEAD_fileReadAll, NULL, NULL, EEOVERHEAD_seek, NULL},
+  {"File_read_at_all", EEOVERHEAD_fileReadAtAll, NULL, NULL, NULL, NULL},
+  {"File_read_shared", EEOVERHEAD_fileReadShared, NULL, NULL, EEOVERHEAD_seekShared, NULL},
+  {"File_read_ordered", EEOVERHEAD_fileReadOrdered, NULL, NULL, EEOVERHEAD_seekShared,
+   NULL},
+  {"Rput", EEOVERHEAD_rput, NULL, NULL, NULL, NULL},
+  {"Rget", EEOVERHEAD_rget, NULL, NULL, NULL, NULL},
+  {"Raccumulate", EEOVERHEAD_raccumulate, NULL, NULL, NULL, NULL},
+  {"Win_wait_flag", EEOVERHEAD_winWaitFlag, NULL, NULL, NULL, NULL},
+  {"Win_wait", EEOVERHEAD_winWait, EEOVERHEAD_exposeSelf, NULL, NULL, NULL},
+  {"Win_fence", EEOVERHEAD_winFence, EEOVERHEAD_synchronize, NULL, NULL,
+   EEOVERHEAD_closeFence},
+#if MPI_VERSION >= 4
+  {"Parrived_wait", EEOVERHEAD_parrivedWait, EEOVERHEAD_startPartitioned,
+   EEOVERHEAD_completePartitioned, EEOVERHEAD_initPartitioned, EEOVERHEAD_freePartitioned},
+  {"Parrived_waitany", EEOVERHEAD_parrivedWaitany, EEOVERHEAD_startPartitioned,
+   EEOVERHEAD_completePartitioned, EEOVERHEAD_initPartitioned, EEOVERHEAD_freePartitioned},
+#endif
+};
+
+#define EEOVERHEAD_NB_WRAPPER ((int) (sizeof(EEOVERHEAD_WRAPPERS) / sizeof(EEOVERHEAD_Wrapper)))
+
+/* ---------------------------------------------------------------------------------- */
+
+static void
+EEOVERHEAD_initContext(EEOVERHEAD_Context * ctx, MPI_Comm comm, const char * path,
+		       int nb_iter) {
+
+  MPI_Group group;
+
+  int i = 0;
+
+  ctx->comm = comm;
+  MPI_Comm_rank(comm, &ctx->rank);
+  MPI_Comm_size(comm, &ctx->nr);
+
+  ctx->sendbuf = malloc(ctx->nr * EEOVERHEAD_COUNT * sizeof(int));
+  ctx->recvbuf = malloc(ctx->nr * EEOVERHEAD_COUNT * sizeof(int));
+  ctx->counts = malloc(ctx->nr * sizeof(int));
+  ctx->displs = malloc(ctx->nr * sizeof(int));
+  ctx->types = malloc(ctx->nr * sizeof(MPI_Datatype));
+  assert((ctx->sendbuf != NULL) && (ctx->recvbuf != NULL) && (ctx->counts != NULL)
+	 && (ctx->displs != NULL) && (ctx->types != NULL));
+
+  for (i = 0; i < ctx->nr * EEOVERHEAD_COUNT; i++) {
+    ctx->sendbuf[i] = ctx->rank;
+    ctx->recvbuf[i] = 0;
+  }
+  for (i = 0; i < ctx->nr; i++) {
+    ctx->counts[i] = EEOVERHEAD_COUNT;
+    ctx->displs[i] = i * EEOVERHEAD_COUNT;
+    ctx->types[i] = MPI_INT;
+  }
+
+  ctx->request = MPI_REQUEST_NULL;
+  ctx->pending = MPI_REQUEST_NULL;
+
+  /* room for the warm-up and the timed iterations of a variant */
+  ctx->region = (MPI_Offset) (EEOVERHEAD_NB_WARMUP + nb_iter) * sizeof(int);
+  MPI_File_open(comm, path, MPI_MODE_CREATE | MPI_MODE_RDWR | MPI_MODE_DELETE_ON_CLOSE,
+		MPI_INFO_NULL, &ctx->fh);
+
+  /* the last element holds the flag of Win_wait_flag */
+  MPI_Win_allocate((EEOVERHEAD_COUNT + 1) * sizeof(int), sizeof(int), MPI_INFO_NULL,
+		   comm, &ctx->passive_base, &ctx->passive_win);
+  ctx->passive_base[EEOVERHEAD_COUNT] = 1;
+  MPI_Win_lock_all(0, ctx->passive_win);
+
+  MPI_Win_allocate(EEOVERHEAD_COUNT * sizeof(int), sizeof(int), MPI_INFO_NULL,
+		   comm, &ctx->active_base, &ctx->active_win);
+
+  MPI_Comm_group(comm, &group);
+  MPI_Group_incl(group, 1, &ctx->rank, &ctx->self_group);
+  MPI_Group_free(&group);
+
+}
+
+static void
+EEOVERHEAD_freeContext(EEOVERHEAD_Context * ctx) {
+
+  MPI_Group_free(&ctx->self_group);
+  MPI_Win_free(&ctx->active_win);
+  MPI_Win_unlock_all(ctx->passive_win);
+  MPI_Win_free(&ctx->passive_win);
+  MPI_File_close(&ctx->fh);
+
+  free(ctx->sendbuf);
+  free(ctx->recvbuf);
+  free(ctx->counts);
+  free(ctx->displs);
+  free(ctx->types);
+
+}
+
+  /**
+   * Run all the variants of a wrapper on the communicator of the context and
+   * print one line per variant if print is set.
+   */
+static void
+EEOVERHEAD_measure(EEOVERHEAD_Context * ctx, const EEOVERHEAD_Wrapper * wrapper,
+		   const char * comm_name, int nb_iter, unsigned long timer,
+		   unsigned long * samples, int print) {
+
+  EEOVERHEAD_Variant variant = EEOVERHEAD_MPI;
+
+  unsigned long start = 0;
+
+  unsigned long duration = 0;
+
+  double total = 0.0;
+
+  int err = MPI_SUCCESS;
+
+  int i = 0;
+
+  for (variant = EEOVERHEAD_MPI; variant < EEOVERHEAD_NB_VARIANT; variant++) {
+
+    MPI_Barrier(ctx->comm);
+
+    if (wrapper->start != NULL) {
+      wrapper->start(ctx);
+    }
+
+    total = 0.0;
+
+    for (i = -EEOVERHEAD_NB_WARMUP; i < nb_iter; i++) {
+
+      ctx->iteration = i + EEOVERHEAD_NB_WARMUP;
+
+      if (wrapper->setup != NULL) {
+	wrapper->setup(ctx);
+      }
+
+      start = EEOVERHEAD_getTime();
+      err = wrapper->call(ctx, variant);
+      duration = EEOVERHEAD_getTime() - start;
+      assert(err == MPI_SUCCESS);
+
+      if (wrapper->cleanup != NULL) {
+	wrapper->cleanup(ctx);
+      }
+
+      if (i >= 0) {
+	samples[i] = (duration > timer) ? duration - timer : 0;
+	total += samples[i];
+      }
+
+    }
+
+    if (wrapper->finish != NULL) {
+      wrapper->finish(ctx);
+    }
+
+    if (print) {
+      qsort(samples, nb_iter, sizeof(unsigned long), EEOVERHEAD_compare);
+      fprintf(stdout, "%s,%s,%s,%s,%d,%d,%lu,%.1f\n", wrapper->name,
+	      EEOVERHEAD_VARIANT_NAME[variant],
+	      EEPROBE_ENABLE_TOTAL_SLEEP_TIME ? "on" : "off", comm_name, ctx->nr,
+	      nb_iter, samples[nb_iter / 2], total / nb_iter);
+      fflush(stdout);
+    }
+
+  }
+
+}
+
+static void
+EEOVERHEAD_run(MPI_Comm comm, const char * comm_name, const char * path, int nb_iter,
+	       unsigned long timer, unsigned long * samples, int print) {
+
+  EEOVERHEAD_Context ctx;
+
+  int w = 0;
+
+  EEOVERHEAD_initContext(&ctx, comm, path, nb_iter);
+
+  for (w = 0; w < EEOVERHEAD_NB_WRAPPER; w++) {
+    EEOVERHEAD_measure(&ctx, &EEOVERHEAD_WRAPPERS[w], comm_name, nb_iter, timer,
+		       samples, print);
+  }
+
+  EEOVERHEAD_freeContext(&ctx);
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  const char * path = EEOVERHEAD_FILE;
+
+  unsigned long * samples = NULL;
+
+  unsigned long timer = 0;
+
+  int nb_iter = EEOVERHEAD_NB_ITER;
+
+  int rank = 0;
+
+  if (argc > 1) {
+    nb_iter = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    path = argv[2];
+  }
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  if (nb_iter <= 0) {
+    if (rank == 0) {
+      fprintf(stderr, "Usage: mpirun -np <n> %s [iterations] [file]\n", argv[0]);
+    }
+    MPI_Finalize();
+    return 1;
+  }
+
+  samples = malloc(nb_iter * sizeof(unsigned long));
+  assert(samples != NULL);
+
+  timer = EEOVERHEAD_getTimerOverhead(samples, nb_iter);
+
+  if (rank == 0) {
+    fprintf(stdout, "wrapper,variant,instrumentation,comm,comm_size,iterations,"
+	    "ns_median,ns_mean\n");
+  }
+
+  EEOVERHEAD_run(MPI_COMM_WORLD, "world", path, nb_iter, timer, samples, rank == 0);
+
+  if (rank == 0) {
+    EEOVERHEAD_run(MPI_COMM_SELF, "self", path, nb_iter, timer, samples, 1);
+  }
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  free(samples);
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
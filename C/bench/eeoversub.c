@@ -0,0 +1,588 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Oversubscription benchmark: K compute-bound ranks share the cores with
+   * mostly idle ranks blocked in EEPROBE_Recv or EEPROBE_Barrier. Rank 0 is a
+   * client: every gap, it sends a request to one idle rank in turn and waits
+   * for the answer (recv), or enters a barrier with all the idle ranks
+   * (barrier), and records the response time. The compute ranks count the
+   * fixed-size work chunks they complete.
+   *
+   * Each phase runs for a given duration with one configuration and one number
+   * of participating idle ranks. The ranks left out of a phase sleep, so that
+   * a single launch sweeps the oversubscription ratio, (K + idle ranks + 1) /
+   * cores. Launch all ranks on the same cores, for instance with
+   * --oversubscribe on a node with fewer cores than ranks, or with --cpu-set.
+   * Rank 0 writes one CSV line per phase: the compute throughput, the CPU time
+   * of the idle ranks and the client response time.
+   *
+   * mpirun --oversubscribe -np 16 ./eeoversub -k 4
+   * mpirun --oversubscribe -np 16 ./eeoversub -k 4 -i barrier -m 0,11 -c disable,exponential
+   *
+   * -k count     compute ranks (number of cores, at most np - 1)
+   * -m list      comma separated numbers of idle ranks (0, powers of 2, np - 1 - k)
+   * -c list      comma separated configurations: disable enable auto linear
+   *              exponential constant spin (all)
+   * -i recv|barrier  primitive of the idle ranks (recv)
+   * -g ns        gap between two client requests (1000000)
+   * -t s         duration of a phase (2)
+   * -y min:inc:max  yield times in ns (library settings)
+   *
+   * The policy configurations enable the micro-sleep with the given policy for
+   * all actions. The EEPROBE_ environment variables apply.
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc, qsort, strtol, strtod */
+#include <stdlib.h>
+
+/* fprintf, snprintf, sscanf */
+#include <stdio.h>
+
+/* strcmp, strtok */
+#include <string.h>
+
+/* clock_gettime, clock_nanosleep */
+#include <time.h>
+
+/* getopt, sysconf */
+#include <unistd.h>
+
+/* getrusage */
+#include <sys/resource.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEOVERSUB_TAG_REQUEST 0
+
+#define EEOVERSUB_TAG_STOP 1
+
+#define EEOVERSUB_CLIENT 0
+
+#define EEOVERSUB_GAP_NS 1000000
+
+#define EEOVERSUB_DURATION_S 2.0
+
+  /* iterations of the multiply-add loop of a work chunk */
+#define EEOVERSUB_CHUNK_SIZE 100000
+
+#define EEOVERSUB_LIST_SIZE 256
+
+#define EEOVERSUB_MAX_SAMPLE (1 << 20)
+
+/* ---------------------------------------------------------------------------------- */
+
+typedef enum {
+  EEOVERSUB_DISABLE,
+  EEOVERSUB_ENABLE,
+  EEOVERSUB_AUTO,
+  EEOVERSUB_LINEAR,
+  EEOVERSUB_EXPONENTIAL,
+  EEOVERSUB_CONSTANT,
+  EEOVERSUB_SPIN,
+  EEOVERSUB_NB_CONFIG
+} EEOVERSUB_Config;
+
+static const char * EEOVERSUB_CONFIG_NAME[EEOVERSUB_NB_CONFIG] =
+  {"disable", "enable", "auto", "linear", "exponential", "constant", "spin"};
+
+  /**
+   * Settings of a phase, identical on all ranks.
+   */
+typedef struct {
+  EEPROBE_Enable enable;
+  int barrier;
+  int nb_compute;
+  int nb_idle;
+  unsigned long gap;
+  double duration;
+} EEOVERSUB_Phase;
+
+/* ---------------------------------------------------------------------------------- */
+
+static unsigned long
+EEOVERSUB_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (unsigned long) ts.tv_sec * 1000000000UL + ts.tv_nsec;
+
+}
+
+static void
+EEOVERSUB_sleepUntil(unsigned long deadline) {
+
+  struct timespec ts;
+
+  ts.tv_sec = deadline / 1000000000UL;
+  ts.tv_nsec = deadline % 1000000000UL;
+
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+  }
+
+}
+
+static double
+EEOVERSUB_getCpuTime() {
+
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+    + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+
+}
+
+static int
+EEOVERSUB_compare(const void * a, const void * b) {
+
+  unsigned long x = *((const unsigned long *) a);
+
+  unsigned long y = *((const unsigned long *) b);
+
+  return (x > y) - (x < y);
+
+}
+
+  /**
+   * Apply a configuration to the library. The policy configurations override
+   * the parameters of all actions with the current yield times.
+   */
+static EEPROBE_Enable
+EEOVERSUB_configure(EEOVERSUB_Config config) {
+
+  EEPROBE_Policy policy = EEPROBE_POLICY_LINEAR;
+
+  int a = 0;
+
+  for (a = 0; a < EEPROBE_NB_ACTION; a++) {
+    EEPROBE_resetActionParams(a);
+  }
+
+  switch (config) {
+  case EEOVERSUB_DISABLE:
+    return EEPROBE_DISABLE;
+  case EEOVERSUB_AUTO:
+    return EEPROBE_AUTO;
+  case EEOVERSUB_ENABLE:
+    return EEPROBE_ENABLE;
+  case EEOVERSUB_EXPONENTIAL:
+    policy = EEPROBE_POLICY_EXPONENTIAL;
+    break;
+  case EEOVERSUB_CONSTANT:
+    policy = EEPROBE_POLICY_CONSTANT;
+    break;
+  case EEOVERSUB_SPIN:
+    policy = EEPROBE_POLICY_SPIN;
+    break;
+  default:
+    break;
+  }
+
+  for (a = 0; a < EEPROBE_NB_ACTION; a++) {
+    EEPROBE_setActionParams(a, EEPROBE_getMinYieldTime(), EEPROBE_getIncYieldTime(),
+			    EEPROBE_getMaxYieldTime(), policy);
+  }
+
+  return EEPROBE_ENABLE;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Compute rank: run work chunks until the end of the phase and return their
+   * number.
+   */
+static long
+EEOVERSUB_compute(unsigned long deadline) {
+
+  volatile double x = 1.0;
+
+  long nb_chunk = 0;
+
+  int i = 0;
+
+  while (EEOVERSUB_getTime() < deadline) {
+    for (i = 0; i < EEOVERSUB_CHUNK_SIZE; i++) {
+      x = x * 0.999999 + 0.000001;
+    }
+    nb_chunk++;
+  }
+
+  return nb_chunk;
+
+}
+
+  /**
+   * Idle rank: answer the requests of the client until it stops the phase.
+   */
+static void
+EEOVERSUB_serve(const EEOVERSUB_Phase * phase, MPI_Comm comm) {
+
+  MPI_Status status;
+
+  int request = 0;
+
+  int stop = 0;
+
+  int errno = MPI_SUCCESS;
+
+  while (!stop) {
+    if (phase->barrier) {
+      errno = EEPROBE_Barrier_Switch(comm, phase->enable);
+      assert(errno == MPI_SUCCESS);
+      errno = MPI_Bcast(&stop, 1, MPI_INT, EEOVERSUB_CLIENT, comm);
+    } else {
+      errno = EEPROBE_Recv_Switch(&request, 1, MPI_INT, EEOVERSUB_CLIENT, MPI_ANY_TAG, comm,
+				  &status, phase->enable);
+      assert(errno == MPI_SUCCESS);
+      stop = (status.MPI_TAG == EEOVERSUB_TAG_STOP);
+      if (!stop) {
+	errno = MPI_Send(&request, 1, MPI_INT, EEOVERSUB_CLIENT, EEOVERSUB_TAG_REQUEST, comm);
+      }
+    }
+    assert(errno == MPI_SUCCESS);
+  }
+
+}
+
+  /**
+   * Client: send requests to the idle ranks until the end of the phase and
+   * record the response times. Returns the number of samples.
+   */
+static int
+EEOVERSUB_request(const EEOVERSUB_Phase * phase, MPI_Comm comm, unsigned long deadline,
+		  unsigned long * samples) {
+
+  unsigned long start = 0;
+
+  int nb_sample = 0;
+
+  int request = 0;
+
+  int stop = 1;
+
+  int target = 0;
+
+  int nr = 0;
+
+  int errno = MPI_SUCCESS;
+
+  MPI_Comm_size(comm, &nr);
+
+  /* no idle rank to request */
+  if ((nr == 1) && !phase->barrier) {
+    EEOVERSUB_sleepUntil(deadline);
+    return 0;
+  }
+
+  for (start = EEOVERSUB_getTime() + phase->gap; start < deadline;
+       start += phase->gap) {
+
+    EEOVERSUB_sleepUntil(start);
+    start = EEOVERSUB_getTime();
+
+    if (phase->barrier) {
+      errno = EEPROBE_Barrier_Switch(comm, phase->enable);
+      assert(errno == MPI_SUCCESS);
+      request = 0;
+      errno = MPI_Bcast(&request, 1, MPI_INT, EEOVERSUB_CLIENT, comm);
+    } else {
+      target = 1 + (nb_sample % (nr - 1));
+      errno = MPI_Send(&request, 1, MPI_INT, target, EEOVERSUB_TAG_REQUEST, comm);
+      assert(errno == MPI_SUCCESS);
+      errno = EEPROBE_Recv_Switch(&request, 1, MPI_INT, target, EEOVERSUB_TAG_REQUEST, comm,
+				  MPI_STATUS_IGNORE, phase->enable);
+    }
+    assert(errno == MPI_SUCCESS);
+
+    if (nb_sample < EEOVERSUB_MAX_SAMPLE) {
+      samples[nb_sample++] = EEOVERSUB_getTime() - start;
+    }
+
+  }
+
+  /* stop the idle ranks */
+  if (phase->barrier) {
+    EEPROBE_Barrier_Switch(comm, phase->enable);
+    MPI_Bcast(&stop, 1, MPI_INT, EEOVERSUB_CLIENT, comm);
+  } else {
+    for (target = 1; target < nr; target++) {
+      MPI_Send(&stop, 1, MPI_INT, target, EEOVERSUB_TAG_STOP, comm);
+    }
+  }
+
+  return nb_sample;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Run a phase on all ranks and print its results on rank 0. Compute ranks
+   * come last in MPI_COMM_WORLD, the idle ranks follow the client.
+   */
+static void
+EEOVERSUB_run(const EEOVERSUB_Phase * phase, const char * name, int rank, int nr,
+	      int nb_core, unsigned long * samples) {
+
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  unsigned long deadline = 0;
+
+  double cpu_time = 0.0;
+
+  double idle_cpu_time = 0.0;
+
+  double sum = 0.0;
+
+  long nb_chunk = 0;
+
+  long total_chunk = 0;
+
+  int first_compute = nr - phase->nb_compute;
+
+  int is_idle = (rank > EEOVERSUB_CLIENT) && (rank <= phase->nb_idle);
+
+  int nb_sample = 0;
+
+  int i = 0;
+
+  MPI_Comm_split(MPI_COMM_WORLD, ((rank == EEOVERSUB_CLIENT) || is_idle) ? 0 : MPI_UNDEFINED,
+		 rank, &comm);
+
+  /* phase boundaries sleep, so that they do not load the cores */
+  EEPROBE_Barrier_Switch(MPI_COMM_WORLD, EEPROBE_ENABLE);
+
+  deadline = EEOVERSUB_getTime() + (unsigned long) (phase->duration * 1e9);
+  cpu_time = EEOVERSUB_getCpuTime();
+
+  if (rank == EEOVERSUB_CLIENT) {
+    nb_sample = EEOVERSUB_request(phase, comm, deadline, samples);
+  } else if (is_idle) {
+    EEOVERSUB_serve(phase, comm);
+  } else if (rank >= first_compute) {
+    nb_chunk = EEOVERSUB_compute(deadline);
+  } else {
+    EEOVERSUB_sleepUntil(deadline);
+  }
+
+  cpu_time = is_idle ? EEOVERSUB_getCpuTime() - cpu_time : 0.0;
+
+  EEPROBE_Barrier_Switch(MPI_COMM_WORLD, EEPROBE_ENABLE);
+
+  MPI_Reduce(&nb_chunk, &total_chunk, 1, MPI_LONG, MPI_SUM, EEOVERSUB_CLIENT,
+	     MPI_COMM_WORLD);
+  MPI_Reduce(&cpu_time, &idle_cpu_time, 1, MPI_DOUBLE, MPI_SUM, EEOVERSUB_CLIENT,
+	     MPI_COMM_WORLD);
+
+  if (comm != MPI_COMM_NULL) {
+    MPI_Comm_free(&comm);
+  }
+
+  if (rank == EEOVERSUB_CLIENT) {
+
+    qsort(samples, nb_sample, sizeof(unsigned long), EEOVERSUB_compare);
+    for (i = 0; i < nb_sample; i++) {
+      sum += samples[i];
+    }
+
+    fprintf(stdout, "%s,%s,%d,%d,%d,%d,%.2f,%.3f,%.1f,%.1f,%.6f,%d,%.0f,%lu,%lu,%lu\n",
+	    name, phase->barrier ? "barrier" : "recv", phase->nb_compute, phase->nb_idle,
+	    phase->nb_compute + phase->nb_idle + 1, nb_core,
+	    (double) (phase->nb_compute + phase->nb_idle + 1) / nb_core, phase->duration,
+	    total_chunk / phase->duration,
+	    (phase->nb_compute > 0) ? total_chunk / phase->duration / phase->nb_compute : 0.0,
+	    idle_cpu_time, nb_sample, (nb_sample > 0) ? sum / nb_sample : 0.0,
+	    (nb_sample > 0) ? samples[nb_sample / 2] : 0,
+	    (nb_sample > 0) ? samples[(nb_sample * 99) / 100] : 0,
+	    (nb_sample > 0) ? samples[nb_sample - 1] : 0);
+    fflush(stdout);
+
+  }
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  EEOVERSUB_Phase phase;
+
+  EEOVERSUB_Config configs[EEOVERSUB_LIST_SIZE];
+
+  int idles[EEOVERSUB_LIST_SIZE];
+
+  char config_list[EEOVERSUB_LIST_SIZE] = "";
+
+  char idle_list[EEOVERSUB_LIST_SIZE] = "";
+
+  unsigned long * samples = NULL;
+
+  char * name = NULL;
+
+  long min_yield_time = -1;
+
+  long inc_yield_time = -1;
+
+  long max_yield_time = -1;
+
+  int nb_core = 0;
+
+  int nb_config = 0;
+
+  int nb_idle = 0;
+
+  int valid = 1;
+
+  int option = 0;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int c = 0;
+
+  int m = 0;
+
+  phase.barrier = 0;
+  phase.nb_compute = -1;
+  phase.gap = EEOVERSUB_GAP_NS;
+  phase.duration = EEOVERSUB_DURATION_S;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  nb_core = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+  while ((option = getopt(argc, argv, "k:m:c:i:g:t:y:")) != -1) {
+    switch (option) {
+    case 'k': phase.nb_compute = strtol(optarg, NULL, 10); break;
+    case 'm': snprintf(idle_list, sizeof(idle_list), "%s", optarg); break;
+    case 'c': snprintf(config_list, sizeof(config_list), "%s", optarg); break;
+    case 'i':
+      phase.barrier = (strcmp(optarg, "barrier") == 0);
+      valid = valid && (phase.barrier || (strcmp(optarg, "recv") == 0));
+      break;
+    case 'g': phase.gap = strtoul(optarg, NULL, 10); break;
+    case 't': phase.duration = strtod(optarg, NULL); break;
+    case 'y':
+      valid = valid && (sscanf(optarg, "%ld:%ld:%ld", &min_yield_time, &inc_yield_time,
+			       &max_yield_time) == 3);
+      break;
+    default: valid = 0; break;
+    }
+  }
+
+  if (phase.nb_compute < 0) {
+    phase.nb_compute = (nb_core < nr - 1) ? nb_core : nr - 1;
+  }
+
+  valid = valid && (nr >= 2) && (phase.nb_compute <= nr - 1) && (phase.gap > 0)
+    && (phase.duration > 0.0);
+
+  /* idle ranks: 0, powers of 2 and all the remaining ranks by default */
+  if (valid && (idle_list[0] == '\0')) {
+    idles[nb_idle++] = 0;
+    for (m = 1; (m < nr - 1 - phase.nb_compute) && (nb_idle < EEOVERSUB_LIST_SIZE - 1);
+	 m *= 2) {
+      idles[nb_idle++] = m;
+    }
+    if (nr - 1 - phase.nb_compute > 0) {
+      idles[nb_idle++] = nr - 1 - phase.nb_compute;
+    }
+  }
+  for (name = strtok(idle_list, ","); (name != NULL) && (nb_idle < EEOVERSUB_LIST_SIZE);
+       name = strtok(NULL, ",")) {
+    idles[nb_idle] = strtol(name, NULL, 10);
+    valid = valid && (idles[nb_idle] >= 0) && (idles[nb_idle] <= nr - 1 - phase.nb_compute);
+    nb_idle++;
+  }
+
+  if (config_list[0] == '\0') {
+    for (c = 0; c < EEOVERSUB_NB_CONFIG; c++) {
+      configs[nb_config++] = c;
+    }
+  }
+  for (name = strtok(config_list, ","); (name != NULL) && (nb_config < EEOVERSUB_LIST_SIZE);
+       name = strtok(NULL, ",")) {
+    for (c = 0; (c < EEOVERSUB_NB_CONFIG) && (strcmp(name, EEOVERSUB_CONFIG_NAME[c]) != 0);
+	 c++) {
+    }
+    valid = valid && (c < EEOVERSUB_NB_CONFIG);
+    configs[nb_config++] = c;
+  }
+
+  if (!valid) {
+    if (rank == 0) {
+      fprintf(stderr, "Usage: mpirun --oversubscribe -np <n >= 2> %s [-k compute_ranks] [-m idle_ranks] [-c configs] [-i recv|barrier] [-g gap_ns] [-t duration_s] [-y min:inc:max]\n", argv[0]);
+    }
+    MPI_Finalize();
+    return 1;
+  }
+
+  if (min_yield_time >= 0) {
+    EEPROBE_setMinYieldTime(min_yield_time);
+    EEPROBE_setIncYieldTime(inc_yield_time);
+    EEPROBE_setMaxYieldTime(max_yield_time);
+  }
+
+  if (rank == EEOVERSUB_CLIENT) {
+    samples = malloc(EEOVERSUB_MAX_SAMPLE * sizeof(unsigned long));
+    assert(samples != NULL);
+    fprintf(stdout, "config,primitive,compute_ranks,idle_ranks,ranks,cores,oversubscription,"
+	    "duration_s,throughput_chunks_s,throughput_per_rank,idle_cpu_s,responses,"
+	    "response_mean_ns,response_p50_ns,response_p99_ns,response_max_ns\n");
+  }
+
+  for (m = 0; m < nb_idle; m++) {
+    for (c = 0; c < nb_config; c++) {
+      phase.nb_idle = idles[m];
+      phase.enable = EEOVERSUB_configure(configs[c]);
+      EEOVERSUB_run(&phase, EEOVERSUB_CONFIG_NAME[configs[c]], rank, nr, nb_core, samples);
+    }
+  }
+
+  free(samples);
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
@@ -0,0 +1,239 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * One-sided synchronization benchmark. One side computes for a while before
+   * each synchronization, so that the other side waits in:
+   * - a fence epoch, each rank putting its rank to rank 0, late,
+   * - a post/start/complete/wait epoch, rank 0 exposing its window and
+   *   waiting for the other ranks, late, to put their rank to it,
+   * - a passive target epoch, the other ranks waiting for a flag that rank 0,
+   *   late, sets with MPI_Accumulate, then reading its window with EEPROBE_Rget.
+   * Each rank prints the sleep time of the RMA actions:
+   *
+   * mpirun -np 4 ./eerma
+   * mpirun -np 4 ./eerma disable
+   */
+
+/* assert */
+#include <assert.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* strcmp */
+#include <string.h>
+
+/* clock_nanosleep */
+#include <time.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EERMA_NB_ITER 8
+
+#define EERMA_DELAY_NS 50000000
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Only rank 0 computes.
+   */
+static void
+EERMA_compute(int rank) {
+
+  struct timespec delay;
+
+  if (rank == 0) {
+    delay.tv_sec = 0;
+    delay.tv_nsec = EERMA_DELAY_NS;
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &delay, NULL);
+  }
+
+}
+
+  /**
+   * Window layout: one slot per rank, followed by the flag.
+   */
+static int
+EERMA_fence(int rank, int nr, int * base, MPI_Win win, EEPROBE_Enable enable) {
+
+  int valid = 1;
+
+  int i = 0;
+
+  int r = 0;
+
+  for (i = 0; i < EERMA_NB_ITER; i++) {
+    EERMA_compute(rank);
+    EEPROBE_Win_fence_Switch(0, win, enable);
+    MPI_Put(&rank, 1, MPI_INT, 0, rank, 1, MPI_INT, win);
+    EEPROBE_Win_fence_Switch(0, win, enable);
+    if (rank == 0) {
+      for (r = 0; r < nr; r++) {
+	valid = valid && (base[r] == r);
+	base[r] = -1;
+      }
+    }
+  }
+
+  return valid;
+
+}
+
+static int
+EERMA_pscw(int rank, int nr, int * base, MPI_Win win, EEPROBE_Enable enable) {
+
+  MPI_Group world_group;
+
+  MPI_Group group;
+
+  int valid = 1;
+
+  int zero = 0;
+
+  int i = 0;
+
+  int r = 0;
+
+  MPI_Comm_group(MPI_COMM_WORLD, &world_group);
+
+  for (i = 0; i < EERMA_NB_ITER; i++) {
+    if (rank == 0) {
+      MPI_Group_excl(world_group, 1, &zero, &group);
+      MPI_Win_post(group, 0, win);
+      EEPROBE_Win_wait_Switch(win, enable);
+      for (r = 1; r < nr; r++) {
+	valid = valid && (base[r] == r);
+	base[r] = -1;
+      }
+    } else {
+      MPI_Group_incl(world_group, 1, &zero, &group);
+      EERMA_compute(0);
+      MPI_Win_start(group, 0, win);
+      MPI_Put(&rank, 1, MPI_INT, 0, rank, 1, MPI_INT, win);
+      MPI_Win_complete(win);
+    }
+    MPI_Group_free(&group);
+  }
+
+  MPI_Group_free(&world_group);
+
+  return valid;
+
+}
+
+static int
+EERMA_passive(int rank, int nr, int * base, MPI_Win win, EEPROBE_Enable enable) {
+
+  int valid = 1;
+
+  int value = 0;
+
+  int i = 0;
+
+  MPI_Win_lock_all(0, win);
+
+  for (i = 1; i <= EERMA_NB_ITER; i++) {
+    if (rank == 0) {
+      EERMA_compute(rank);
+      base[0] = i;
+      MPI_Win_sync(win);
+      for (value = 1; value < nr; value++) {
+	MPI_Accumulate(&i, 1, MPI_INT, value, nr, 1, MPI_INT, MPI_REPLACE, win);
+      }
+      MPI_Win_flush_all(win);
+    } else {
+      EEPROBE_Win_wait_flag_Switch(&base[nr], i, win, enable);
+      EEPROBE_Rget_Switch(&value, 1, MPI_INT, 0, 0, 1, MPI_INT, win, enable);
+      valid = valid && (value == i);
+      EEPROBE_Raccumulate_Switch(&rank, 1, MPI_INT, 0, rank, 1, MPI_INT, MPI_REPLACE,
+				 win, enable);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+  }
+
+  MPI_Win_unlock_all(win);
+
+  return valid;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  MPI_Win win;
+
+  int * base = NULL;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int valid = 1;
+
+  int r = 0;
+
+  EEPROBE_Enable enable = EEPROBE_ENABLE;
+
+  if ((argc > 1) && (strcmp(argv[1], "disable") == 0)) {
+    enable = EEPROBE_DISABLE;
+  }
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  MPI_Win_allocate((nr + 1) * sizeof(int), sizeof(int), MPI_INFO_NULL,
+		   MPI_COMM_WORLD, &base, &win);
+
+  for (r = 0; r <= nr; r++) {
+    base[r] = -1;
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  valid = EERMA_fence(rank, nr, base, win, enable) && valid;
+  valid = EERMA_pscw(rank, nr, base, win, enable) && valid;
+  valid = EERMA_passive(rank, nr, base, win, enable) && valid;
+
+  MPI_Win_free(&win);
+
+  fprintf(stdout, "rank %d %s win_fence %lu win_wait %lu win_flag %lu rget %lu raccumulate %lu\n",
+	  rank, valid ? "valid" : "INVALID",
+	  EEPROBE_getTotalSleepTimeWinFence(), EEPROBE_getTotalSleepTimeWinWait(),
+	  EEPROBE_getTotalSleepTimeWinFlag(), EEPROBE_getTotalSleepTimeRget(),
+	  EEPROBE_getTotalSleepTimeRaccumulate());
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
@@ -0,0 +1,300 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Wake-up benchmark: every rank but rank 0 waits for a message sent by rank 0
+   * after a given duration, with the EEProbe backoff between two polls, and
+   * records the time of each wake-up. The wake-ups of the ranks of each node
+   * are then merged: wake-ups closer than EEWAKEUP_WINDOW_NS count as a single
+   * node wake-up. Run with and without the wake-up grid to compare:
+   *
+   * mpirun -np 8 ./eewakeup 5
+   * mpirun -np 8 ./eewakeup 5 1000000 100000
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc */
+#include <stdlib.h>
+
+/* fprintf */
+#include <stdio.h>
+
+/* clock_gettime, clock_nanosleep */
+#include <time.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEWAKEUP_TAG 0
+
+#define EEWAKEUP_DURATION_S 5
+
+#define EEWAKEUP_MAX_SAMPLE (1 << 20)
+
+  /* wake-ups closer than this count as a single node wake-up */
+#define EEWAKEUP_WINDOW_NS 20000
+
+#define EEWAKEUP_MIN_YIELD_TIME 0
+
+#define EEWAKEUP_INC_YIELD_TIME 10000
+
+#define EEWAKEUP_MAX_YIELD_TIME 1000000
+
+/* ---------------------------------------------------------------------------------- */
+
+static unsigned long
+EEWAKEUP_getTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (unsigned long) ts.tv_sec * 1000000000UL + ts.tv_nsec;
+
+}
+
+static int
+EEWAKEUP_compare(const void * a, const void * b) {
+
+  unsigned long x = *((const unsigned long *) a);
+
+  unsigned long y = *((const unsigned long *) b);
+
+  return (x > y) - (x < y);
+
+}
+
+  /**
+   * Wait for the message of rank 0 and record the wake-up times. Returns the
+   * number of wake-ups, the first EEWAKEUP_MAX_SAMPLE ones being recorded.
+   */
+static int
+EEWAKEUP_wait(unsigned long * samples) {
+
+  MPI_Request request;
+
+  EEPROBE_Backoff backoff;
+
+  int value = 0;
+
+  int flag = 0;
+
+  int nb_wakeup = 0;
+
+  MPI_Irecv(&value, 1, MPI_INT, 0, EEWAKEUP_TAG, MPI_COMM_WORLD, &request);
+
+  EEPROBE_Backoff_init(&backoff);
+
+  MPI_Test(&request, &flag, MPI_STATUS_IGNORE);
+
+  while (flag == 0) {
+    EEPROBE_Backoff_yield(&backoff, EEPROBE_WAIT);
+    if (nb_wakeup < EEWAKEUP_MAX_SAMPLE) {
+      samples[nb_wakeup] = EEWAKEUP_getTime();
+    }
+    nb_wakeup++;
+    MPI_Test(&request, &flag, MPI_STATUS_IGNORE);
+  }
+
+  EEPROBE_Backoff_reset(&backoff);
+
+  return nb_wakeup;
+
+}
+
+static void
+EEWAKEUP_send(int nr, long duration) {
+
+  struct timespec sleep;
+
+  int value = 0;
+
+  int i = 0;
+
+  sleep.tv_sec = duration;
+  sleep.tv_nsec = 0;
+
+  clock_nanosleep(CLOCK_MONOTONIC, 0, &sleep, NULL);
+
+  for (i = 1; i < nr; i++) {
+    MPI_Send(&value, 1, MPI_INT, i, EEWAKEUP_TAG, MPI_COMM_WORLD);
+  }
+
+}
+
+  /**
+   * Merge the wake-ups of the ranks of a node on the node leader and print the
+   * number of rank wake-ups and of node wake-ups per second.
+   */
+static void
+EEWAKEUP_report(unsigned long * samples, int nb_wakeup, long duration) {
+
+  MPI_Comm node;
+
+  int node_rank = 0;
+
+  int node_nr = 0;
+
+  int nb_sample = (nb_wakeup < EEWAKEUP_MAX_SAMPLE) ? nb_wakeup : EEWAKEUP_MAX_SAMPLE;
+
+  int * counts = NULL;
+
+  int * displs = NULL;
+
+  unsigned long * all = NULL;
+
+  int total_wakeup = 0;
+
+  long nb_burst = 0;
+
+  unsigned long burst_start = 0;
+
+  long grid = 0;
+
+  long threshold = 0;
+
+  int total = 0;
+
+  int i = 0;
+
+  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node);
+  MPI_Comm_rank(node, &node_rank);
+  MPI_Comm_size(node, &node_nr);
+
+  if (node_rank == 0) {
+    counts = malloc(sizeof(int) * node_nr);
+    displs = malloc(sizeof(int) * node_nr);
+    assert(counts);
+    assert(displs);
+  }
+
+  MPI_Gather(&nb_sample, 1, MPI_INT, counts, 1, MPI_INT, 0, node);
+
+  if (node_rank == 0) {
+    for (i = 0; i < node_nr; i++) {
+      displs[i] = total;
+      total += counts[i];
+    }
+    all = malloc(sizeof(unsigned long) * (total + 1));
+    assert(all);
+  }
+
+  MPI_Gatherv(samples, nb_sample, MPI_UNSIGNED_LONG, all, counts, displs,
+	      MPI_UNSIGNED_LONG, 0, node);
+
+  MPI_Reduce(&nb_wakeup, &total_wakeup, 1, MPI_INT, MPI_SUM, 0, node);
+
+  if (node_rank == 0) {
+
+    qsort(all, total, sizeof(unsigned long), EEWAKEUP_compare);
+
+    for (i = 0; i < total; i++) {
+      if ((nb_burst == 0) || (all[i] - burst_start > EEWAKEUP_WINDOW_NS)) {
+	burst_start = all[i];
+	nb_burst++;
+      }
+    }
+
+    EEPROBE_getWakeupGrid(&grid, &threshold);
+
+    fprintf(stdout, "node_ranks %d grid %ld threshold %ld duration %ld rank_wakeups %d rank_wakeups_per_s %.1f node_wakeups %ld node_wakeups_per_s %.1f%s\n",
+	    node_nr, grid, threshold, duration, total_wakeup, (double) total_wakeup / duration,
+	    nb_burst, (double) nb_burst / duration,
+	    (total < total_wakeup) ? " (truncated)" : "");
+
+    free(all);
+    free(displs);
+    free(counts);
+
+  }
+
+  MPI_Comm_free(&node);
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int nb_wakeup = 0;
+
+  long duration = EEWAKEUP_DURATION_S;
+
+  unsigned long * samples = NULL;
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  if (argc > 1) {
+    duration = atol(argv[1]);
+  }
+
+  if (argc > 2) {
+    EEPROBE_setWakeupGrid(atol(argv[2]), (argc > 3) ? atol(argv[3]) : 0);
+  }
+
+  EEPROBE_setMinYieldTime(EEWAKEUP_MIN_YIELD_TIME);
+  EEPROBE_setIncYieldTime(EEWAKEUP_INC_YIELD_TIME);
+  EEPROBE_setMaxYieldTime(EEWAKEUP_MAX_YIELD_TIME);
+
+  if (nr >= 2) {
+
+    samples = malloc(sizeof(unsigned long) * EEWAKEUP_MAX_SAMPLE);
+    assert(samples);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (rank == 0) {
+      EEWAKEUP_send(nr, duration);
+    } else {
+      nb_wakeup = EEWAKEUP_wait(samples);
+    }
+
+    EEWAKEUP_report(samples, nb_wakeup, duration);
+
+    free(samples);
+
+  } else {
+    fprintf(stdout, "Warning: MPI task nr is %d. Expected >= 2. Usage:\nmpirun -np 8 %s [duration_s [grid_ns [threshold_ns]]]\n",
+	    nr, argv[0]);
+  }
+
+  MPI_Finalize();
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
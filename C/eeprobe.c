@@ -27,41 +27,66 @@
 /* NULL */
 #include <stddef.h>
 
+/* realloc, getenv */
+#include <stdlib.h>
+
 /* clock_nanosleep */
 #include <time.h>
 
 /* gettimeofday */
 #include <sys/time.h>
 
-/* ---------------------------------------------------------------------------------- */
+/* sched_yield */
+#include <sched.h>
 
+/* epoll_create1, epoll_ctl, epoll_wait */
+#include <sys/epoll.h>
 
-#include "eeprobe.h"
+/* timerfd_create, timerfd_settime */
+#include <sys/timerfd.h>
+
+/* prctl */
+#include <sys/prctl.h>
+
+/* read, gethostname, syscall */
+#include <unistd.h>
+
+/* fopen, fprintf, fscanf, rename */
+#include <stdio.h>
+
+/* strcmp */
+#include <string.h>
+
+/* uint64_t */
+#include <stdint.h>
 
+/* toupper */
+#include <ctype.h>
+
+/* INT_MAX */
+#include <limits.h>
+
+/* SYS_futex */
+#include <sys/syscall.h>
+
+/* FUTEX_WAIT, FUTEX_WAKE */
+#include <linux/futex.h>
+
+/* open */
+#include <fcntl.h>
+
+/* mmap, munmap */
+#include <sys/mman.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+/* __get_cpuid_count */
+#include <cpuid.h>
+#endif
 
 /* ---------------------------------------------------------------------------------- */
 
-  /**
-   * Enum type used to identify the MPI action.
-   */
-typedef enum {
-	      EEPROBE_PROBE,
-	      EEPROBE_WAIT,
-	      EEPROBE_RECV,
-	      EEPROBE_REDUCE,
-	      EEPROBE_ALLREDUCE,
-	      EEPROBE_ALLTOALL,
-	      EEPROBE_ALLTOALLV,
-	      EEPROBE_ALLTOALLW,
-	      EEPROBE_BCAST,
-	      EEPROBE_SCATTER,
-	      EEPROBE_SCATTERV,
-	      EEPROBE_GATHER,
-	      EEPROBE_GATHERV,
-	      EEPROBE_ALLGATHER,
-	      EEPROBE_ALLGATHERV,
-	      EEPROBE_BARRIER
-} EEPROBE_ACTION;
+
+#include "eeprobe.h"
 
 
 /* ---------------------------------------------------------------------------------- */
@@ -74,6 +99,99 @@ static long _EEPROBE_MIN_YIELD_TIME = 0;
 
 static long _EEPROBE_INC_YIELD_TIME = 1;
 
+  /* per-action overrides of the yield times, used when overridden is set */
+typedef struct {
+  int overridden;
+  EEPROBE_ActionParams params;
+} EEPROBE_ActionOverride;
+
+static EEPROBE_ActionOverride _EEPROBE_ACTION_OVERRIDES[EEPROBE_NB_ACTION];
+
+static EEPROBE_IdleCallback _EEPROBE_IDLE_CALLBACK = NULL;
+
+static void * _EEPROBE_IDLE_CALLBACK_CTX = NULL;
+
+static long _EEPROBE_IDLE_CALLBACK_BUDGET = 0;
+
+static long _EEPROBE_IDLE_CALLBACK_THRESHOLD = 0;
+
+static int _EEPROBE_IDLE_CALLBACK_RUNNING = 0;
+
+static unsigned long _EEPROBE_TOTAL_IDLE_CALLBACK_TIME = 0;
+
+static EEPROBE_IdlePrimitive _EEPROBE_IDLE_PRIMITIVE = EEPROBE_IDLE_NANOSLEEP;
+
+static long _EEPROBE_IDLE_AUTO_SLEEP_TIME = 50000;
+
+static long _EEPROBE_PROGRESS_THRESHOLD = 0;
+
+static long _EEPROBE_PROGRESS_YIELD_TIME = 10000;
+
+static long _EEPROBE_WAKEUP_GRID = 0;
+
+static long _EEPROBE_WAKEUP_THRESHOLD = 0;
+
+  /* -1: not initialized yet, -2: unavailable */
+static int _EEPROBE_TIMERFD = -1;
+
+static int _EEPROBE_EPOLLFD = -1;
+
+  /* -1: not checked yet, 0: unavailable, 1: available */
+static int _EEPROBE_TPAUSE_AVAILABLE = -1;
+
+static double _EEPROBE_TSC_PER_NS = 0.0;
+
+  /* 0: not calibrated, 1: calibrated */
+static int _EEPROBE_CALIBRATED = 0;
+
+static EEPROBE_Calibration _EEPROBE_CALIBRATION;
+
+static EEPROBE_Enable _EEPROBE_PREDICTOR = EEPROBE_DISABLE;
+
+static long _EEPROBE_PREDICTOR_GUARD_TIME = 100000;
+
+static EEPROBE_PredictorStats _EEPROBE_PREDICTOR_STATS;
+
+static EEPROBE_Enable _EEPROBE_WARM_START = EEPROBE_DISABLE;
+
+static double _EEPROBE_LATENCY_PERCENTILE = 99.0;
+
+static unsigned long _EEPROBE_LATENCY_TARGET = 0;
+
+static long _EEPROBE_LATENCY_OVERSHOOT = 0;
+
+static EEPROBE_LatencyStats _EEPROBE_LATENCY_STATS[EEPROBE_NB_ACTION];
+
+static long _EEPROBE_AUTO_THRESHOLD = 100000;
+
+static uintptr_t _EEPROBE_NEXT_CALL_SITE = 0;
+
+static const char * _EEPROBE_ACTION_NAMES[EEPROBE_NB_ACTION] =
+  {"probe", "wait", "recv", "reduce", "allreduce", "alltoall", "alltoallv",
+   "alltoallw", "bcast", "scatter", "scatterv", "gather", "gatherv", "allgather",
+   "allgatherv", "barrier", "scheduler", "reactor", "send", "ssend", "rsend",
+   "file_read", "file_write", "file_read_at", "file_write_at", "file_read_all",
+   "file_write_all", "file_read_at_all", "file_write_at_all", "file_read_shared",
+   "file_write_shared", "file_read_ordered", "file_write_ordered", "rput", "rget",
+   "raccumulate", "win_fence", "win_wait", "win_flag", "parrived"};
+
+  /* counters since the beginning, published in the stats segment */
+static EEPROBE_Stats _EEPROBE_STATS;
+
+  /* counters at the last EEPROBE_resetStats */
+static EEPROBE_Stats _EEPROBE_STATS_BASE;
+
+static EEPROBE_StatsSegment * _EEPROBE_STATS_SEGMENT = NULL;
+
+static char _EEPROBE_STATS_PATH[256];
+
+static long _EEPROBE_STATS_PERIOD = 0;
+
+  /* CLOCK_MONOTONIC time of the next segment update */
+static unsigned long _EEPROBE_STATS_NEXT = 0;
+
+static int _EEPROBE_STATS_ATEXIT = 0;
+
 static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_PROBE = 0;
 
 static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_WAIT = 0;
@@ -106,28 +224,175 @@ static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_ALLGATHERV = 0;
 
 static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_BARRIER = 0;
 
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_SCHEDULER = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_REACTOR = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_SEND = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_SSEND = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_RSEND = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ALL = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ALL = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT_ALL = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT_ALL = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_SHARED = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_SHARED = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ORDERED = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ORDERED = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_RPUT = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_RGET = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_RACCUMULATE = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_WIN_FENCE = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_WIN_WAIT = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_WIN_FLAG = 0;
+
+static unsigned long _EEPROBE_TOTAL_SLEEP_TIME_PARRIVED = 0;
+
+  /* the environment is read once, before the first setter or wait, so that
+     later API calls override it */
+static int _EEPROBE_ENVIRONMENT_READ = 0;
+
+  /* EEPROBE_CALIBRATE=1 was read but MPI was not initialized yet */
+static int _EEPROBE_CALIBRATION_PENDING = 0;
+
+  /* yield times set through the API, kept by a deferred calibration:
+     1 minimum, 2 incremental, 4 maximum */
+static int _EEPROBE_YIELD_TIMES_SET = 0;
+
+static void
+EEPROBE_readEnvironment();
+
 
 /* ---------------------------------------------------------------------------------- */
 
 void
 EEPROBE_setMinYieldTime(long min_yield_time) {
+  EEPROBE_readEnvironment();
   assert(min_yield_time >= 0);
   assert(min_yield_time < 1000000000);
   _EEPROBE_MIN_YIELD_TIME = min_yield_time;
+  _EEPROBE_YIELD_TIMES_SET |= 1;
 }
 
 void
 EEPROBE_setMaxYieldTime(long max_yield_time) {
+  EEPROBE_readEnvironment();
   assert(max_yield_time > 0);
   assert(max_yield_time < 1000000000);
   _EEPROBE_MAX_YIELD_TIME = max_yield_time;
+  _EEPROBE_YIELD_TIMES_SET |= 4;
 }
 
 void
 EEPROBE_setIncYieldTime(long inc_yield_time) {
+  EEPROBE_readEnvironment();
   assert(inc_yield_time > 0);
   assert(inc_yield_time < 1000000000);
   _EEPROBE_INC_YIELD_TIME = inc_yield_time;
+  _EEPROBE_YIELD_TIMES_SET |= 2;
+}
+
+void
+EEPROBE_setActionParams(EEPROBE_ACTION action, long min_yield_time, long inc_yield_time,
+			long max_yield_time, EEPROBE_Policy policy) {
+  EEPROBE_readEnvironment();
+  assert(action < EEPROBE_NB_ACTION);
+  assert(min_yield_time >= 0);
+  assert(inc_yield_time > 0);
+  assert(max_yield_time >= min_yield_time);
+  assert(max_yield_time < 1000000000);
+  _EEPROBE_ACTION_OVERRIDES[action].params.min_yield_time = min_yield_time;
+  _EEPROBE_ACTION_OVERRIDES[action].params.inc_yield_time = inc_yield_time;
+  _EEPROBE_ACTION_OVERRIDES[action].params.max_yield_time = max_yield_time;
+  _EEPROBE_ACTION_OVERRIDES[action].params.policy = policy;
+  _EEPROBE_ACTION_OVERRIDES[action].overridden = 1;
+}
+
+void
+EEPROBE_resetActionParams(EEPROBE_ACTION action) {
+  EEPROBE_readEnvironment();
+  assert(action < EEPROBE_NB_ACTION);
+  _EEPROBE_ACTION_OVERRIDES[action].overridden = 0;
+}
+
+void
+EEPROBE_getActionParams(EEPROBE_ACTION action, EEPROBE_ActionParams * params) {
+  assert(action < EEPROBE_NB_ACTION);
+  assert(params);
+  if (_EEPROBE_ACTION_OVERRIDES[action].overridden) {
+    *params = _EEPROBE_ACTION_OVERRIDES[action].params;
+  } else {
+    params->min_yield_time = _EEPROBE_MIN_YIELD_TIME;
+    params->inc_yield_time = _EEPROBE_INC_YIELD_TIME;
+    params->max_yield_time = _EEPROBE_MAX_YIELD_TIME;
+    params->policy = EEPROBE_POLICY_LINEAR;
+  }
+}
+
+void
+EEPROBE_setProgressParams(long threshold, long yield_time) {
+  EEPROBE_readEnvironment();
+  assert(threshold >= 0);
+  assert(yield_time >= 0);
+  assert(yield_time < 1000000000);
+  _EEPROBE_PROGRESS_THRESHOLD = threshold;
+  _EEPROBE_PROGRESS_YIELD_TIME = yield_time;
+}
+
+void
+EEPROBE_getProgressParams(long * threshold, long * yield_time) {
+  assert(threshold);
+  assert(yield_time);
+  *threshold = _EEPROBE_PROGRESS_THRESHOLD;
+  *yield_time = _EEPROBE_PROGRESS_YIELD_TIME;
+}
+
+void
+EEPROBE_setIdleCallback(EEPROBE_IdleCallback callback, void * ctx, long budget) {
+  assert(budget >= 0);
+  _EEPROBE_IDLE_CALLBACK = callback;
+  _EEPROBE_IDLE_CALLBACK_CTX = ctx;
+  _EEPROBE_IDLE_CALLBACK_BUDGET = budget;
+}
+
+void
+EEPROBE_setIdleThreshold(long threshold) {
+  assert(threshold >= 0);
+  _EEPROBE_IDLE_CALLBACK_THRESHOLD = threshold;
+}
+
+long
+EEPROBE_getIdleThreshold() {
+  return _EEPROBE_IDLE_CALLBACK_THRESHOLD;
+}
+
+unsigned long
+EEPROBE_getTotalIdleCallbackTime() {
+  return _EEPROBE_TOTAL_IDLE_CALLBACK_TIME;
 }
 
 long
@@ -167,7 +432,31 @@ EEPROBE_getTotalSleepTime() {
     _EEPROBE_TOTAL_SLEEP_TIME_GATHERV +
     _EEPROBE_TOTAL_SLEEP_TIME_ALLGATHER +
     _EEPROBE_TOTAL_SLEEP_TIME_ALLGATHERV +
-    _EEPROBE_TOTAL_SLEEP_TIME_BARRIER;
+    _EEPROBE_TOTAL_SLEEP_TIME_BARRIER +
+    _EEPROBE_TOTAL_SLEEP_TIME_SCHEDULER +
+    _EEPROBE_TOTAL_SLEEP_TIME_REACTOR +
+    _EEPROBE_TOTAL_SLEEP_TIME_SEND +
+    _EEPROBE_TOTAL_SLEEP_TIME_SSEND +
+    _EEPROBE_TOTAL_SLEEP_TIME_RSEND +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ALL +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ALL +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT_ALL +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT_ALL +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_SHARED +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_SHARED +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ORDERED +
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ORDERED +
+    _EEPROBE_TOTAL_SLEEP_TIME_RPUT +
+    _EEPROBE_TOTAL_SLEEP_TIME_RGET +
+    _EEPROBE_TOTAL_SLEEP_TIME_RACCUMULATE +
+    _EEPROBE_TOTAL_SLEEP_TIME_WIN_FENCE +
+    _EEPROBE_TOTAL_SLEEP_TIME_WIN_WAIT +
+    _EEPROBE_TOTAL_SLEEP_TIME_WIN_FLAG +
+    _EEPROBE_TOTAL_SLEEP_TIME_PARRIVED;
 }
 
 unsigned long
@@ -250,6 +539,91 @@ EEPROBE_getTotalSleepTimeBarrier() {
   return _EEPROBE_TOTAL_SLEEP_TIME_BARRIER;
 }
 
+unsigned long
+EEPROBE_getTotalSleepTimeScheduler() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_SCHEDULER;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeReactor() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_REACTOR;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeSend() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_SEND;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeSsend() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_SSEND;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeRsend() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_RSEND;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileRead() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileWrite() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileReadAt() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileWriteAt() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileReadAll() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ALL;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileWriteAll() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ALL;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileReadAtAll() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT_ALL;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileWriteAtAll() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT_ALL;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileReadShared() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_SHARED;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileWriteShared() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_SHARED;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileReadOrdered() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ORDERED;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeFileWriteOrdered() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ORDERED;
+}
+
 /* ---------------------------------------------------------------------------------- */
 
 unsigned long
@@ -261,10 +635,25 @@ EEPROBE_getTime() {
 
   return ((unsigned long) 1000000 * tv.tv_sec + tv.tv_usec);
   
+}
+
+  /**
+   * Returns the CLOCK_MONOTONIC time in nanoseconds.
+   */
+static unsigned long
+EEPROBE_getMonotonicTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((unsigned long) 1000000000 * ts.tv_sec + ts.tv_nsec);
+
 }
 
 /* ---------------------------------------------------------------------------------- */
 
+#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
 static void
 EEPROBE_updateTotalSleepTime(EEPROBE_ACTION action, unsigned long time) {
 
@@ -317,715 +706,5269 @@ EEPROBE_updateTotalSleepTime(EEPROBE_ACTION action, unsigned long time) {
   case EEPROBE_BARRIER:
     _EEPROBE_TOTAL_SLEEP_TIME_BARRIER += time;
     break;
+  case EEPROBE_SCHEDULER:
+    _EEPROBE_TOTAL_SLEEP_TIME_SCHEDULER += time;
+    break;
+  case EEPROBE_REACTOR:
+    _EEPROBE_TOTAL_SLEEP_TIME_REACTOR += time;
+    break;
+  case EEPROBE_SEND:
+    _EEPROBE_TOTAL_SLEEP_TIME_SEND += time;
+    break;
+  case EEPROBE_SSEND:
+    _EEPROBE_TOTAL_SLEEP_TIME_SSEND += time;
+    break;
+  case EEPROBE_RSEND:
+    _EEPROBE_TOTAL_SLEEP_TIME_RSEND += time;
+    break;
+  case EEPROBE_FILE_READ:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ += time;
+    break;
+  case EEPROBE_FILE_WRITE:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE += time;
+    break;
+  case EEPROBE_FILE_READ_AT:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT += time;
+    break;
+  case EEPROBE_FILE_WRITE_AT:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT += time;
+    break;
+  case EEPROBE_FILE_READ_ALL:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ALL += time;
+    break;
+  case EEPROBE_FILE_WRITE_ALL:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ALL += time;
+    break;
+  case EEPROBE_FILE_READ_AT_ALL:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT_ALL += time;
+    break;
+  case EEPROBE_FILE_WRITE_AT_ALL:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT_ALL += time;
+    break;
+  case EEPROBE_FILE_READ_SHARED:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_SHARED += time;
+    break;
+  case EEPROBE_FILE_WRITE_SHARED:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_SHARED += time;
+    break;
+  case EEPROBE_FILE_READ_ORDERED:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ORDERED += time;
+    break;
+  case EEPROBE_FILE_WRITE_ORDERED:
+    _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ORDERED += time;
+    break;
+  case EEPROBE_RPUT:
+    _EEPROBE_TOTAL_SLEEP_TIME_RPUT += time;
+    break;
+  case EEPROBE_RGET:
+    _EEPROBE_TOTAL_SLEEP_TIME_RGET += time;
+    break;
+  case EEPROBE_RACCUMULATE:
+    _EEPROBE_TOTAL_SLEEP_TIME_RACCUMULATE += time;
+    break;
+  case EEPROBE_WIN_FENCE:
+    _EEPROBE_TOTAL_SLEEP_TIME_WIN_FENCE += time;
+    break;
+  case EEPROBE_WIN_WAIT:
+    _EEPROBE_TOTAL_SLEEP_TIME_WIN_WAIT += time;
+    break;
+  case EEPROBE_WIN_FLAG:
+    _EEPROBE_TOTAL_SLEEP_TIME_WIN_FLAG += time;
+    break;
+  case EEPROBE_PARRIVED:
+    _EEPROBE_TOTAL_SLEEP_TIME_PARRIVED += time;
+    break;
   default:
     break;
   }
+
+  if (action < EEPROBE_NB_ACTION) {
+    _EEPROBE_STATS.actions[action].sleep_time += time;
+  }
   
 }
+#endif
 
-/* ---------------------------------------------------------------------------------- */
-
-int
-EEPROBE_Probe(int source, int tag, MPI_Comm comm, MPI_Status * status) {
-  return EEPROBE_Probe_Switch(source, tag, comm, status, EEPROBE_ENABLE);
-}
 
-int
-EEPROBE_Probe_Switch(int source, int tag, MPI_Comm comm, MPI_Status * status,
-		     EEPROBE_Enable enable) {
+unsigned long
+EEPROBE_getTotalSleepTimeAction(EEPROBE_ACTION action) {
 
+  switch(action) {
+  case EEPROBE_PROBE:
+    return _EEPROBE_TOTAL_SLEEP_TIME_PROBE;
+  case EEPROBE_WAIT:
+    return _EEPROBE_TOTAL_SLEEP_TIME_WAIT;
+  case EEPROBE_RECV:
+    return _EEPROBE_TOTAL_SLEEP_TIME_RECV;
+  case EEPROBE_REDUCE:
+    return _EEPROBE_TOTAL_SLEEP_TIME_REDUCE;
+  case EEPROBE_ALLREDUCE:
+    return _EEPROBE_TOTAL_SLEEP_TIME_ALLREDUCE;
+  case EEPROBE_ALLTOALL:
+    return _EEPROBE_TOTAL_SLEEP_TIME_ALLTOALL;
+  case EEPROBE_ALLTOALLV:
+    return _EEPROBE_TOTAL_SLEEP_TIME_ALLTOALLV;
+  case EEPROBE_ALLTOALLW:
+    return _EEPROBE_TOTAL_SLEEP_TIME_ALLTOALLW;
+  case EEPROBE_BCAST:
+    return _EEPROBE_TOTAL_SLEEP_TIME_BCAST;
+  case EEPROBE_SCATTER:
+    return _EEPROBE_TOTAL_SLEEP_TIME_SCATTER;
+  case EEPROBE_SCATTERV:
+    return _EEPROBE_TOTAL_SLEEP_TIME_SCATTERV;
+  case EEPROBE_GATHER:
+    return _EEPROBE_TOTAL_SLEEP_TIME_GATHER;
+  case EEPROBE_GATHERV:
+    return _EEPROBE_TOTAL_SLEEP_TIME_GATHERV;
+  case EEPROBE_ALLGATHER:
+    return _EEPROBE_TOTAL_SLEEP_TIME_ALLGATHER;
+  case EEPROBE_ALLGATHERV:
+    return _EEPROBE_TOTAL_SLEEP_TIME_ALLGATHERV;
+  case EEPROBE_BARRIER:
+    return _EEPROBE_TOTAL_SLEEP_TIME_BARRIER;
+  case EEPROBE_SCHEDULER:
+    return _EEPROBE_TOTAL_SLEEP_TIME_SCHEDULER;
+  case EEPROBE_REACTOR:
+    return _EEPROBE_TOTAL_SLEEP_TIME_REACTOR;
+  case EEPROBE_SEND:
+    return _EEPROBE_TOTAL_SLEEP_TIME_SEND;
+  case EEPROBE_SSEND:
+    return _EEPROBE_TOTAL_SLEEP_TIME_SSEND;
+  case EEPROBE_RSEND:
+    return _EEPROBE_TOTAL_SLEEP_TIME_RSEND;
+  case EEPROBE_FILE_READ:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ;
+  case EEPROBE_FILE_WRITE:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE;
+  case EEPROBE_FILE_READ_AT:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT;
+  case EEPROBE_FILE_WRITE_AT:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT;
+  case EEPROBE_FILE_READ_ALL:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ALL;
+  case EEPROBE_FILE_WRITE_ALL:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ALL;
+  case EEPROBE_FILE_READ_AT_ALL:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_AT_ALL;
+  case EEPROBE_FILE_WRITE_AT_ALL:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_AT_ALL;
+  case EEPROBE_FILE_READ_SHARED:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_SHARED;
+  case EEPROBE_FILE_WRITE_SHARED:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_SHARED;
+  case EEPROBE_FILE_READ_ORDERED:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_READ_ORDERED;
+  case EEPROBE_FILE_WRITE_ORDERED:
+    return _EEPROBE_TOTAL_SLEEP_TIME_FILE_WRITE_ORDERED;
+  case EEPROBE_RPUT:
+    return _EEPROBE_TOTAL_SLEEP_TIME_RPUT;
+  case EEPROBE_RGET:
+    return _EEPROBE_TOTAL_SLEEP_TIME_RGET;
+  case EEPROBE_RACCUMULATE:
+    return _EEPROBE_TOTAL_SLEEP_TIME_RACCUMULATE;
+  case EEPROBE_WIN_FENCE:
+    return _EEPROBE_TOTAL_SLEEP_TIME_WIN_FENCE;
+  case EEPROBE_WIN_WAIT:
+    return _EEPROBE_TOTAL_SLEEP_TIME_WIN_WAIT;
+  case EEPROBE_WIN_FLAG:
+    return _EEPROBE_TOTAL_SLEEP_TIME_WIN_FLAG;
+  case EEPROBE_PARRIVED:
+    return _EEPROBE_TOTAL_SLEEP_TIME_PARRIVED;
+  default:
+    return 0;
+  }
 
-#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
-  unsigned long start = 0;
-#endif
-  
-  int flag = 0;
+}
 
-  int errno = MPI_SUCCESS;
-    
-  struct timespec current_yield_duration;
+unsigned long
+EEPROBE_getTotalSleepTimeRput() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_RPUT;
+}
 
-  if (enable == EEPROBE_ENABLE) {
-    
-    current_yield_duration.tv_sec = 0;
-    current_yield_duration.tv_nsec = _EEPROBE_MIN_YIELD_TIME;
+unsigned long
+EEPROBE_getTotalSleepTimeRget() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_RGET;
+}
 
-    while ((flag == 0) && (errno == MPI_SUCCESS)) {
+unsigned long
+EEPROBE_getTotalSleepTimeRaccumulate() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_RACCUMULATE;
+}
 
-      errno = MPI_Iprobe(source, tag, comm, &flag, status);
+unsigned long
+EEPROBE_getTotalSleepTimeWinFence() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_WIN_FENCE;
+}
 
-      if (flag == 0) {
+unsigned long
+EEPROBE_getTotalSleepTimeWinWait() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_WIN_WAIT;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeWinFlag() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_WIN_FLAG;
+}
+
+unsigned long
+EEPROBE_getTotalSleepTimeParrived() {
+  return _EEPROBE_TOTAL_SLEEP_TIME_PARRIVED;
+}
+
+const char *
+EEPROBE_getActionName(EEPROBE_ACTION action) {
+  assert(action < EEPROBE_NB_ACTION);
+  return _EEPROBE_ACTION_NAMES[action];
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Returns the CPU time of the process in microseconds.
+   */
+static unsigned long
+EEPROBE_getCpuTime() {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+  return ((unsigned long) 1000000 * ts.tv_sec + ts.tv_nsec / 1000);
+
+}
+
+void
+EEPROBE_getStats(EEPROBE_Stats * stats) {
+
+  int i = 0;
+
+  assert(stats);
+
+  *stats = _EEPROBE_STATS;
+  stats->time = EEPROBE_getTime();
+  stats->cpu_time = EEPROBE_getCpuTime() - _EEPROBE_STATS_BASE.cpu_time;
+
+  for (i = 0; i < EEPROBE_NB_ACTION; i++) {
+    stats->actions[i].sleep_time -= _EEPROBE_STATS_BASE.actions[i].sleep_time;
+    stats->actions[i].nb_wait -= _EEPROBE_STATS_BASE.actions[i].nb_wait;
+    stats->actions[i].nb_poll -= _EEPROBE_STATS_BASE.actions[i].nb_poll;
+  }
+
+}
+
+void
+EEPROBE_resetStats() {
+  _EEPROBE_STATS_BASE = _EEPROBE_STATS;
+  _EEPROBE_STATS_BASE.cpu_time = EEPROBE_getCpuTime();
+}
+
+static void
+EEPROBE_removeStatsSegment() {
+  if (_EEPROBE_STATS_SEGMENT != NULL) {
+    munmap(_EEPROBE_STATS_SEGMENT, sizeof(EEPROBE_StatsSegment));
+    unlink(_EEPROBE_STATS_PATH);
+    _EEPROBE_STATS_SEGMENT = NULL;
+  }
+}
+
+  /**
+   * Copy the counters to the segment under the seqlock: seq is made odd before
+   * the copy and even after, with release ordering so that a reader seeing the
+   * same even value before and after its copy read consistent counters.
+   */
+static void
+EEPROBE_writeStatsSegment(unsigned long now) {
+
+  EEPROBE_StatsSegment * segment = _EEPROBE_STATS_SEGMENT;
+
+  unsigned int seq = segment->seq;
+
+  int initialized = 0;
+
+  int finalized = 0;
+
+  if (segment->rank < 0) {
+    MPI_Initialized(&initialized);
+    MPI_Finalized(&finalized);
+    if (initialized && !finalized) {
+      MPI_Comm_rank(MPI_COMM_WORLD, &(segment->rank));
+    }
+  }
+
+  _EEPROBE_STATS.time = EEPROBE_getTime();
+  _EEPROBE_STATS.cpu_time = EEPROBE_getCpuTime();
+
+  __atomic_store_n(&(segment->seq), seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  segment->stats = _EEPROBE_STATS;
+  __atomic_store_n(&(segment->seq), seq + 2, __ATOMIC_RELEASE);
+
+  _EEPROBE_STATS_NEXT = now + _EEPROBE_STATS_PERIOD;
+
+}
+
+  /**
+   * Update the segment if the period has elapsed. Called from the wait loops,
+   * so that the cost is paid while idle.
+   */
+static void
+EEPROBE_publishStats() {
+
+  unsigned long now = 0;
+
+  if (_EEPROBE_STATS_SEGMENT != NULL) {
+    now = EEPROBE_getMonotonicTime();
+    if (now >= _EEPROBE_STATS_NEXT) {
+      EEPROBE_writeStatsSegment(now);
+    }
+  }
+
+}
+
+int
+EEPROBE_setStatsPeriod(const char * directory, long period) {
+
+  EEPROBE_StatsSegment * segment = NULL;
+
+  int fd = -1;
+
+  EEPROBE_readEnvironment();
+
+  assert(period >= 0);
+
+  EEPROBE_removeStatsSegment();
+  _EEPROBE_STATS_PERIOD = 0;
+
+  if (period == 0) {
+    return 0;
+  }
+
+  snprintf(_EEPROBE_STATS_PATH, sizeof(_EEPROBE_STATS_PATH), "%s/eeprobe-stats.%d",
+	   (directory != NULL) ? directory : "/dev/shm", (int) getpid());
+
+  fd = open(_EEPROBE_STATS_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return -1;
+  }
+
+  /* the file is zero-filled, so magic is 0 until the header is written */
+  if (ftruncate(fd, sizeof(EEPROBE_StatsSegment)) != 0) {
+    close(fd);
+    unlink(_EEPROBE_STATS_PATH);
+    return -1;
+  }
+
+  segment = mmap(NULL, sizeof(EEPROBE_StatsSegment), PROT_READ | PROT_WRITE, MAP_SHARED,
+		 fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED) {
+    unlink(_EEPROBE_STATS_PATH);
+    return -1;
+  }
+
+  segment->version = EEPROBE_STATS_VERSION;
+  segment->size = sizeof(EEPROBE_StatsSegment);
+  segment->nb_action = EEPROBE_NB_ACTION;
+  segment->pid = getpid();
+  segment->rank = -1;
+  segment->start_time = EEPROBE_getTime();
+  gethostname(segment->hostname, EEPROBE_STATS_HOSTNAME_SIZE - 1);
+  __atomic_store_n(&(segment->magic), EEPROBE_STATS_MAGIC, __ATOMIC_RELEASE);
+
+  if (_EEPROBE_STATS_ATEXIT == 0) {
+    atexit(EEPROBE_removeStatsSegment);
+    _EEPROBE_STATS_ATEXIT = 1;
+  }
+
+  _EEPROBE_STATS_SEGMENT = segment;
+  _EEPROBE_STATS_PERIOD = period;
+  EEPROBE_writeStatsSegment(EEPROBE_getMonotonicTime());
+
+  return 0;
+
+}
+
+  /**
+   * Count an unsuccessful poll of a wait.
+   */
+static void
+EEPROBE_countPoll(EEPROBE_Backoff * backoff, EEPROBE_ACTION action) {
+  backoff->nb_poll++;
+  backoff->last_action = action;
+  _EEPROBE_STATS.actions[action].nb_poll++;
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+static int
+EEPROBE_checkTpause() {
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  unsigned int eax = 0;
+
+  unsigned int ebx = 0;
+
+  unsigned int ecx = 0;
+
+  unsigned int edx = 0;
+
+  uint64_t tsc_start = 0;
+
+  uint64_t tsc_end = 0;
+
+  struct timespec start;
+
+  struct timespec end;
+
+  struct timespec duration;
+
+  if (_EEPROBE_TPAUSE_AVAILABLE == -1) {
+
+    _EEPROBE_TPAUSE_AVAILABLE = 0;
+
+    /* CPUID.(EAX=07H, ECX=0H):ECX.WAITPKG[bit 5] */
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ecx & (1 << 5))) {
+
+      /* tpause deadlines are given in TSC ticks, measure the TSC frequency once */
+      duration.tv_sec = 0;
+      duration.tv_nsec = 2000000;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      tsc_start = __builtin_ia32_rdtsc();
+      clock_nanosleep(CLOCK_MONOTONIC, 0, &duration, NULL);
+      tsc_end = __builtin_ia32_rdtsc();
+      clock_gettime(CLOCK_MONOTONIC, &end);
+
+      _EEPROBE_TSC_PER_NS = (double) (tsc_end - tsc_start) /
+	(double) ((end.tv_sec - start.tv_sec) * 1000000000L + end.tv_nsec - start.tv_nsec);
+      _EEPROBE_TPAUSE_AVAILABLE = (_EEPROBE_TSC_PER_NS > 0.0);
+
+    }
+
+  }
+
+#else
+
+  _EEPROBE_TPAUSE_AVAILABLE = 0;
+
+#endif
+
+  return _EEPROBE_TPAUSE_AVAILABLE;
+
+}
+
+static void
+EEPROBE_idleTpause(long duration) {
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  uint64_t deadline = __builtin_ia32_rdtsc() + (uint64_t) (duration * _EEPROBE_TSC_PER_NS);
+
+  /* the OS bounds a single tpause (IA32_UMWAIT_CONTROL), loop up to the deadline.
+     tpause ecx is encoded directly to avoid requiring -mwaitpkg, ecx = 1 selects
+     the light C0.1 state */
+  while (__builtin_ia32_rdtsc() < deadline) {
+    __asm__ volatile (".byte 0x66, 0x0f, 0xae, 0xf1"
+		      :
+		      : "c" (1), "a" ((uint32_t) deadline), "d" ((uint32_t) (deadline >> 32))
+		      : "cc", "memory");
+  }
 
-#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
-	start = EEPROBE_getTime();
 #endif
-      
-	clock_nanosleep(CLOCK_MONOTONIC, 0, &current_yield_duration, NULL);
 
-#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
-	EEPROBE_updateTotalSleepTime(EEPROBE_PROBE, EEPROBE_getTime() - start);
-#endif
+}
+
+static int
+EEPROBE_checkTimerfd() {
+
+  struct epoll_event event;
+
+  if (_EEPROBE_TIMERFD == -1) {
+
+    _EEPROBE_TIMERFD = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    _EEPROBE_EPOLLFD = epoll_create1(EPOLL_CLOEXEC);
+
+    event.events = EPOLLIN;
+    event.data.fd = _EEPROBE_TIMERFD;
+
+    if ((_EEPROBE_TIMERFD < 0) || (_EEPROBE_EPOLLFD < 0) ||
+	(epoll_ctl(_EEPROBE_EPOLLFD, EPOLL_CTL_ADD, _EEPROBE_TIMERFD, &event) != 0)) {
+      if (_EEPROBE_TIMERFD >= 0) {
+	close(_EEPROBE_TIMERFD);
+      }
+      if (_EEPROBE_EPOLLFD >= 0) {
+	close(_EEPROBE_EPOLLFD);
+      }
+      _EEPROBE_TIMERFD = -2;
+      _EEPROBE_EPOLLFD = -2;
+    }
+
+  }
+
+  return (_EEPROBE_TIMERFD >= 0);
+
+}
+
+static void
+EEPROBE_idleTimerfd(long duration) {
+
+  struct itimerspec timer;
+
+  struct epoll_event event;
+
+  uint64_t expirations = 0;
+
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_nsec = 0;
+  timer.it_value.tv_sec = duration / 1000000000;
+  timer.it_value.tv_nsec = duration % 1000000000;
+  /* a zero value would disarm the timer */
+  if (duration <= 0) {
+    timer.it_value.tv_nsec = 1;
+  }
+
+  timerfd_settime(_EEPROBE_TIMERFD, 0, &timer, NULL);
+
+  if (epoll_wait(_EEPROBE_EPOLLFD, &event, 1, -1) == 1) {
+    if (read(_EEPROBE_TIMERFD, &expirations, sizeof(expirations)) < 0) {
+      expirations = 0;
+    }
+  }
+
+}
+
+static void
+EEPROBE_idleUntil(unsigned long deadline) {
+
+  struct timespec ts;
+
+  ts.tv_sec = deadline / 1000000000;
+  ts.tv_nsec = deadline % 1000000000;
+
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+}
+
+static void
+EEPROBE_idleNanosleepAbs(long duration) {
+  EEPROBE_idleUntil(EEPROBE_getMonotonicTime() + duration);
+}
+
+  /**
+   * Idle for the given duration with the selected primitive, falling back to
+   * clock_nanosleep when the primitive is not available on this machine.
+   */
+static void
+EEPROBE_idle(long duration) {
+
+  EEPROBE_IdlePrimitive primitive = _EEPROBE_IDLE_PRIMITIVE;
+
+  struct timespec current_yield_duration;
+
+  if (primitive == EEPROBE_IDLE_AUTO) {
+    if (duration >= _EEPROBE_IDLE_AUTO_SLEEP_TIME) {
+      primitive = EEPROBE_IDLE_NANOSLEEP_ABS;
+    } else if (EEPROBE_checkTpause()) {
+      primitive = EEPROBE_IDLE_TPAUSE;
+    } else {
+      primitive = EEPROBE_IDLE_YIELD;
+    }
+  }
+
+  if ((primitive == EEPROBE_IDLE_TPAUSE) && !EEPROBE_checkTpause()) {
+    primitive = EEPROBE_IDLE_NANOSLEEP;
+  }
+
+  if ((primitive == EEPROBE_IDLE_TIMERFD) && !EEPROBE_checkTimerfd()) {
+    primitive = EEPROBE_IDLE_NANOSLEEP;
+  }
+
+  switch(primitive) {
+  case EEPROBE_IDLE_YIELD:
+    sched_yield();
+    break;
+  case EEPROBE_IDLE_NANOSLEEP_ABS:
+    EEPROBE_idleNanosleepAbs(duration);
+    break;
+  case EEPROBE_IDLE_TIMERFD:
+    EEPROBE_idleTimerfd(duration);
+    break;
+  case EEPROBE_IDLE_TPAUSE:
+    EEPROBE_idleTpause(duration);
+    break;
+  case EEPROBE_IDLE_NANOSLEEP:
+  default:
+    current_yield_duration.tv_sec = duration / 1000000000;
+    current_yield_duration.tv_nsec = duration % 1000000000;
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &current_yield_duration, NULL);
+    break;
+  }
+
+}
+
+void
+EEPROBE_setIdlePrimitive(EEPROBE_IdlePrimitive primitive) {
+  _EEPROBE_IDLE_PRIMITIVE = primitive;
+}
+
+EEPROBE_IdlePrimitive
+EEPROBE_getIdlePrimitive() {
+  return _EEPROBE_IDLE_PRIMITIVE;
+}
+
+int
+EEPROBE_isIdlePrimitiveAvailable(EEPROBE_IdlePrimitive primitive) {
+
+  switch(primitive) {
+  case EEPROBE_IDLE_TPAUSE:
+    return EEPROBE_checkTpause();
+  case EEPROBE_IDLE_TIMERFD:
+    return EEPROBE_checkTimerfd();
+  default:
+    return 1;
+  }
+
+}
+
+void
+EEPROBE_setIdleAutoSleepTime(long sleep_time) {
+  assert(sleep_time >= 0);
+  assert(sleep_time < 1000000000);
+  _EEPROBE_IDLE_AUTO_SLEEP_TIME = sleep_time;
+}
+
+long
+EEPROBE_getIdleAutoSleepTime() {
+  return _EEPROBE_IDLE_AUTO_SLEEP_TIME;
+}
+
+int
+EEPROBE_setTimerSlack(unsigned long timer_slack) {
+  return prctl(PR_SET_TIMERSLACK, timer_slack, 0, 0, 0);
+}
+
+long
+EEPROBE_getTimerSlack() {
+  return prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+}
+
+void
+EEPROBE_setWakeupGrid(long grid, long threshold) {
+  EEPROBE_readEnvironment();
+  assert(grid >= 0);
+  assert(grid < 1000000000);
+  assert(threshold >= 0);
+  _EEPROBE_WAKEUP_GRID = grid;
+  _EEPROBE_WAKEUP_THRESHOLD = threshold;
+}
+
+void
+EEPROBE_getWakeupGrid(long * grid, long * threshold) {
+  assert(grid);
+  assert(threshold);
+  *grid = _EEPROBE_WAKEUP_GRID;
+  *threshold = _EEPROBE_WAKEUP_THRESHOLD;
+}
+
+  /**
+   * Round a deadline up to the wake-up grid, or down when rounding up would
+   * exceed the limit (0 for no limit). The deadline is returned unchanged when
+   * rounding down would end before now.
+   */
+static unsigned long
+EEPROBE_alignDeadline(unsigned long now, unsigned long deadline, unsigned long limit) {
+
+  unsigned long grid = _EEPROBE_WAKEUP_GRID;
+
+  unsigned long aligned = ((deadline + grid - 1) / grid) * grid;
+
+  if ((limit == 0) || (aligned <= limit)) {
+    return aligned;
+  }
+
+  if (aligned - grid > now) {
+    return aligned - grid;
+  }
+
+  return deadline;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+#define _EEPROBE_CALIBRATION_NB_REPEAT_SLEEP 20
+
+#define _EEPROBE_CALIBRATION_NB_REPEAT_CALL 1000
+
+#define _EEPROBE_CALIBRATION_HOSTNAME_SIZE 256
+
+#define _EEPROBE_CALIBRATION_PATH_SIZE 4096
+
+  /* arbitrary tag used to measure MPI_Test on a request that never completes */
+#define _EEPROBE_CALIBRATION_TAG 32766
+
+static const long _EEPROBE_CALIBRATION_SLEEP_REQUESTED[EEPROBE_CALIBRATION_NB_SLEEP] =
+  {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+static void
+EEPROBE_deriveCalibration(EEPROBE_Calibration * calibration) {
+
+  long poll_cost = 0;
+
+  poll_cost = calibration->iprobe_cost_world;
+  if (calibration->test_cost > poll_cost) {
+    poll_cost = calibration->test_cost;
+  }
+
+  /* a sleep lasts about requested + overshoot: start at the shortest real
+     sleep, make each step a quarter of the overshoot so that the ramp is not
+     hidden by the timer slack, and stop once polling costs less than 1% of
+     the sleep, but not before the overshoot has been exceeded a few times */
+  calibration->min_yield_time = 0;
+
+  calibration->inc_yield_time = calibration->sleep_overshoot / 4;
+  if (calibration->inc_yield_time < 1) {
+    calibration->inc_yield_time = 1;
+  }
+
+  calibration->max_yield_time = 100 * poll_cost - calibration->sleep_overshoot;
+  if (calibration->max_yield_time < 4 * calibration->sleep_overshoot) {
+    calibration->max_yield_time = 4 * calibration->sleep_overshoot;
+  }
+  if (calibration->max_yield_time < calibration->inc_yield_time) {
+    calibration->max_yield_time = calibration->inc_yield_time;
+  }
+  if (calibration->max_yield_time > 999999999) {
+    calibration->max_yield_time = 999999999;
+  }
+
+}
+
+static long
+EEPROBE_medianOvershoot(const EEPROBE_Calibration * calibration) {
+
+  long overshoot[EEPROBE_CALIBRATION_NB_SLEEP];
+
+  long value = 0;
+
+  int i = 0;
+
+  int j = 0;
+
+  for (i = 0; i < EEPROBE_CALIBRATION_NB_SLEEP; i++) {
+    value = calibration->sleep_measured[i] - calibration->sleep_requested[i];
+    if (value < 0) {
+      value = 0;
+    }
+    for (j = i; (j > 0) && (overshoot[j - 1] > value); j--) {
+      overshoot[j] = overshoot[j - 1];
+    }
+    overshoot[j] = value;
+  }
+
+  return overshoot[EEPROBE_CALIBRATION_NB_SLEEP / 2];
+
+}
+
+static int
+EEPROBE_measureCalibration(EEPROBE_Calibration * calibration) {
+
+  int i = 0;
+
+  int j = 0;
+
+  int flag = 0;
+
+  int buffer = 0;
+
+  int errno = MPI_SUCCESS;
+
+  unsigned long start = 0;
+
+  MPI_Request request;
+
+  MPI_Status status;
+
+  /* timer read */
+  start = EEPROBE_getMonotonicTime();
+  for (j = 0; j < _EEPROBE_CALIBRATION_NB_REPEAT_CALL; j++) {
+    EEPROBE_getMonotonicTime();
+  }
+  calibration->timer_cost = (EEPROBE_getMonotonicTime() - start) / _EEPROBE_CALIBRATION_NB_REPEAT_CALL;
+
+  /* sleep overshoot, with the current idle primitive */
+  for (i = 0; i < EEPROBE_CALIBRATION_NB_SLEEP; i++) {
+    calibration->sleep_requested[i] = _EEPROBE_CALIBRATION_SLEEP_REQUESTED[i];
+    start = EEPROBE_getMonotonicTime();
+    for (j = 0; j < _EEPROBE_CALIBRATION_NB_REPEAT_SLEEP; j++) {
+      EEPROBE_idle(calibration->sleep_requested[i]);
+    }
+    calibration->sleep_measured[i] = (EEPROBE_getMonotonicTime() - start) / _EEPROBE_CALIBRATION_NB_REPEAT_SLEEP;
+  }
+  calibration->sleep_overshoot = EEPROBE_medianOvershoot(calibration);
+
+  /* MPI_Iprobe on a local and on the global communicator */
+  start = EEPROBE_getMonotonicTime();
+  for (j = 0; (j < _EEPROBE_CALIBRATION_NB_REPEAT_CALL) && (errno == MPI_SUCCESS); j++) {
+    errno = MPI_Iprobe(MPI_ANY_SOURCE, _EEPROBE_CALIBRATION_TAG, MPI_COMM_SELF, &flag, &status);
+  }
+  calibration->iprobe_cost_self = (EEPROBE_getMonotonicTime() - start) / _EEPROBE_CALIBRATION_NB_REPEAT_CALL;
+
+  start = EEPROBE_getMonotonicTime();
+  for (j = 0; (j < _EEPROBE_CALIBRATION_NB_REPEAT_CALL) && (errno == MPI_SUCCESS); j++) {
+    errno = MPI_Iprobe(MPI_ANY_SOURCE, _EEPROBE_CALIBRATION_TAG, MPI_COMM_WORLD, &flag, &status);
+  }
+  calibration->iprobe_cost_world = (EEPROBE_getMonotonicTime() - start) / _EEPROBE_CALIBRATION_NB_REPEAT_CALL;
+
+  /* MPI_Test on a pending receive, cancelled afterwards */
+  if (errno == MPI_SUCCESS) {
+    errno = MPI_Irecv(&buffer, 1, MPI_INT, MPI_ANY_SOURCE, _EEPROBE_CALIBRATION_TAG,
+		      MPI_COMM_SELF, &request);
+  }
+  if (errno == MPI_SUCCESS) {
+    flag = 0;
+    start = EEPROBE_getMonotonicTime();
+    for (j = 0; (j < _EEPROBE_CALIBRATION_NB_REPEAT_CALL) && (errno == MPI_SUCCESS) && (flag == 0); j++) {
+      errno = MPI_Test(&request, &flag, &status);
+    }
+    calibration->test_cost = (EEPROBE_getMonotonicTime() - start) / _EEPROBE_CALIBRATION_NB_REPEAT_CALL;
+    if (flag == 0) {
+      MPI_Cancel(&request);
+      MPI_Wait(&request, &status);
+    }
+  }
+
+  return errno;
+
+}
+
+static int
+EEPROBE_readCalibration(const char * cache_path, EEPROBE_Calibration * calibration) {
+
+  FILE * file = NULL;
+
+  char hostname[_EEPROBE_CALIBRATION_HOSTNAME_SIZE];
+
+  char cached_hostname[_EEPROBE_CALIBRATION_HOSTNAME_SIZE];
+
+  int i = 0;
+
+  int nb_read = 0;
+
+  file = fopen(cache_path, "r");
+  if (file == NULL) {
+    return 0;
+  }
+
+  gethostname(hostname, _EEPROBE_CALIBRATION_HOSTNAME_SIZE);
+  hostname[_EEPROBE_CALIBRATION_HOSTNAME_SIZE - 1] = '\0';
+
+  nb_read += fscanf(file, "hostname %255s\n", cached_hostname);
+  nb_read += fscanf(file, "timer_cost %ld\n", &(calibration->timer_cost));
+  nb_read += fscanf(file, "iprobe_cost_self %ld\n", &(calibration->iprobe_cost_self));
+  nb_read += fscanf(file, "iprobe_cost_world %ld\n", &(calibration->iprobe_cost_world));
+  nb_read += fscanf(file, "test_cost %ld\n", &(calibration->test_cost));
+  for (i = 0; i < EEPROBE_CALIBRATION_NB_SLEEP; i++) {
+    nb_read += fscanf(file, "sleep %ld %ld\n", &(calibration->sleep_requested[i]),
+		      &(calibration->sleep_measured[i]));
+  }
+
+  fclose(file);
+
+  calibration->sleep_overshoot = EEPROBE_medianOvershoot(calibration);
+
+  return ((nb_read == 5 + 2 * EEPROBE_CALIBRATION_NB_SLEEP) &&
+	  (strcmp(hostname, cached_hostname) == 0));
+
+}
+
+static void
+EEPROBE_writeCalibration(const char * cache_path, const EEPROBE_Calibration * calibration) {
+
+  FILE * file = NULL;
+
+  char hostname[_EEPROBE_CALIBRATION_HOSTNAME_SIZE];
+
+  char tmp_path[_EEPROBE_CALIBRATION_PATH_SIZE];
+
+  int i = 0;
+
+  /* the ranks of a host all write the cache: each one writes its own file
+     and renames it into place, so that readers never see a mixed file */
+  if (snprintf(tmp_path, sizeof(tmp_path), "%s.%d", cache_path, (int) getpid())
+      >= (int) sizeof(tmp_path)) {
+    return;
+  }
+
+  file = fopen(tmp_path, "w");
+  if (file == NULL) {
+    return;
+  }
+
+  gethostname(hostname, _EEPROBE_CALIBRATION_HOSTNAME_SIZE);
+  hostname[_EEPROBE_CALIBRATION_HOSTNAME_SIZE - 1] = '\0';
+
+  fprintf(file, "hostname %s\n", hostname);
+  fprintf(file, "timer_cost %ld\n", calibration->timer_cost);
+  fprintf(file, "iprobe_cost_self %ld\n", calibration->iprobe_cost_self);
+  fprintf(file, "iprobe_cost_world %ld\n", calibration->iprobe_cost_world);
+  fprintf(file, "test_cost %ld\n", calibration->test_cost);
+  for (i = 0; i < EEPROBE_CALIBRATION_NB_SLEEP; i++) {
+    fprintf(file, "sleep %ld %ld\n", calibration->sleep_requested[i],
+	    calibration->sleep_measured[i]);
+  }
+
+  if ((fclose(file) != 0) || (rename(tmp_path, cache_path) != 0)) {
+    remove(tmp_path);
+  }
+
+}
+
+int
+EEPROBE_Calibrate(const char * cache_path) {
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_readEnvironment();
+
+  if ((cache_path == NULL) || !EEPROBE_readCalibration(cache_path, &_EEPROBE_CALIBRATION)) {
+
+    errno = EEPROBE_measureCalibration(&_EEPROBE_CALIBRATION);
+
+    if ((errno == MPI_SUCCESS) && (cache_path != NULL)) {
+      EEPROBE_writeCalibration(cache_path, &_EEPROBE_CALIBRATION);
+    }
+
+  }
+
+  if (errno == MPI_SUCCESS) {
+
+    EEPROBE_deriveCalibration(&_EEPROBE_CALIBRATION);
+
+    EEPROBE_setMinYieldTime(_EEPROBE_CALIBRATION.min_yield_time);
+    EEPROBE_setIncYieldTime(_EEPROBE_CALIBRATION.inc_yield_time);
+    EEPROBE_setMaxYieldTime(_EEPROBE_CALIBRATION.max_yield_time);
+
+    _EEPROBE_CALIBRATED = 1;
+
+  }
+
+  return errno;
+
+}
+
+int
+EEPROBE_getCalibration(EEPROBE_Calibration * calibration) {
+
+  assert(calibration);
+
+  if (_EEPROBE_CALIBRATED == 1) {
+    *calibration = _EEPROBE_CALIBRATION;
+    return 1;
+  }
+
+  return 0;
+
+}
+
+void
+EEPROBE_printCalibration() {
+
+  int i = 0;
+
+  if (_EEPROBE_CALIBRATED != 1) {
+    fprintf(stdout, "EEProbe calibration: not calibrated\n");
+    return;
+  }
+
+  fprintf(stdout, "EEProbe calibration: timer_cost %ld iprobe_cost_self %ld iprobe_cost_world %ld test_cost %ld\n",
+	  _EEPROBE_CALIBRATION.timer_cost, _EEPROBE_CALIBRATION.iprobe_cost_self,
+	  _EEPROBE_CALIBRATION.iprobe_cost_world, _EEPROBE_CALIBRATION.test_cost);
+
+  for (i = 0; i < EEPROBE_CALIBRATION_NB_SLEEP; i++) {
+    fprintf(stdout, "EEProbe calibration: sleep requested %ld measured %ld\n",
+	    _EEPROBE_CALIBRATION.sleep_requested[i], _EEPROBE_CALIBRATION.sleep_measured[i]);
+  }
+
+  fprintf(stdout, "EEProbe calibration: sleep_overshoot %ld min_yield_time %ld inc_yield_time %ld max_yield_time %ld\n",
+	  _EEPROBE_CALIBRATION.sleep_overshoot, _EEPROBE_CALIBRATION.min_yield_time,
+	  _EEPROBE_CALIBRATION.inc_yield_time, _EEPROBE_CALIBRATION.max_yield_time);
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /* minimum step of the online overshoot percentile estimate */
+#define _EEPROBE_LATENCY_MIN_STEP 32
+
+void
+EEPROBE_setLatencyTarget(double percentile, unsigned long latency) {
+
+  EEPROBE_readEnvironment();
+
+  assert(percentile > 0.0);
+  assert(percentile < 100.0);
+
+  _EEPROBE_LATENCY_PERCENTILE = percentile;
+  _EEPROBE_LATENCY_TARGET = latency;
+
+  /* seed the overshoot estimate with the calibration when available, with the
+     timer slack otherwise */
+  if (_EEPROBE_CALIBRATED == 1) {
+    _EEPROBE_LATENCY_OVERSHOOT = _EEPROBE_CALIBRATION.sleep_overshoot;
+  } else {
+    _EEPROBE_LATENCY_OVERSHOOT = EEPROBE_getTimerSlack();
+  }
+
+  memset(_EEPROBE_LATENCY_STATS, 0, sizeof(_EEPROBE_LATENCY_STATS));
+
+}
+
+void
+EEPROBE_getLatencyTarget(double * percentile, unsigned long * latency) {
+  assert(percentile);
+  assert(latency);
+  *percentile = _EEPROBE_LATENCY_PERCENTILE;
+  *latency = _EEPROBE_LATENCY_TARGET;
+}
+
+long
+EEPROBE_getLatencyOvershoot() {
+  return _EEPROBE_LATENCY_OVERSHOOT;
+}
+
+void
+EEPROBE_getLatencyStats(EEPROBE_ACTION action, EEPROBE_LatencyStats * stats) {
+  assert(action < EEPROBE_NB_ACTION);
+  assert(stats);
+  *stats = _EEPROBE_LATENCY_STATS[action];
+}
+
+  /**
+   * Returns the longest sleep meeting the latency target, or a negative value
+   * when the wait must busy-poll.
+   */
+static long
+EEPROBE_latencyBudget() {
+  return (long) _EEPROBE_LATENCY_TARGET - _EEPROBE_LATENCY_OVERSHOOT;
+}
+
+  /**
+   * Update the overshoot percentile estimate with a measured sleep. The estimate
+   * moves up by p and down by (1 - p) times the step, so that it converges to
+   * the value exceeded by a fraction (1 - p) of the samples.
+   */
+static void
+EEPROBE_recordOvershoot(long overshoot) {
+
+  long step = _EEPROBE_LATENCY_OVERSHOOT / 32;
+
+  if (step < _EEPROBE_LATENCY_MIN_STEP) {
+    step = _EEPROBE_LATENCY_MIN_STEP;
+  }
+
+  if (overshoot > _EEPROBE_LATENCY_OVERSHOOT) {
+    _EEPROBE_LATENCY_OVERSHOOT += (long) (step * _EEPROBE_LATENCY_PERCENTILE / 100.0);
+  } else {
+    _EEPROBE_LATENCY_OVERSHOOT -= (long) (step * (100.0 - _EEPROBE_LATENCY_PERCENTILE) / 100.0);
+    if (_EEPROBE_LATENCY_OVERSHOOT < 0) {
+      _EEPROBE_LATENCY_OVERSHOOT = 0;
+    }
+  }
+
+}
+
+static const char * _EEPROBE_POLICY_NAMES[] = {"linear", "exponential", "constant", "spin"};
+
+  /**
+   * Read the EEPROBE_<ACTION>_PARAMS=min:inc:max[:policy] override of an action.
+   * Malformed values are ignored.
+   */
+static void
+EEPROBE_readActionParams(EEPROBE_ACTION action) {
+
+  char name[64];
+
+  const char * value = NULL;
+
+  char policy_name[16];
+
+  long min_yield_time = 0;
+
+  long inc_yield_time = 0;
+
+  long max_yield_time = 0;
+
+  int nb_read = 0;
+
+  int i = 0;
+
+  snprintf(name, sizeof(name), "EEPROBE_%s_PARAMS", _EEPROBE_ACTION_NAMES[action]);
+  for (i = 0; name[i] != '\0'; i++) {
+    name[i] = toupper((unsigned char) name[i]);
+  }
+
+  value = getenv(name);
+
+  if (value == NULL) {
+    return;
+  }
+
+  policy_name[0] = '\0';
+  nb_read = sscanf(value, "%ld:%ld:%ld:%15s", &min_yield_time, &inc_yield_time,
+		   &max_yield_time, policy_name);
+
+  if ((nb_read < 3) || (min_yield_time < 0) || (inc_yield_time <= 0) ||
+      (max_yield_time < min_yield_time) || (max_yield_time >= 1000000000)) {
+    return;
+  }
+
+  for (i = 0; i <= EEPROBE_POLICY_SPIN; i++) {
+    if ((nb_read == 3) || (strcmp(policy_name, _EEPROBE_POLICY_NAMES[i]) == 0)) {
+      EEPROBE_setActionParams(action, min_yield_time, inc_yield_time, max_yield_time,
+			      (nb_read == 3) ? EEPROBE_POLICY_LINEAR : (EEPROBE_Policy) i);
+      return;
+    }
+  }
+
+}
+
+  /**
+   * Run the calibration requested with EEPROBE_CALIBRATE=1 once MPI is
+   * initialized, at the latest at the first wait, since it issues MPI calls.
+   * Yield times set through the API in the meantime are kept.
+   */
+static void
+EEPROBE_calibrateEnvironment() {
+
+  int initialized = 0;
+
+  int finalized = 0;
+
+  int yield_times_set = _EEPROBE_YIELD_TIMES_SET;
+
+  long min_yield_time = _EEPROBE_MIN_YIELD_TIME;
+
+  long inc_yield_time = _EEPROBE_INC_YIELD_TIME;
+
+  long max_yield_time = _EEPROBE_MAX_YIELD_TIME;
+
+  if (_EEPROBE_CALIBRATION_PENDING == 0) {
+    return;
+  }
+
+  MPI_Initialized(&initialized);
+  MPI_Finalized(&finalized);
+
+  if ((initialized == 0) || (finalized != 0)) {
+    return;
+  }
+
+  _EEPROBE_CALIBRATION_PENDING = 0;
+
+  EEPROBE_Calibrate(getenv("EEPROBE_CALIBRATION_FILE"));
+
+  if (yield_times_set & 1) {
+    _EEPROBE_MIN_YIELD_TIME = min_yield_time;
+  }
+
+  if (yield_times_set & 2) {
+    _EEPROBE_INC_YIELD_TIME = inc_yield_time;
+  }
+
+  if (yield_times_set & 4) {
+    _EEPROBE_MAX_YIELD_TIME = max_yield_time;
+  }
+
+}
+
+  /**
+   * Read the environment variables once, at the first wait or the first call
+   * to a setter, so that the setters override them:
+   * EEPROBE_CALIBRATE=1 calibrates once MPI is initialized,
+   * EEPROBE_CALIBRATION_FILE optionally gives
+   * the cache file, EEPROBE_PREDICTOR=1 enables the predictor,
+   * EEPROBE_WARM_START=1 enables warm start, EEPROBE_LATENCY_TARGET=p:ns sets
+   * the latency target, EEPROBE_<ACTION>_PARAMS=min:inc:max[:policy] overrides
+   * the yield times of an action, EEPROBE_WAKEUP_GRID=grid:threshold sets the
+   * wake-up grid, EEPROBE_PROGRESS=bytes:ns sets the progress parameters,
+   * EEPROBE_STATS=ns publishes the counters, in EEPROBE_STATS_DIR if set.
+   */
+static void
+EEPROBE_readEnvironment() {
+
+  const char * value = NULL;
+
+  char * end = NULL;
+
+  double percentile = 0.0;
+
+  int action = 0;
+
+  long grid = 0;
+
+  long threshold = 0;
+
+  long period = 0;
+
+  if (_EEPROBE_ENVIRONMENT_READ == 0) {
+
+    _EEPROBE_ENVIRONMENT_READ = 1;
+
+    value = getenv("EEPROBE_CALIBRATE");
+
+    if ((value != NULL) && (strcmp(value, "1") == 0)) {
+      _EEPROBE_CALIBRATION_PENDING = 1;
+      EEPROBE_calibrateEnvironment();
+    }
+
+    value = getenv("EEPROBE_PREDICTOR");
+
+    if ((value != NULL) && (strcmp(value, "1") == 0)) {
+      _EEPROBE_PREDICTOR = EEPROBE_ENABLE;
+    }
+
+    value = getenv("EEPROBE_WARM_START");
+
+    if ((value != NULL) && (strcmp(value, "1") == 0)) {
+      _EEPROBE_WARM_START = EEPROBE_ENABLE;
+    }
+
+    for (action = 0; action < EEPROBE_NB_ACTION; action++) {
+      EEPROBE_readActionParams(action);
+    }
+
+    value = getenv("EEPROBE_PROGRESS");
+
+    if (value != NULL) {
+      if ((sscanf(value, "%ld:%ld", &grid, &threshold) == 2) &&
+	  (grid >= 0) && (threshold >= 0) && (threshold < 1000000000)) {
+	EEPROBE_setProgressParams(grid, threshold);
+      }
+    }
+
+    value = getenv("EEPROBE_WAKEUP_GRID");
+
+    if (value != NULL) {
+      if ((sscanf(value, "%ld:%ld", &grid, &threshold) == 2) &&
+	  (grid >= 0) && (grid < 1000000000) && (threshold >= 0)) {
+	EEPROBE_setWakeupGrid(grid, threshold);
+      }
+    }
+
+    value = getenv("EEPROBE_LATENCY_TARGET");
+
+    if (value != NULL) {
+      percentile = strtod(value, &end);
+      if ((*end == ':') && (percentile > 0.0) && (percentile < 100.0)) {
+	EEPROBE_setLatencyTarget(percentile, strtoul(end + 1, NULL, 10));
+      }
+    }
+
+    value = getenv("EEPROBE_STATS");
+
+    if (value != NULL) {
+      period = strtol(value, NULL, 10);
+      if (period > 0) {
+	EEPROBE_setStatsPeriod(getenv("EEPROBE_STATS_DIR"), period);
+      }
+    }
+
+  }
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+void
+EEPROBE_Backoff_init(EEPROBE_Backoff * backoff) {
+  assert(backoff);
+  EEPROBE_readEnvironment();
+  EEPROBE_calibrateEnvironment();
+  backoff->current_yield_time = _EEPROBE_MIN_YIELD_TIME;
+  backoff->prediction = EEPROBE_PREDICTION_NONE;
+  backoff->wake_time = 0;
+  backoff->dense_until = 0;
+  backoff->last_delay = 0;
+  backoff->last_action = EEPROBE_PROBE;
+  backoff->progress_yield_time = -1;
+  backoff->nb_poll = 0;
+}
+
+void
+EEPROBE_Backoff_yield(EEPROBE_Backoff * backoff, EEPROBE_ACTION action) {
+
+#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
+  unsigned long start = 0;
+#endif
+
+  long work_time = 0;
+
+  long duration = 0;
+
+  long budget = 0;
+
+  int ramp = 1;
+
+  unsigned long now = 0;
+
+  unsigned long sleep_start = 0;
+
+  EEPROBE_ActionParams params;
+
+  assert(backoff);
+
+  EEPROBE_getActionParams(action, &params);
+
+  EEPROBE_countPoll(backoff, action);
+
+  if ((params.policy == EEPROBE_POLICY_SPIN) || (backoff->progress_yield_time == 0)) {
+    backoff->last_delay = 0;
+    _EEPROBE_STATS.current_yield_time = 0;
+    EEPROBE_publishStats();
+    return;
+  }
+
+  if (backoff->current_yield_time < params.min_yield_time) {
+    backoff->current_yield_time = params.min_yield_time;
+  }
+  if (backoff->current_yield_time > params.max_yield_time) {
+    backoff->current_yield_time = params.max_yield_time;
+  }
+
+  _EEPROBE_STATS.current_yield_time = backoff->current_yield_time;
+  EEPROBE_publishStats();
+
+  duration = backoff->current_yield_time;
+
+  /* predictive wake-up: a single long sleep up to shortly before the predicted
+     arrival, then dense polling at the current yield time until the end of the
+     prediction window, then the usual ramp */
+  if (backoff->prediction != EEPROBE_PREDICTION_NONE) {
+    now = EEPROBE_getMonotonicTime();
+    if (backoff->prediction == EEPROBE_PREDICTION_PENDING) {
+      backoff->prediction = EEPROBE_PREDICTION_AWAKE;
+      if (backoff->wake_time > now) {
+	duration = backoff->wake_time - now;
+	ramp = 0;
+      }
+    } else {
+      backoff->prediction = EEPROBE_PREDICTION_DENSE;
+      ramp = (now >= backoff->dense_until);
+    }
+  }
+
+  /* large transfer in flight: short sleeps so that the MPI library progresses it */
+  if ((backoff->progress_yield_time > 0) && (duration > backoff->progress_yield_time)) {
+    duration = backoff->progress_yield_time;
+  }
+
+  /* latency target: shorten the sleep so that it ends within the target with
+     the estimated overshoot, or busy-poll when even a short sleep cannot */
+  if (_EEPROBE_LATENCY_TARGET > 0) {
+    budget = EEPROBE_latencyBudget();
+    if (budget <= 0) {
+      /* decay the estimate so that a transient overshoot spike does not keep
+	 the wait busy-polling forever */
+      _EEPROBE_LATENCY_OVERSHOOT -= _EEPROBE_LATENCY_OVERSHOOT / 1024 + 1;
+      backoff->last_delay = 0;
+      return;
+    }
+    if (duration > budget) {
+      duration = budget;
+    }
+  }
+
+  /* run deferrable work instead of sleeping, the time it reports is deducted
+     from the yield time so that the schedule is unchanged */
+  if ((_EEPROBE_IDLE_CALLBACK != NULL) && (_EEPROBE_IDLE_CALLBACK_RUNNING == 0) &&
+      (duration >= _EEPROBE_IDLE_CALLBACK_THRESHOLD)) {
+    _EEPROBE_IDLE_CALLBACK_RUNNING = 1;
+    work_time = _EEPROBE_IDLE_CALLBACK(_EEPROBE_IDLE_CALLBACK_CTX,
+				       ((_EEPROBE_LATENCY_TARGET > 0) && (budget < _EEPROBE_IDLE_CALLBACK_BUDGET)) ?
+				       budget : _EEPROBE_IDLE_CALLBACK_BUDGET);
+    _EEPROBE_IDLE_CALLBACK_RUNNING = 0;
+    if (work_time > 0) {
+      _EEPROBE_TOTAL_IDLE_CALLBACK_TIME += work_time;
+    }
+  }
+
+  if ((work_time <= 0) || (work_time < duration)) {
+
+    if (work_time > 0) {
+      duration -= work_time;
+    }
+
+#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
+    start = EEPROBE_getTime();
+#endif
+
+    if ((_EEPROBE_LATENCY_TARGET > 0) || (_EEPROBE_WAKEUP_GRID > 0)) {
+      sleep_start = EEPROBE_getMonotonicTime();
+    }
+
+    if ((_EEPROBE_WAKEUP_GRID > 0) && (duration >= _EEPROBE_WAKEUP_THRESHOLD)) {
+      /* CLOCK_MONOTONIC is shared by the processes of a node, so aligned
+	 deadlines make idle ranks wake up in bursts */
+      duration = EEPROBE_alignDeadline(sleep_start, sleep_start + duration,
+				       (_EEPROBE_LATENCY_TARGET > 0) ? sleep_start + budget : 0)
+	- sleep_start;
+      EEPROBE_idleUntil(sleep_start + duration);
+    } else {
+      EEPROBE_idle(duration);
+    }
+
+    if (_EEPROBE_LATENCY_TARGET > 0) {
+      now = EEPROBE_getMonotonicTime();
+      EEPROBE_recordOvershoot((long) (now - sleep_start) - duration);
+      backoff->last_delay = now - sleep_start;
+    }
+
+#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
+    EEPROBE_updateTotalSleepTime(action, EEPROBE_getTime() - start);
+#endif
+
+  } else {
+    backoff->last_delay = 0;
+  }
+
+  if (work_time > 0) {
+    backoff->last_delay += work_time;
+  }
+
+  if (ramp) {
+    switch (params.policy) {
+    case EEPROBE_POLICY_EXPONENTIAL:
+      backoff->current_yield_time +=
+	(backoff->current_yield_time > params.inc_yield_time) ?
+	backoff->current_yield_time : params.inc_yield_time;
+      break;
+    case EEPROBE_POLICY_CONSTANT:
+      break;
+    default:
+      backoff->current_yield_time += params.inc_yield_time;
+      break;
+    }
+    if (backoff->current_yield_time > params.max_yield_time) {
+      backoff->current_yield_time = params.max_yield_time;
+    }
+  }
+
+}
+
+void
+EEPROBE_Backoff_reset(EEPROBE_Backoff * backoff) {
+  assert(backoff);
+  _EEPROBE_LAST_YIELD_TIME = backoff->current_yield_time;
+  backoff->current_yield_time = _EEPROBE_MIN_YIELD_TIME;
+  if ((_EEPROBE_LATENCY_TARGET > 0) && (backoff->last_delay > 0)) {
+    _EEPROBE_LATENCY_STATS[backoff->last_action].nb_wait++;
+    if (backoff->last_delay > _EEPROBE_LATENCY_TARGET) {
+      _EEPROBE_LATENCY_STATS[backoff->last_action].nb_violation++;
+    }
+    backoff->last_delay = 0;
+  }
+  if (backoff->nb_poll > 0) {
+    _EEPROBE_STATS.actions[backoff->last_action].nb_wait++;
+    backoff->nb_poll = 0;
+  }
+  _EEPROBE_STATS.current_yield_time = 0;
+  EEPROBE_publishStats();
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /* the channel table is set-associative: a channel is hashed to a set and
+     stored in one of its ways, the least recently used way being evicted */
+#define _EEPROBE_CHANNEL_NB_SET 64
+
+#define _EEPROBE_CHANNEL_NB_WAY 4
+
+  /* number of inter-arrival samples before predicting */
+#define _EEPROBE_PREDICTOR_MIN_SAMPLE 4
+
+  /**
+   * Per-channel state, a channel being an action on a (comm, source, tag)
+   * triplet, or on a communicator for collectives. The inter-arrival time is
+   * tracked with an EWMA (weight 1/8) and its mean deviation (weight 1/4). The
+   * yield time reached at the end of the waits is tracked with an EWMA (weight
+   * 1/2) for warm start. An entry with last_use == 0 is free.
+   */
+typedef struct {
+  unsigned long last_use;
+  MPI_Comm comm;
+  int source;
+  int tag;
+  EEPROBE_ACTION action;
+  unsigned int nb_sample;
+  unsigned long last_arrival;
+  unsigned long period;
+  unsigned long jitter;
+  long warm_yield_time;
+} EEPROBE_Channel;
+
+static EEPROBE_Channel _EEPROBE_CHANNELS[_EEPROBE_CHANNEL_NB_SET][_EEPROBE_CHANNEL_NB_WAY];
+
+static unsigned long _EEPROBE_CHANNEL_CLOCK = 0;
+
+  /**
+   * Returns the state of a channel, allocating it if needed, or NULL if no
+   * per-channel feature is enabled.
+   */
+static EEPROBE_Channel *
+EEPROBE_getChannel(EEPROBE_ACTION action, MPI_Comm comm, int source, int tag) {
+
+  uint64_t key = 0;
+
+  EEPROBE_Channel * set = NULL;
+
+  EEPROBE_Channel * channel = NULL;
+
+  int way = 0;
+
+  if ((_EEPROBE_PREDICTOR != EEPROBE_ENABLE) && (_EEPROBE_WARM_START != EEPROBE_ENABLE)) {
+    return NULL;
+  }
+
+  /* MPI_Comm is an integer or a pointer depending on the implementation */
+  memcpy(&key, &comm, (sizeof(comm) < sizeof(key)) ? sizeof(comm) : sizeof(key));
+
+  key ^= ((uint64_t) action << 56) ^ ((uint64_t) (unsigned int) source << 24) ^ (uint64_t) (unsigned int) tag;
+  key *= 0x9E3779B97F4A7C15ULL;
+
+  set = _EEPROBE_CHANNELS[(key >> 32) % _EEPROBE_CHANNEL_NB_SET];
+
+  _EEPROBE_CHANNEL_CLOCK++;
+
+  channel = &(set[0]);
+
+  for (way = 0; way < _EEPROBE_CHANNEL_NB_WAY; way++) {
+    if ((set[way].last_use != 0) && (set[way].action == action) && (set[way].comm == comm) &&
+	(set[way].source == source) && (set[way].tag == tag)) {
+      set[way].last_use = _EEPROBE_CHANNEL_CLOCK;
+      return &(set[way]);
+    }
+    if (set[way].last_use < channel->last_use) {
+      channel = &(set[way]);
+    }
+  }
+
+  channel->last_use = _EEPROBE_CHANNEL_CLOCK;
+  channel->comm = comm;
+  channel->source = source;
+  channel->tag = tag;
+  channel->action = action;
+  channel->nb_sample = 0;
+  channel->last_arrival = 0;
+  channel->period = 0;
+  channel->jitter = 0;
+  channel->warm_yield_time = -1;
+
+  return channel;
+
+}
+
+static void
+EEPROBE_predict(EEPROBE_Backoff * backoff, const EEPROBE_Channel * channel) {
+
+  unsigned long now = 0;
+
+  unsigned long predicted = 0;
+
+  unsigned long guard = 0;
+
+  if ((_EEPROBE_PREDICTOR != EEPROBE_ENABLE) || (channel == NULL) ||
+      (channel->nb_sample < _EEPROBE_PREDICTOR_MIN_SAMPLE) ||
+      (channel->period == 0) || (4 * channel->jitter > channel->period)) {
+    return;
+  }
+
+  now = EEPROBE_getMonotonicTime();
+
+  guard = 2 * channel->jitter;
+  if (guard < _EEPROBE_PREDICTOR_GUARD_TIME) {
+    guard = _EEPROBE_PREDICTOR_GUARD_TIME;
+  }
+
+  /* skip the periods already elapsed */
+  predicted = channel->last_arrival + channel->period;
+  if (predicted + guard < now) {
+    predicted += ((now - predicted) / channel->period + 1) * channel->period;
+  }
+
+  backoff->dense_until = predicted + guard;
+
+  if (predicted > now + guard) {
+    backoff->prediction = EEPROBE_PREDICTION_PENDING;
+    backoff->wake_time = predicted - guard;
+  } else {
+    backoff->prediction = EEPROBE_PREDICTION_DENSE;
+    backoff->wake_time = 0;
+  }
+
+  _EEPROBE_PREDICTOR_STATS.nb_prediction++;
+
+}
+
+static void
+EEPROBE_recordArrival(const EEPROBE_Backoff * backoff, EEPROBE_Channel * channel) {
+
+  unsigned long now = 0;
+
+  unsigned long gap = 0;
+
+  unsigned long deviation = 0;
+
+  if ((_EEPROBE_PREDICTOR != EEPROBE_ENABLE) || (channel == NULL)) {
+    return;
+  }
+
+  now = EEPROBE_getMonotonicTime();
+
+  switch (backoff->prediction) {
+  case EEPROBE_PREDICTION_PENDING:
+  case EEPROBE_PREDICTION_AWAKE:
+    /* arrived before the end of the long sleep */
+    _EEPROBE_PREDICTOR_STATS.nb_miss_early++;
+    break;
+  case EEPROBE_PREDICTION_DENSE:
+    if (now <= backoff->dense_until) {
+      _EEPROBE_PREDICTOR_STATS.nb_hit++;
+    } else {
+      _EEPROBE_PREDICTOR_STATS.nb_miss_late++;
+    }
+    break;
+  default:
+    break;
+  }
+
+  if ((channel->last_arrival != 0) && (now > channel->last_arrival)) {
+
+    gap = now - channel->last_arrival;
+
+    if (channel->nb_sample == 0) {
+      channel->period = gap;
+      channel->jitter = gap / 2;
+    } else {
+      deviation = (gap > channel->period) ? gap - channel->period : channel->period - gap;
+      channel->period = channel->period - channel->period / 8 + gap / 8;
+      channel->jitter = channel->jitter - channel->jitter / 4 + deviation / 4;
+    }
+
+    channel->nb_sample++;
+
+  }
+
+  channel->last_arrival = now;
+
+}
+
+  /**
+   * Start from half of the yield time the previous waits on the channel
+   * converged to. Halving lets the start point decrease when waits get shorter.
+   */
+static void
+EEPROBE_warmStart(EEPROBE_Backoff * backoff, const EEPROBE_Channel * channel) {
+
+  if ((_EEPROBE_WARM_START != EEPROBE_ENABLE) || (channel == NULL) ||
+      (channel->warm_yield_time < 0)) {
+    return;
+  }
+
+  backoff->current_yield_time = channel->warm_yield_time / 2;
+  if (backoff->current_yield_time < _EEPROBE_MIN_YIELD_TIME) {
+    backoff->current_yield_time = _EEPROBE_MIN_YIELD_TIME;
+  }
+  if (backoff->current_yield_time > _EEPROBE_MAX_YIELD_TIME) {
+    backoff->current_yield_time = _EEPROBE_MAX_YIELD_TIME;
+  }
+
+}
+
+static void
+EEPROBE_recordWarmStart(const EEPROBE_Backoff * backoff, EEPROBE_Channel * channel) {
+
+  if ((_EEPROBE_WARM_START != EEPROBE_ENABLE) || (channel == NULL)) {
+    return;
+  }
+
+  if (channel->warm_yield_time < 0) {
+    channel->warm_yield_time = backoff->current_yield_time;
+  } else {
+    channel->warm_yield_time = (channel->warm_yield_time + backoff->current_yield_time) / 2;
+  }
+
+}
+
+  /**
+   * Apply the per-channel state at the beginning of a wait.
+   */
+static void
+EEPROBE_startChannel(EEPROBE_Backoff * backoff, const EEPROBE_Channel * channel) {
+  EEPROBE_warmStart(backoff, channel);
+  EEPROBE_predict(backoff, channel);
+}
+
+  /**
+   * Update the per-channel state at the end of a wait, before the backoff reset.
+   */
+static void
+EEPROBE_endChannel(const EEPROBE_Backoff * backoff, EEPROBE_Channel * channel) {
+  EEPROBE_recordWarmStart(backoff, channel);
+  EEPROBE_recordArrival(backoff, channel);
+}
+
+void
+EEPROBE_setWarmStart(EEPROBE_Enable enable) {
+  EEPROBE_readEnvironment();
+  _EEPROBE_WARM_START = enable;
+}
+
+EEPROBE_Enable
+EEPROBE_getWarmStart() {
+  return _EEPROBE_WARM_START;
+}
+
+void
+EEPROBE_setPredictor(EEPROBE_Enable enable) {
+  EEPROBE_readEnvironment();
+  _EEPROBE_PREDICTOR = enable;
+}
+
+EEPROBE_Enable
+EEPROBE_getPredictor() {
+  return _EEPROBE_PREDICTOR;
+}
+
+void
+EEPROBE_setPredictorGuardTime(long guard_time) {
+  assert(guard_time >= 0);
+  assert(guard_time < 1000000000);
+  _EEPROBE_PREDICTOR_GUARD_TIME = guard_time;
+}
+
+long
+EEPROBE_getPredictorGuardTime() {
+  return _EEPROBE_PREDICTOR_GUARD_TIME;
+}
+
+void
+EEPROBE_getPredictorStats(EEPROBE_PredictorStats * stats) {
+  assert(stats);
+  *stats = _EEPROBE_PREDICTOR_STATS;
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /* call site of an EEPROBE_AUTO wait, taken in the _Switch functions */
+#if defined(__GNUC__)
+#define EEPROBE_RETURN_ADDRESS() __builtin_return_address(0)
+#else
+#define EEPROBE_RETURN_ADDRESS() NULL
+#endif
+
+#define _EEPROBE_SITE_TABLE_SIZE 256
+
+  /* histogram buckets are powers of two of the wait duration in nanoseconds */
+#define _EEPROBE_SITE_NB_BUCKET 32
+
+  /* the histogram is halved when its total reaches this count */
+#define _EEPROBE_SITE_DECAY_COUNT 64
+
+#define _EEPROBE_SITE_MIN_SAMPLE 16
+
+  /* past the first samples, one wait in this many is timed and recorded, the
+     others only look up the mode of their site */
+#define _EEPROBE_SITE_SAMPLE_PERIOD 8
+
+  /* hysteresis band, in percent of long waits */
+#define _EEPROBE_SITE_SLEEP_PERCENT 60
+
+#define _EEPROBE_SITE_SPIN_PERCENT 40
+
+  /**
+   * EEPROBE_AUTO state of a call site. An entry with key == 0 is free. Sites
+   * are code locations, so the table is not evicted and a full table makes new
+   * sites use the micro-sleep.
+   */
+typedef struct {
+  uintptr_t key;
+  EEPROBE_ACTION action;
+  EEPROBE_Enable mode;
+  unsigned int nb_call;
+  unsigned int nb_sample;
+  unsigned int nb_switch;
+  unsigned int nb_long;
+  unsigned int total;
+  unsigned long start;
+  unsigned short histogram[_EEPROBE_SITE_NB_BUCKET];
+} EEPROBE_Site;
+
+static EEPROBE_Site _EEPROBE_SITES[_EEPROBE_SITE_TABLE_SIZE];
+
+static int
+EEPROBE_log2(unsigned long value) {
+
+  int log = 0;
+
+  while ((value >>= 1) != 0) {
+    log++;
+  }
+
+  return log;
+
+}
+
+  /**
+   * Resolve EEPROBE_AUTO at the beginning of a wait. Returns the site to update
+   * at the end of the wait, or NULL when enable is not EEPROBE_AUTO. Only the
+   * sampled waits are timed: the clock reads and the histogram would otherwise
+   * cost more than a wait that is already complete.
+   */
+static EEPROBE_Site *
+EEPROBE_beginSite(EEPROBE_Enable * enable, EEPROBE_ACTION action, const void * address) {
+
+  uintptr_t key = (uintptr_t) address;
+
+  EEPROBE_Site * site = NULL;
+
+  unsigned int i = 0;
+
+  unsigned int slot = 0;
+
+  if (*enable != EEPROBE_AUTO) {
+    return NULL;
+  }
+
+  if (_EEPROBE_NEXT_CALL_SITE != 0) {
+    key = _EEPROBE_NEXT_CALL_SITE;
+    _EEPROBE_NEXT_CALL_SITE = 0;
+  }
+
+  /* linear probing */
+  slot = (unsigned int) (((uint64_t) key * 0x9E3779B97F4A7C15ULL) >> 32);
+  for (i = 0; i < _EEPROBE_SITE_TABLE_SIZE; i++) {
+    site = &(_EEPROBE_SITES[(slot + i) % _EEPROBE_SITE_TABLE_SIZE]);
+    if ((site->key == key) && (site->action == action)) {
+      break;
+    }
+    if (site->key == 0) {
+      memset(site, 0, sizeof(EEPROBE_Site));
+      site->key = key;
+      site->action = action;
+      site->mode = EEPROBE_ENABLE;
+      break;
+    }
+    site = NULL;
+  }
+
+  if (site == NULL) {
+    *enable = EEPROBE_ENABLE;
+    return NULL;
+  }
+
+  *enable = site->mode;
+
+  /* a start of 0 marks a wait that is not sampled */
+  site->nb_call++;
+  if ((site->nb_sample >= _EEPROBE_SITE_MIN_SAMPLE) &&
+      ((site->nb_call % _EEPROBE_SITE_SAMPLE_PERIOD) != 0)) {
+    site->start = 0;
+  } else {
+    site->start = EEPROBE_getMonotonicTime();
+  }
+
+  return site;
+
+}
+
+  /**
+   * Record the duration of the wait and update the mode of the site.
+   */
+static void
+EEPROBE_endSite(EEPROBE_Site * site) {
+
+  unsigned long duration = 0;
+
+  int bucket = 0;
+
+  int i = 0;
+
+  if ((site == NULL) || (site->start == 0)) {
+    return;
+  }
+
+  duration = EEPROBE_getMonotonicTime() - site->start;
+
+  bucket = EEPROBE_log2(duration);
+  if (bucket >= _EEPROBE_SITE_NB_BUCKET) {
+    bucket = _EEPROBE_SITE_NB_BUCKET - 1;
+  }
+
+  site->histogram[bucket]++;
+  site->total++;
+  site->nb_sample++;
+
+  if (site->total >= _EEPROBE_SITE_DECAY_COUNT) {
+    site->total = 0;
+    for (i = 0; i < _EEPROBE_SITE_NB_BUCKET; i++) {
+      site->histogram[i] /= 2;
+      site->total += site->histogram[i];
+    }
+  }
+
+  /* the bucket holding the threshold counts as long */
+  site->nb_long = 0;
+  for (i = EEPROBE_log2(_EEPROBE_AUTO_THRESHOLD); i < _EEPROBE_SITE_NB_BUCKET; i++) {
+    site->nb_long += site->histogram[i];
+  }
+
+  if ((site->nb_sample < _EEPROBE_SITE_MIN_SAMPLE) || (site->total == 0)) {
+    return;
+  }
+
+  if ((site->mode == EEPROBE_DISABLE) &&
+      (100 * site->nb_long >= _EEPROBE_SITE_SLEEP_PERCENT * site->total)) {
+    site->mode = EEPROBE_ENABLE;
+    site->nb_switch++;
+  } else if ((site->mode == EEPROBE_ENABLE) &&
+	     (100 * site->nb_long <= _EEPROBE_SITE_SPIN_PERCENT * site->total)) {
+    site->mode = EEPROBE_DISABLE;
+    site->nb_switch++;
+  }
+
+}
+
+void
+EEPROBE_setAutoThreshold(long threshold) {
+  assert(threshold >= 0);
+  assert(threshold < 1000000000);
+  _EEPROBE_AUTO_THRESHOLD = threshold;
+}
+
+long
+EEPROBE_getAutoThreshold() {
+  return _EEPROBE_AUTO_THRESHOLD;
+}
+
+void
+EEPROBE_setCallSite(unsigned long id) {
+  assert(id != 0);
+  _EEPROBE_NEXT_CALL_SITE = id;
+}
+
+void
+EEPROBE_printCallSites() {
+
+  int i = 0;
+
+  const EEPROBE_Site * site = NULL;
+
+  for (i = 0; i < _EEPROBE_SITE_TABLE_SIZE; i++) {
+    site = &(_EEPROBE_SITES[i]);
+    if (site->key != 0) {
+      fprintf(stdout, "EEProbe site %#lx action %s samples %u long %u%% mode %s switches %u\n",
+	      (unsigned long) site->key, _EEPROBE_ACTION_NAMES[site->action], site->nb_sample,
+	      (site->total > 0) ? (100 * site->nb_long / site->total) : 0,
+	      (site->mode == EEPROBE_ENABLE) ? "sleep" : "spin", site->nb_switch);
+    }
+  }
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Doorbell of a receiver, in a window shared by the processes of a node. The
+   * sequence number is increased by each ring, and is the futex word. Each
+   * doorbell uses its own cache line.
+   */
+typedef struct {
+  unsigned int seq;
+  unsigned int nb_waiter;
+  char padding[56];
+} EEPROBE_Doorbell;
+
+  /* communicator given to EEPROBE_Doorbell_init, doorbells are only used for
+     point-to-point operations on this communicator */
+static MPI_Comm _EEPROBE_DOORBELL_COMM = MPI_COMM_NULL;
+
+static MPI_Comm _EEPROBE_DOORBELL_NODE_COMM = MPI_COMM_NULL;
+
+static MPI_Win _EEPROBE_DOORBELL_WIN = MPI_WIN_NULL;
+
+  /* doorbell of each process of the node, by node rank */
+static EEPROBE_Doorbell ** _EEPROBE_DOORBELLS = NULL;
+
+  /* node rank of each process of the communicator, MPI_UNDEFINED off node */
+static int * _EEPROBE_DOORBELL_NODE_RANKS = NULL;
+
+static int _EEPROBE_DOORBELL_COMM_SIZE = 0;
+
+static EEPROBE_Doorbell * _EEPROBE_DOORBELL_SELF = NULL;
+
+  /* all the processes of the communicator are on this node, so that
+     MPI_ANY_SOURCE waits can use the doorbell */
+static int _EEPROBE_DOORBELL_ALL_LOCAL = 0;
+
+static long _EEPROBE_DOORBELL_TIMEOUT = 0;
+
+static EEPROBE_DoorbellStats _EEPROBE_DOORBELL_STATS;
+
+int
+EEPROBE_Doorbell_init(MPI_Comm comm, long timeout) {
+
+  MPI_Group group;
+
+  MPI_Group node_group;
+
+  MPI_Aint size = 0;
+
+  int disp_unit = 0;
+
+  int node_size = 0;
+
+  int * ranks = NULL;
+
+  int i = 0;
+
+  int errno = MPI_SUCCESS;
+
+  assert(_EEPROBE_DOORBELLS == NULL);
+  assert((timeout > 0) && (timeout < 1000000000));
+
+  errno = MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL,
+			      &_EEPROBE_DOORBELL_NODE_COMM);
+  if (errno != MPI_SUCCESS) {
+    return errno;
+  }
+
+  errno = MPI_Win_allocate_shared(sizeof(EEPROBE_Doorbell), sizeof(EEPROBE_Doorbell),
+				  MPI_INFO_NULL, _EEPROBE_DOORBELL_NODE_COMM,
+				  &_EEPROBE_DOORBELL_SELF, &_EEPROBE_DOORBELL_WIN);
+  if (errno != MPI_SUCCESS) {
+    MPI_Comm_free(&_EEPROBE_DOORBELL_NODE_COMM);
+    return errno;
+  }
+
+  _EEPROBE_DOORBELL_SELF->seq = 0;
+  _EEPROBE_DOORBELL_SELF->nb_waiter = 0;
+
+  MPI_Comm_size(_EEPROBE_DOORBELL_NODE_COMM, &node_size);
+  _EEPROBE_DOORBELLS = malloc(node_size * sizeof(EEPROBE_Doorbell *));
+  assert(_EEPROBE_DOORBELLS);
+  for (i = 0; i < node_size; i++) {
+    MPI_Win_shared_query(_EEPROBE_DOORBELL_WIN, i, &size, &disp_unit,
+			 &(_EEPROBE_DOORBELLS[i]));
+  }
+
+  MPI_Comm_size(comm, &_EEPROBE_DOORBELL_COMM_SIZE);
+  ranks = malloc(_EEPROBE_DOORBELL_COMM_SIZE * sizeof(int));
+  _EEPROBE_DOORBELL_NODE_RANKS = malloc(_EEPROBE_DOORBELL_COMM_SIZE * sizeof(int));
+  assert(ranks && _EEPROBE_DOORBELL_NODE_RANKS);
+  for (i = 0; i < _EEPROBE_DOORBELL_COMM_SIZE; i++) {
+    ranks[i] = i;
+  }
+  MPI_Comm_group(comm, &group);
+  MPI_Comm_group(_EEPROBE_DOORBELL_NODE_COMM, &node_group);
+  MPI_Group_translate_ranks(group, _EEPROBE_DOORBELL_COMM_SIZE, ranks,
+			    node_group, _EEPROBE_DOORBELL_NODE_RANKS);
+  MPI_Group_free(&group);
+  MPI_Group_free(&node_group);
+  free(ranks);
+
+  _EEPROBE_DOORBELL_ALL_LOCAL = (node_size == _EEPROBE_DOORBELL_COMM_SIZE);
+  _EEPROBE_DOORBELL_TIMEOUT = timeout;
+  _EEPROBE_DOORBELL_COMM = comm;
+  memset(&_EEPROBE_DOORBELL_STATS, 0, sizeof(EEPROBE_DoorbellStats));
+
+  /* no ring before every doorbell is initialized */
+  return MPI_Barrier(_EEPROBE_DOORBELL_NODE_COMM);
+
+}
+
+int
+EEPROBE_Doorbell_free() {
+
+  int errno = MPI_SUCCESS;
+
+  if (_EEPROBE_DOORBELLS == NULL) {
+    return MPI_SUCCESS;
+  }
+
+  _EEPROBE_DOORBELL_COMM = MPI_COMM_NULL;
+
+  errno = MPI_Win_free(&_EEPROBE_DOORBELL_WIN);
+  MPI_Comm_free(&_EEPROBE_DOORBELL_NODE_COMM);
+
+  free(_EEPROBE_DOORBELLS);
+  free(_EEPROBE_DOORBELL_NODE_RANKS);
+  _EEPROBE_DOORBELLS = NULL;
+  _EEPROBE_DOORBELL_NODE_RANKS = NULL;
+  _EEPROBE_DOORBELL_SELF = NULL;
+
+  return errno;
+
+}
+
+void
+EEPROBE_getDoorbellStats(EEPROBE_DoorbellStats * stats) {
+  assert(stats);
+  *stats = _EEPROBE_DOORBELL_STATS;
+}
+
+  /**
+   * Returns the node rank of a process of the doorbell communicator, or
+   * MPI_UNDEFINED when doorbells are not used for it.
+   */
+static int
+EEPROBE_getDoorbellRank(int rank, MPI_Comm comm) {
+
+  if ((_EEPROBE_DOORBELLS == NULL) || (comm != _EEPROBE_DOORBELL_COMM) ||
+      (rank < 0) || (rank >= _EEPROBE_DOORBELL_COMM_SIZE)) {
+    return MPI_UNDEFINED;
+  }
+
+  return _EEPROBE_DOORBELL_NODE_RANKS[rank];
+
+}
+
+  /**
+   * Returns the doorbell of the calling process when messages from source are
+   * announced by a ring, NULL otherwise.
+   */
+static EEPROBE_Doorbell *
+EEPROBE_getDoorbell(int source, MPI_Comm comm) {
+
+  if ((source == MPI_ANY_SOURCE) && (_EEPROBE_DOORBELLS != NULL) &&
+      (comm == _EEPROBE_DOORBELL_COMM)) {
+    return _EEPROBE_DOORBELL_ALL_LOCAL ? _EEPROBE_DOORBELL_SELF : NULL;
+  }
+
+  return (EEPROBE_getDoorbellRank(source, comm) != MPI_UNDEFINED) ?
+    _EEPROBE_DOORBELL_SELF : NULL;
+
+}
+
+  /**
+   * Ring the doorbell of a destination after its message was posted. The futex
+   * is only woken when the destination is waiting.
+   */
+static void
+EEPROBE_ringDoorbell(int dest, MPI_Comm comm) {
+
+  EEPROBE_Doorbell * doorbell = NULL;
+
+  int node_rank = EEPROBE_getDoorbellRank(dest, comm);
+
+  if (node_rank == MPI_UNDEFINED) {
+    return;
+  }
+
+  doorbell = _EEPROBE_DOORBELLS[node_rank];
+
+  __atomic_add_fetch(&(doorbell->seq), 1, __ATOMIC_SEQ_CST);
+  _EEPROBE_DOORBELL_STATS.nb_ring++;
+
+  if (__atomic_load_n(&(doorbell->nb_waiter), __ATOMIC_SEQ_CST) > 0) {
+    syscall(SYS_futex, &(doorbell->seq), FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    _EEPROBE_DOORBELL_STATS.nb_wake++;
+  }
+
+}
+
+static unsigned int
+EEPROBE_loadDoorbell(EEPROBE_Doorbell * doorbell) {
+  return __atomic_load_n(&(doorbell->seq), __ATOMIC_SEQ_CST);
+}
+
+  /**
+   * Block until the doorbell is rung after seq was read, or until the timeout.
+   * The waiter is registered before the futex compares the sequence number, so
+   * a ring between the poll and the wait is not lost.
+   */
+static void
+EEPROBE_waitDoorbell(EEPROBE_Doorbell * doorbell, unsigned int seq, EEPROBE_Backoff * backoff,
+		     EEPROBE_ACTION action) {
+
+  struct timespec timeout;
+
+  unsigned long start = EEPROBE_getMonotonicTime();
+
+#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
+  unsigned long start_us = EEPROBE_getTime();
+#endif
+
+  timeout.tv_sec = 0;
+  timeout.tv_nsec = _EEPROBE_DOORBELL_TIMEOUT;
+
+  EEPROBE_countPoll(backoff, action);
+  EEPROBE_publishStats();
+
+  __atomic_add_fetch(&(doorbell->nb_waiter), 1, __ATOMIC_SEQ_CST);
+  syscall(SYS_futex, &(doorbell->seq), FUTEX_WAIT, seq, &timeout, NULL, 0);
+  __atomic_sub_fetch(&(doorbell->nb_waiter), 1, __ATOMIC_SEQ_CST);
+
+  _EEPROBE_DOORBELL_STATS.nb_wait++;
+  if (EEPROBE_getMonotonicTime() - start >= (unsigned long) _EEPROBE_DOORBELL_TIMEOUT) {
+    _EEPROBE_DOORBELL_STATS.nb_timeout++;
+  }
+
+#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
+  EEPROBE_updateTotalSleepTime(action, EEPROBE_getTime() - start_us);
+#endif
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Probe(int source, int tag, MPI_Comm comm, MPI_Status * status) {
+  return EEPROBE_Probe_Switch(source, tag, comm, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_Probe_Switch(int source, int tag, MPI_Comm comm, MPI_Status * status,
+		     EEPROBE_Enable enable) {
+
+  int flag = 0;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Backoff backoff;
+
+  EEPROBE_Channel * channel = NULL;
+
+  EEPROBE_Doorbell * doorbell = NULL;
+
+  unsigned int seq = 0;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_PROBE, EEPROBE_RETURN_ADDRESS());
+
+  if (enable == EEPROBE_ENABLE) {
+
+    EEPROBE_Backoff_init(&backoff);
+
+    channel = EEPROBE_getChannel(EEPROBE_PROBE, comm, source, tag);
+    EEPROBE_startChannel(&backoff, channel);
+
+    doorbell = EEPROBE_getDoorbell(source, comm);
+
+    while ((flag == 0) && (errno == MPI_SUCCESS)) {
+
+      if (doorbell != NULL) {
+	seq = EEPROBE_loadDoorbell(doorbell);
+      }
+
+      errno = MPI_Iprobe(source, tag, comm, &flag, status);
+
+      /* the first poll after a ring may only progress the message into the
+	 MPI library */
+      if ((flag == 0) && (doorbell != NULL) && (errno == MPI_SUCCESS)) {
+	errno = MPI_Iprobe(source, tag, comm, &flag, status);
+      }
+
+      if ((flag == 0) && (doorbell != NULL)) {
+	EEPROBE_waitDoorbell(doorbell, seq, &backoff, EEPROBE_PROBE);
+      } else if (flag == 0) {
+	EEPROBE_Backoff_yield(&backoff, EEPROBE_PROBE);
+      }
+
+    }
+
+    EEPROBE_endChannel(&backoff, channel);
+    EEPROBE_Backoff_reset(&backoff);
+
+  } else {
+
+    errno = MPI_Probe(source, tag, comm, status);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+  
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Decayed hit counts are kept in fixed point: each hit adds
+   * _EEPROBE_PATTERN_HIT_WEIGHT and all counts lose 1/2^_EEPROBE_PATTERN_HIT_DECAY.
+   */
+#define _EEPROBE_PATTERN_HIT_WEIGHT 1024
+
+#define _EEPROBE_PATTERN_HIT_DECAY 3
+
+  /**
+   * Pattern counts up to this size keep their polling order on the stack. The
+   * order is per call, since an idle callback may run a nested Probe_any.
+   */
+#define _EEPROBE_PATTERN_ORDER_STACK 32
+
+int
+EEPROBE_Probe_any(const EEPROBE_Pattern * patterns, int n, int * index, MPI_Status * status) {
+  return EEPROBE_Probe_any_Switch(patterns, n, NULL, index, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_Probe_any_Switch(const EEPROBE_Pattern * patterns, int n, unsigned long * hits,
+			 int * index, MPI_Status * status, EEPROBE_Enable enable) {
+
+  int flag = 0;
+
+  int errno = MPI_SUCCESS;
+
+  int i = 0;
+
+  int j = 0;
+
+  int k = 0;
+
+  int stack_order[_EEPROBE_PATTERN_ORDER_STACK];
+
+  int * order = stack_order;
+
+  EEPROBE_Backoff backoff;
+
+  EEPROBE_Site * site = NULL;
+
+  assert(patterns);
+  assert(n > 0);
+  assert(index);
+
+  if (n > _EEPROBE_PATTERN_ORDER_STACK) {
+    order = malloc(sizeof(int) * n);
+    assert(order);
+  }
+
+  /* insertion sort by decreasing hit count, stable for equal counts */
+  for (i = 0; i < n; i++) {
+    k = i;
+    if (hits != NULL) {
+      for (j = i; (j > 0) && (hits[order[j - 1]] < hits[i]); j--) {
+	order[j] = order[j - 1];
+      }
+      k = j;
+    }
+    order[k] = i;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_PROBE, EEPROBE_RETURN_ADDRESS());
+
+  if (enable == EEPROBE_ENABLE) {
+    EEPROBE_Backoff_init(&backoff);
+  }
+
+  while ((flag == 0) && (errno == MPI_SUCCESS)) {
+
+    for (i = 0; (i < n) && (flag == 0) && (errno == MPI_SUCCESS); i++) {
+      *index = order[i];
+      errno = MPI_Iprobe(patterns[*index].source, patterns[*index].tag,
+			 patterns[*index].comm, &flag, status);
+    }
+
+    if ((flag == 0) && (enable == EEPROBE_ENABLE)) {
+      EEPROBE_Backoff_yield(&backoff, EEPROBE_PROBE);
+    }
+
+  }
+
+  if (enable == EEPROBE_ENABLE) {
+    EEPROBE_Backoff_reset(&backoff);
+  }
+
+  EEPROBE_endSite(site);
+
+  if ((flag != 0) && (hits != NULL)) {
+    for (i = 0; i < n; i++) {
+      hits[i] -= hits[i] >> _EEPROBE_PATTERN_HIT_DECAY;
+    }
+    hits[*index] += _EEPROBE_PATTERN_HIT_WEIGHT;
+  }
+
+  if (order != stack_order) {
+    free(order);
+  }
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+  /**
+   * Returns count elements of datatype in bytes, or 0 when the progress
+   * schedule is disabled.
+   */
+static long
+EEPROBE_getBytes(int count, MPI_Datatype datatype) {
+
+  int size = 0;
+
+  if (_EEPROBE_PROGRESS_THRESHOLD == 0) {
+    return 0;
+  }
+
+  MPI_Type_size(datatype, &size);
+
+  return (long) count * size;
+
+}
+
+  /**
+   * Returns the number of peers of a collective on comm, the size of the
+   * remote group on an intercommunicator, or 0 when the progress schedule is
+   * disabled.
+   */
+static int
+EEPROBE_getTaskNr(MPI_Comm comm) {
+
+  int nr = 0;
+
+  int inter = 0;
+
+  if (_EEPROBE_PROGRESS_THRESHOLD == 0) {
+    return 0;
+  }
+
+  MPI_Comm_test_inter(comm, &inter);
+
+  if (inter) {
+    MPI_Comm_remote_size(comm, &nr);
+  } else {
+    MPI_Comm_size(comm, &nr);
+  }
+
+  return nr;
+
+}
+
+  /**
+   * Returns whether the calling process is the root of a rooted collective:
+   * the process passing MPI_ROOT on an intercommunicator. Returns 0 when the
+   * progress schedule is disabled.
+   */
+static int
+EEPROBE_isRoot(int root, MPI_Comm comm) {
+
+  int rank = 0;
+
+  int inter = 0;
+
+  if (_EEPROBE_PROGRESS_THRESHOLD == 0) {
+    return 0;
+  }
+
+  if ((root == MPI_ROOT) || (root == MPI_PROC_NULL)) {
+    return (root == MPI_ROOT);
+  }
+
+  MPI_Comm_test_inter(comm, &inter);
+
+  if (inter) {
+    return 0;
+  }
+
+  MPI_Comm_rank(comm, &rank);
+
+  return (rank == root);
+
+}
+
+  /**
+   * Returns the sum of the counts of the peers of comm in bytes, or 0 when the
+   * progress schedule is disabled.
+   */
+static long
+EEPROBE_getSumBytes(const int counts[], MPI_Datatype datatype, MPI_Comm comm) {
+
+  long count = 0;
+
+  int nr = 0;
+
+  int i = 0;
+
+  if (_EEPROBE_PROGRESS_THRESHOLD == 0) {
+    return 0;
+  }
+
+  nr = EEPROBE_getTaskNr(comm);
+
+  for (i = 0; i < nr; i++) {
+    count += counts[i];
+  }
+
+  return count * EEPROBE_getBytes(1, datatype);
+
+}
+
+static long
+EEPROBE_getSumBytesW(const int counts[], const MPI_Datatype datatypes[], MPI_Comm comm) {
+
+  long bytes = 0;
+
+  int nr = 0;
+
+  int i = 0;
+
+  if (_EEPROBE_PROGRESS_THRESHOLD == 0) {
+    return 0;
+  }
+
+  nr = EEPROBE_getTaskNr(comm);
+
+  for (i = 0; i < nr; i++) {
+    bytes += EEPROBE_getBytes(counts[i], datatypes[i]);
+  }
+
+  return bytes;
+
+}
+
+static int
+EEPROBE_isLarge(long bytes) {
+  return ((_EEPROBE_PROGRESS_THRESHOLD > 0) && (bytes >= _EEPROBE_PROGRESS_THRESHOLD));
+}
+
+  /**
+   * Wait for a request with the micro-sleep mechanism. The channel (comm,
+   * source, tag) identifies the traffic for the predictor, MPI_ANY_SOURCE and
+   * MPI_ANY_TAG being used when not known. Operations moving at least the
+   * progress threshold in bytes use the progress schedule for the whole wait,
+   * including the time spent waiting for the peer, as the request does not
+   * tell when the transfer starts.
+   */
+static int
+EEPROBE_Wait_Core(MPI_Request *request, MPI_Status *status,
+		  EEPROBE_Enable enable, EEPROBE_ACTION action,
+		  MPI_Comm comm, int source, int tag, long bytes) {
+
+  int flag = 0;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Backoff backoff;
+
+  EEPROBE_Channel * channel = NULL;
+
+  if (enable == EEPROBE_ENABLE) {
+
+    EEPROBE_Backoff_init(&backoff);
+
+    if (EEPROBE_isLarge(bytes)) {
+      backoff.progress_yield_time = _EEPROBE_PROGRESS_YIELD_TIME;
+    }
+
+    channel = EEPROBE_getChannel(action, comm, source, tag);
+    EEPROBE_startChannel(&backoff, channel);
+
+    while ((flag == 0) && (errno == MPI_SUCCESS)) {
+
+      errno = MPI_Test(request, &flag, status);
+
+      if (flag == 0) {
+	EEPROBE_Backoff_yield(&backoff, action);
+      }
+
+    }
+
+    EEPROBE_endChannel(&backoff, channel);
+    EEPROBE_Backoff_reset(&backoff);
+
+  } else {
+
+    errno = MPI_Wait(request, status);
+
+  }
+
+  return errno;
+  
+}
+
+int
+EEPROBE_Wait(MPI_Request *request, MPI_Status *status) {
+  return EEPROBE_Wait_Core(request, status, EEPROBE_ENABLE, EEPROBE_WAIT,
+			   MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG, 0);
+}
+
+
+int
+EEPROBE_Wait_Switch(MPI_Request *request, MPI_Status *status, EEPROBE_Enable enable) {
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_WAIT, EEPROBE_RETURN_ADDRESS());
+
+  errno = EEPROBE_Wait_Core(request, status, enable, EEPROBE_WAIT,
+			    MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG, 0);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+  /**
+   * Receive a large message in two phases: wait for its envelope with the usual
+   * schedule, as no data moves before the sender starts, then receive it with
+   * the progress schedule while the data moves. Messages announced by a
+   * doorbell also take this path, so that the doorbell is only waited for
+   * before the envelope arrives.
+   */
+static int
+EEPROBE_Recv_Large(void *buf, int count, MPI_Datatype datatype,
+		   int source, int tag, MPI_Comm comm, MPI_Status *status,
+		   EEPROBE_Doorbell * doorbell) {
+
+  MPI_Message message;
+
+  MPI_Request request;
+
+  int flag = 0;
+
+  int errno = MPI_SUCCESS;
+
+  unsigned int seq = 0;
+
+  EEPROBE_Backoff backoff;
+
+  EEPROBE_Channel * channel = NULL;
+
+  EEPROBE_Backoff_init(&backoff);
+
+  channel = EEPROBE_getChannel(EEPROBE_RECV, comm, source, tag);
+  EEPROBE_startChannel(&backoff, channel);
+
+  while ((flag == 0) && (errno == MPI_SUCCESS)) {
+
+    if (doorbell != NULL) {
+      seq = EEPROBE_loadDoorbell(doorbell);
+    }
+
+    errno = MPI_Improbe(source, tag, comm, &flag, &message, MPI_STATUS_IGNORE);
+
+    /* the first poll after a ring may only progress the message into the MPI
+       library */
+    if ((flag == 0) && (doorbell != NULL) && (errno == MPI_SUCCESS)) {
+      errno = MPI_Improbe(source, tag, comm, &flag, &message, MPI_STATUS_IGNORE);
+    }
+
+    if ((flag == 0) && (doorbell != NULL)) {
+      EEPROBE_waitDoorbell(doorbell, seq, &backoff, EEPROBE_RECV);
+    } else if (flag == 0) {
+      EEPROBE_Backoff_yield(&backoff, EEPROBE_RECV);
+    }
+
+  }
+
+  EEPROBE_endChannel(&backoff, channel);
+  EEPROBE_Backoff_reset(&backoff);
+
+  if (errno != MPI_SUCCESS) {
+    return errno;
+  }
+
+  errno = MPI_Imrecv(buf, count, datatype, &message, &request);
+
+  EEPROBE_Backoff_init(&backoff);
+  backoff.progress_yield_time = _EEPROBE_PROGRESS_YIELD_TIME;
+
+  flag = 0;
+
+  while ((flag == 0) && (errno == MPI_SUCCESS)) {
+
+    errno = MPI_Test(&request, &flag, status);
+
+    if (flag == 0) {
+      EEPROBE_Backoff_yield(&backoff, EEPROBE_RECV);
+    }
+
+  }
+
+  EEPROBE_Backoff_reset(&backoff);
+
+  return errno;
+
+}
+
+int
+EEPROBE_Recv(void *buf, int count, MPI_Datatype datatype,
+	     int source, int tag, MPI_Comm comm, MPI_Status *status) {
+  return EEPROBE_Recv_Switch(buf, count, datatype, source, tag, comm, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_Recv_Switch(void *buf, int count, MPI_Datatype datatype,
+		    int source, int tag, MPI_Comm comm, MPI_Status *status,
+		    EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Doorbell * doorbell = NULL;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_RECV, EEPROBE_RETURN_ADDRESS());
+
+  if (enable == EEPROBE_ENABLE) {
+    doorbell = EEPROBE_getDoorbell(source, comm);
+  }
+
+  if ((enable == EEPROBE_ENABLE) &&
+      ((doorbell != NULL) || EEPROBE_isLarge(EEPROBE_getBytes(count, datatype)))) {
+
+    errno = EEPROBE_Recv_Large(buf, count, datatype, source, tag, comm, status, doorbell);
+
+  } else if (enable == EEPROBE_ENABLE) {
+
+    errno = MPI_Irecv(buf, count, datatype, source, tag, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_RECV,
+			      comm, source, tag, 0);
+
+  } else {
+
+    errno = MPI_Recv(buf, count, datatype, source, tag, comm, status);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_Send(const void *buf, int count, MPI_Datatype datatype,
+	     int dest, int tag, MPI_Comm comm) {
+  return EEPROBE_Send_Switch(buf, count, datatype, dest, tag, comm, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_Send_Switch(const void *buf, int count, MPI_Datatype datatype,
+	            int dest, int tag, MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_SEND, EEPROBE_RETURN_ADDRESS());
+
+  /* a doorbell is rung once the message is posted, even when the send does
+     not sleep */
+  if ((enable == EEPROBE_ENABLE) ||
+      (EEPROBE_getDoorbellRank(dest, comm) != MPI_UNDEFINED)) {
+
+    errno = MPI_Isend(buf, count, datatype, dest, tag, comm, &request);
+
+    if (errno == MPI_SUCCESS) {
+      EEPROBE_ringDoorbell(dest, comm);
+    }
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_SEND,
+			      comm, dest, tag, EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_Send(buf, count, datatype, dest, tag, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_Ssend(const void *buf, int count, MPI_Datatype datatype,
+	      int dest, int tag, MPI_Comm comm) {
+  return EEPROBE_Ssend_Switch(buf, count, datatype, dest, tag, comm, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_Ssend_Switch(const void *buf, int count, MPI_Datatype datatype,
+	             int dest, int tag, MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_SSEND, EEPROBE_RETURN_ADDRESS());
+
+  /* a doorbell is rung once the message is posted, even when the send does
+     not sleep */
+  if ((enable == EEPROBE_ENABLE) ||
+      (EEPROBE_getDoorbellRank(dest, comm) != MPI_UNDEFINED)) {
+
+    errno = MPI_Issend(buf, count, datatype, dest, tag, comm, &request);
+
+    if (errno == MPI_SUCCESS) {
+      EEPROBE_ringDoorbell(dest, comm);
+    }
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_SSEND,
+			      comm, dest, tag, EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_Ssend(buf, count, datatype, dest, tag, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_Rsend(const void *buf, int count, MPI_Datatype datatype,
+	      int dest, int tag, MPI_Comm comm) {
+  return EEPROBE_Rsend_Switch(buf, count, datatype, dest, tag, comm, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_Rsend_Switch(const void *buf, int count, MPI_Datatype datatype,
+	             int dest, int tag, MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_RSEND, EEPROBE_RETURN_ADDRESS());
+
+  /* a doorbell is rung once the message is posted, even when the send does
+     not sleep */
+  if ((enable == EEPROBE_ENABLE) ||
+      (EEPROBE_getDoorbellRank(dest, comm) != MPI_UNDEFINED)) {
+
+    errno = MPI_Irsend(buf, count, datatype, dest, tag, comm, &request);
+
+    if (errno == MPI_SUCCESS) {
+      EEPROBE_ringDoorbell(dest, comm);
+    }
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_RSEND,
+			      comm, dest, tag, EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_Rsend(buf, count, datatype, dest, tag, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_Reduce(const void *sendbuf, void *recvbuf, int count,
+		      MPI_Datatype datatype, MPI_Op op, int root,
+		      MPI_Comm comm) {
+  return EEPROBE_Reduce_Switch(sendbuf, recvbuf, count, datatype, op, root, comm, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_Reduce_Switch(const void *sendbuf, void *recvbuf, int count,
+		      MPI_Datatype datatype, MPI_Op op, int root,
+		      MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_REDUCE, EEPROBE_RETURN_ADDRESS());
+
+  /* blocking and nonblocking collectives do not match, so EEPROBE_AUTO always
+     uses the nonblocking one and only chooses how to wait for it */
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Ireduce(sendbuf, recvbuf, count, datatype, op, root, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_REDUCE,
+			      comm, root, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_Allreduce(const void *sendbuf, void *recvbuf, int count,
+                  MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+
+  return EEPROBE_Allreduce_Switch(sendbuf, recvbuf, count, datatype, op, comm, EEPROBE_ENABLE);
+
+}
+
+
+int
+EEPROBE_Allreduce_Switch(const void *sendbuf, void *recvbuf, int count,
+			 MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+			 EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_ALLREDUCE, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Iallreduce(sendbuf, recvbuf, count, datatype, op, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLREDUCE,
+			      comm, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_Alltoall(const void *sendbuf, int sendcount,
+		 MPI_Datatype sendtype, void *recvbuf, int recvcount,
+		 MPI_Datatype recvtype, MPI_Comm comm) {
+
+  return EEPROBE_Alltoall_Switch(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm,
+				 EEPROBE_ENABLE);
+
+}
+
+int
+EEPROBE_Alltoall_Switch(const void *sendbuf, int sendcount,
+			MPI_Datatype sendtype, void *recvbuf, int recvcount,
+			MPI_Datatype recvtype, MPI_Comm comm,
+			EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_ALLTOALL, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Ialltoall(sendbuf, sendcount, sendtype, recvbuf,
+			  recvcount, recvtype, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLTOALL,
+			      comm, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(recvcount, recvtype) * EEPROBE_getTaskNr(comm));
+
+  } else {
+
+    errno = MPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf,
+			 recvcount, recvtype, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_Alltoallv(const void *sendbuf, const int sendcounts[],
+		  const int sdispls[], MPI_Datatype sendtype,
+		  void *recvbuf, const int recvcounts[],
+		  const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm) {
+
+  return EEPROBE_Alltoallv_Switch(sendbuf, sendcounts, sdispls, sendtype,
+				  recvbuf, recvcounts, rdispls, recvtype, comm,
+				  EEPROBE_ENABLE);
+
+}
+
+int
+EEPROBE_Alltoallv_Switch(const void *sendbuf, const int sendcounts[],
+			 const int sdispls[], MPI_Datatype sendtype,
+			 void *recvbuf, const int recvcounts[],
+			 const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm,
+			 EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_ALLTOALLV, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Ialltoallv(sendbuf, sendcounts, sdispls, sendtype,
+			   recvbuf, recvcounts, rdispls, recvtype, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLTOALLV,
+			      comm, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getSumBytes(recvcounts, recvtype, comm));
+
+  } else {
+
+    errno = MPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype,
+			  recvbuf, recvcounts, rdispls, recvtype, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_Alltoallw(const void *sendbuf, const int sendcounts[],
+		  const int sdispls[], const MPI_Datatype sendtypes[],
+		  void *recvbuf, const int recvcounts[], const int rdispls[],
+		  const MPI_Datatype recvtypes[], MPI_Comm comm) {
+
+  return EEPROBE_Alltoallw_Switch(sendbuf, sendcounts, sdispls, sendtypes,
+				  recvbuf, recvcounts, rdispls, recvtypes, comm,
+				  EEPROBE_ENABLE);
+
+}
+
+int
+EEPROBE_Alltoallw_Switch(const void *sendbuf, const int sendcounts[],
+			 const int sdispls[], const MPI_Datatype sendtypes[],
+			 void *recvbuf, const int recvcounts[], const int rdispls[],
+			 const MPI_Datatype recvtypes[], MPI_Comm comm,
+			 EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_ALLTOALLW, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Ialltoallw(sendbuf, sendcounts, sdispls, sendtypes,
+			   recvbuf, recvcounts, rdispls, recvtypes, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLTOALLW,
+			      comm, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getSumBytesW(recvcounts, recvtypes, comm));
+
+  } else {
+
+    errno = MPI_Alltoallw(sendbuf, sendcounts, sdispls, sendtypes,
+			  recvbuf, recvcounts, rdispls, recvtypes, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Bcast(void *buffer, int count, MPI_Datatype datatype,
+	      int root, MPI_Comm comm) {
+
+  return EEPROBE_Bcast_Switch(buffer, count, datatype, root, comm, EEPROBE_ENABLE);
+  
+}
+
+int
+EEPROBE_Bcast_Switch(void *buffer, int count, MPI_Datatype datatype,
+		     int root, MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_BCAST, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Ibcast(buffer, count, datatype, root, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_BCAST,
+			      comm, root, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_Bcast(buffer, count, datatype, root, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+  
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+		MPI_Comm comm) {
+
+  return EEPROBE_Scatter_Switch(sendbuf, sendcount, sendtype,
+				recvbuf, recvcount, recvtype, root, comm,
+				EEPROBE_ENABLE);
+  
+}
+
+int
+EEPROBE_Scatter_Switch(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		       void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+		       MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_SCATTER, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Iscatter(sendbuf, sendcount, sendtype,
+			 recvbuf, recvcount, recvtype, root, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_SCATTER,
+			      comm, root, MPI_ANY_TAG,
+			      (EEPROBE_isRoot(root, comm) ?
+			       EEPROBE_getBytes(sendcount, sendtype) * EEPROBE_getTaskNr(comm) :
+			       EEPROBE_getBytes(recvcount, recvtype)));
+
+  } else {
+
+    errno = MPI_Scatter(sendbuf, sendcount, sendtype,
+			recvbuf, recvcount, recvtype, root, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+  
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Scatterv(const void *sendbuf, const int sendcounts[], const int displs[],
+		 MPI_Datatype sendtype, void *recvbuf, int recvcount,
+		 MPI_Datatype recvtype, int root, MPI_Comm comm) {
+
+  return EEPROBE_Scatterv_Switch(sendbuf, sendcounts, displs, sendtype,
+				 recvbuf, recvcount, recvtype, root, comm,
+				 EEPROBE_ENABLE);
+  
+}
+
+int
+EEPROBE_Scatterv_Switch(const void *sendbuf, const int sendcounts[], const int displs[],
+			MPI_Datatype sendtype, void *recvbuf, int recvcount,
+			MPI_Datatype recvtype, int root, MPI_Comm comm,
+			EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_SCATTERV, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Iscatterv(sendbuf, sendcounts, displs, sendtype,
+			  recvbuf, recvcount, recvtype, root, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_SCATTERV,
+			      comm, root, MPI_ANY_TAG,
+			      (EEPROBE_isRoot(root, comm) ?
+			       EEPROBE_getSumBytes(sendcounts, sendtype, comm) :
+			       EEPROBE_getBytes(recvcount, recvtype)));
+
+  } else {
+
+    errno = MPI_Scatterv(sendbuf, sendcounts, displs, sendtype,
+			 recvbuf, recvcount, recvtype, root, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+  
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+	       void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+	       MPI_Comm comm) {
+
+  return EEPROBE_Gather_Switch(sendbuf, sendcount, sendtype,
+			       recvbuf, recvcount, recvtype, root, comm,
+			       EEPROBE_ENABLE);
+  
+}
+
+int
+EEPROBE_Gather_Switch(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		      void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+		      MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_GATHER, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Igather(sendbuf, sendcount, sendtype,
+			recvbuf, recvcount, recvtype, root, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_GATHER,
+			      comm, root, MPI_ANY_TAG,
+			      (EEPROBE_isRoot(root, comm) ?
+			       EEPROBE_getBytes(recvcount, recvtype) * EEPROBE_getTaskNr(comm) :
+			       EEPROBE_getBytes(sendcount, sendtype)));
+
+  } else {
+
+    errno = MPI_Gather(sendbuf, sendcount, sendtype,
+		       recvbuf, recvcount, recvtype, root, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+  
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Gatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		void *recvbuf, const int recvcounts[], const int displs[],
+		MPI_Datatype recvtype, int root, MPI_Comm comm) {
+
+  return EEPROBE_Gatherv_Switch(sendbuf, sendcount, sendtype,
+				recvbuf, recvcounts, displs, recvtype, root, comm,
+				EEPROBE_ENABLE);
+  
+}
+
+int
+EEPROBE_Gatherv_Switch(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+		       void *recvbuf, const int recvcounts[], const int displs[],
+		       MPI_Datatype recvtype, int root, MPI_Comm comm,
+		       EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_GATHERV, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Igatherv(sendbuf, sendcount, sendtype,
+			 recvbuf, recvcounts, displs, recvtype, root, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_GATHERV,
+			      comm, root, MPI_ANY_TAG,
+			      (EEPROBE_isRoot(root, comm) ?
+			       EEPROBE_getSumBytes(recvcounts, recvtype, comm) :
+			       EEPROBE_getBytes(sendcount, sendtype)));
+
+  } else {
+
+    errno = MPI_Gatherv(sendbuf, sendcount, sendtype,
+			recvbuf, recvcounts, displs, recvtype, root, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+  
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Allgather(const void *sendbuf, int  sendcount,
+		  MPI_Datatype sendtype, void *recvbuf, int recvcount,
+		  MPI_Datatype recvtype, MPI_Comm comm) {
+
+  return EEPROBE_Allgather_Switch(sendbuf, sendcount, sendtype,
+				  recvbuf, recvcount, recvtype, comm,
+				  EEPROBE_ENABLE);
+  
+}
+
+int
+EEPROBE_Allgather_Switch(const void *sendbuf, int  sendcount,
+			 MPI_Datatype sendtype, void *recvbuf, int recvcount,
+			 MPI_Datatype recvtype, MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_ALLGATHER, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Iallgather(sendbuf, sendcount, sendtype,
+			   recvbuf, recvcount, recvtype, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLGATHER,
+			      comm, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(recvcount, recvtype) * EEPROBE_getTaskNr(comm));
+
+  } else {
+
+    errno = MPI_Allgather(sendbuf, sendcount, sendtype,
+			  recvbuf, recvcount, recvtype, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+  
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Allgatherv(const void *sendbuf, int sendcount,
+		   MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
+		   const int displs[], MPI_Datatype recvtype, MPI_Comm comm) {
+
+  return EEPROBE_Allgatherv_Switch(sendbuf, sendcount, sendtype,
+				   recvbuf, recvcounts, displs, recvtype, comm,
+				   EEPROBE_ENABLE);
+  
+}
+
+int
+EEPROBE_Allgatherv_Switch(const void *sendbuf, int sendcount,
+			  MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
+			  const int displs[], MPI_Datatype recvtype, MPI_Comm comm,
+			  EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_ALLGATHERV, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Iallgatherv(sendbuf, sendcount, sendtype,
+			    recvbuf, recvcounts, displs, recvtype, comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLGATHERV,
+			      comm, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getSumBytes(recvcounts, recvtype, comm));
+
+  } else {
+
+    errno = MPI_Allgatherv(sendbuf, sendcount, sendtype,
+			   recvbuf, recvcounts, displs, recvtype, comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+  
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Barrier(MPI_Comm comm) {
+
+  return EEPROBE_Barrier_Switch(comm, EEPROBE_ENABLE);
+  
+}
+
+int
+EEPROBE_Barrier_Switch(MPI_Comm comm, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+  
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_BARRIER, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_Ibarrier(comm, &request);
+
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_BARRIER,
+			      comm, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      0);
+
+  } else {
+
+    errno = MPI_Barrier(comm);
+
+  }
+
+  EEPROBE_endSite(site);
+
+  return errno;
+  
+}
+
+
+/* ---------------------------------------------------------------------------------- */
+
+static unsigned long _EEPROBE_FILE_BYTES[EEPROBE_NB_ACTION];
+
+  /**
+   * Account the bytes moved by a completed MPI-IO operation.
+   */
+static void
+EEPROBE_recordFileBytes(EEPROBE_ACTION action, int errno, MPI_Status * status,
+			MPI_Datatype datatype) {
+
+  int count = 0;
+
+  int size = 0;
+
+  if (errno != MPI_SUCCESS) {
+    return;
+  }
+
+  MPI_Get_count(status, datatype, &count);
+  MPI_Type_size(datatype, &size);
+
+  if (count != MPI_UNDEFINED) {
+    _EEPROBE_FILE_BYTES[action] += (unsigned long) count * size;
+  }
+
+}
+
+unsigned long
+EEPROBE_getFileBytes(EEPROBE_ACTION action) {
+  assert(action < EEPROBE_NB_ACTION);
+  return _EEPROBE_FILE_BYTES[action];
+}
+
+double
+EEPROBE_getFileBytesPerSleep(EEPROBE_ACTION action) {
+
+  unsigned long sleep_time = 0;
+
+  assert(action < EEPROBE_NB_ACTION);
+
+  sleep_time = EEPROBE_getTotalSleepTimeAction(action);
+
+  if (sleep_time == 0) {
+    return 0.0;
+  }
+
+  /* sleep times are measured with EEPROBE_getTime(), in microseconds */
+  return (double) _EEPROBE_FILE_BYTES[action] * 1e6 / sleep_time;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_read(MPI_File fh, void *buf, int count,
+		  MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_read_Switch(fh, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_read_Switch(MPI_File fh, void *buf, int count,
+			 MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_READ, EEPROBE_RETURN_ADDRESS());
+
+  if (enable == EEPROBE_ENABLE) {
+
+    errno = MPI_File_iread(fh, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_READ,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_read(fh, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_READ, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_read_at(MPI_File fh, MPI_Offset offset, void *buf, int count,
+		     MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_read_at_Switch(fh, offset, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_read_at_Switch(MPI_File fh, MPI_Offset offset, void *buf, int count,
+			    MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_READ_AT, EEPROBE_RETURN_ADDRESS());
+
+  if (enable == EEPROBE_ENABLE) {
+
+    errno = MPI_File_iread_at(fh, offset, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_READ_AT,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_read_at(fh, offset, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_READ_AT, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_read_all(MPI_File fh, void *buf, int count,
+		      MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_read_all_Switch(fh, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_read_all_Switch(MPI_File fh, void *buf, int count,
+			     MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_READ_ALL, EEPROBE_RETURN_ADDRESS());
+
+  /* as for collectives, EEPROBE_AUTO always uses the nonblocking operation */
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_File_iread_all(fh, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_READ_ALL,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_read_all(fh, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_READ_ALL, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_read_at_all(MPI_File fh, MPI_Offset offset, void *buf, int count,
+			 MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_read_at_all_Switch(fh, offset, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_read_at_all_Switch(MPI_File fh, MPI_Offset offset, void *buf, int count,
+				MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_READ_AT_ALL, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_File_iread_at_all(fh, offset, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_READ_AT_ALL,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_read_at_all(fh, offset, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_READ_AT_ALL, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_read_shared(MPI_File fh, void *buf, int count,
+			 MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_read_shared_Switch(fh, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_read_shared_Switch(MPI_File fh, void *buf, int count,
+				MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_READ_SHARED, EEPROBE_RETURN_ADDRESS());
+
+  if (enable == EEPROBE_ENABLE) {
+
+    errno = MPI_File_iread_shared(fh, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_READ_SHARED,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_read_shared(fh, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_READ_SHARED, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+  /**
+   * Returns the communicator the ordered MPI-IO wrappers exchange the sizes
+   * on: MPI_COMM_WORLD or MPI_COMM_SELF when the group of the file is the same,
+   * in the same order. MPI has no way to get the communicator a file was
+   * opened on, so other groups, and files opened with MPI_MODE_SEQUENTIAL
+   * which forbids explicit offsets, get MPI_COMM_NULL. The answer is the same
+   * on all the processes of the file.
+   */
+static MPI_Comm
+EEPROBE_getFileComm(MPI_File fh) {
+
+  MPI_Group group;
+
+  MPI_Group comm_group;
+
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  int amode = 0;
+
+  int result = MPI_UNEQUAL;
+
+  MPI_File_get_amode(fh, &amode);
+  if (amode & MPI_MODE_SEQUENTIAL) {
+    return MPI_COMM_NULL;
+  }
+
+  MPI_File_get_group(fh, &group);
+
+  MPI_Comm_group(MPI_COMM_WORLD, &comm_group);
+  MPI_Group_compare(group, comm_group, &result);
+  MPI_Group_free(&comm_group);
+
+  if (result == MPI_IDENT) {
+    comm = MPI_COMM_WORLD;
+  } else {
+    MPI_Comm_group(MPI_COMM_SELF, &comm_group);
+    MPI_Group_compare(group, comm_group, &result);
+    MPI_Group_free(&comm_group);
+    if (result == MPI_IDENT) {
+      comm = MPI_COMM_SELF;
+    }
+  }
+
+  MPI_Group_free(&group);
+
+  return comm;
+
+}
+
+  /**
+   * Claim the file range of an ordered operation: the shared file pointer is
+   * read before the sizes in etypes are gathered, so that no process can move
+   * it before all of them have read it. Returns the offset of the calling
+   * process and the end of the range, both in etypes, as the shared pointer.
+   */
+static int
+EEPROBE_File_claimOrdered(MPI_File fh, MPI_Comm comm, int count, MPI_Datatype datatype,
+			  EEPROBE_Enable enable, EEPROBE_ACTION action,
+			  MPI_Offset * offset, MPI_Offset * end) {
+
+  char datarep[MPI_MAX_DATAREP_STRING];
+
+  MPI_Request request;
+
+  MPI_Status status;
+
+  MPI_Datatype etype;
+
+  MPI_Datatype filetype;
+
+  MPI_Offset disp = 0;
+
+  MPI_Offset position = 0;
+
+  MPI_Offset size = 0;
+
+  MPI_Offset * sizes = NULL;
+
+  int type_size = 0;
+
+  int etype_size = 0;
+
+  int combiner = 0;
+
+  int nb_int = 0;
+
+  int nb_addr = 0;
+
+  int nb_type = 0;
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int errno = MPI_SUCCESS;
+
+  int i = 0;
+
+  errno = MPI_File_get_position_shared(fh, &position);
+  if (errno != MPI_SUCCESS) {
+    return errno;
+  }
+
+  errno = MPI_File_get_view(fh, &disp, &etype, &filetype, datarep);
+  if (errno != MPI_SUCCESS) {
+    return errno;
+  }
+
+  MPI_Type_size(etype, &etype_size);
+  MPI_Type_size(datatype, &type_size);
+
+  /* the view returns copies of the derived datatypes */
+  MPI_Type_get_envelope(etype, &nb_int, &nb_addr, &nb_type, &combiner);
+  if (combiner != MPI_COMBINER_NAMED) {
+    MPI_Type_free(&etype);
+  }
+  MPI_Type_get_envelope(filetype, &nb_int, &nb_addr, &nb_type, &combiner);
+  if (combiner != MPI_COMBINER_NAMED) {
+    MPI_Type_free(&filetype);
+  }
+
+  size = (MPI_Offset) count * type_size / etype_size;
+
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nr);
+
+  sizes = malloc(nr * sizeof(MPI_Offset));
+  assert(sizes);
+
+  errno = MPI_Iallgather(&size, 1, MPI_OFFSET, sizes, 1, MPI_OFFSET, comm, &request);
+
+  if (errno == MPI_SUCCESS) {
+    errno = EEPROBE_Wait_Core(&request, &status, enable, action,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG, 0);
+  }
+
+  if (errno == MPI_SUCCESS) {
+    *offset = position;
+    *end = position;
+    for (i = 0; i < nr; i++) {
+      if (i < rank) {
+	*offset += sizes[i];
+      }
+      *end += sizes[i];
+    }
+  }
+
+  free(sizes);
+
+  return errno;
+
+}
+
+int
+EEPROBE_File_read_ordered(MPI_File fh, void *buf, int count,
+			  MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_read_ordered_Switch(fh, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_read_ordered_Switch(MPI_File fh, void *buf, int count,
+				 MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  MPI_Offset offset = 0;
+
+  MPI_Offset end = 0;
+
+  int errno = MPI_SUCCESS;
+
+  int seek_errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_READ_ORDERED, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+    comm = EEPROBE_getFileComm(fh);
+  }
+
+  if (comm != MPI_COMM_NULL) {
+
+    /* MPI has no nonblocking ordered operation: the range is claimed with a
+       nonblocking gather of the sizes, accessed at explicit offsets, and the
+       shared pointer moved past it */
+    errno = EEPROBE_File_claimOrdered(fh, comm, count, datatype, enable,
+				      EEPROBE_FILE_READ_ORDERED, &offset, &end);
+
+    if (errno == MPI_SUCCESS) {
+
+      errno = MPI_File_iread_at_all(fh, offset, buf, count, datatype, &request);
+
+      if (errno == MPI_SUCCESS) {
+	errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_READ_ORDERED,
+				  MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+				  EEPROBE_getBytes(count, datatype));
+      }
+
+      /* collective, so run even if the access failed */
+      seek_errno = MPI_File_seek_shared(fh, end, MPI_SEEK_SET);
+      if (errno == MPI_SUCCESS) {
+	errno = seek_errno;
+      }
+
+    }
+
+  } else {
+
+    errno = MPI_File_read_ordered(fh, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_READ_ORDERED, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_write(MPI_File fh, const void *buf, int count,
+		   MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_write_Switch(fh, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_write_Switch(MPI_File fh, const void *buf, int count,
+			  MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_WRITE, EEPROBE_RETURN_ADDRESS());
+
+  if (enable == EEPROBE_ENABLE) {
+
+    errno = MPI_File_iwrite(fh, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_WRITE,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_write(fh, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_WRITE, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_write_at(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+		      MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_write_at_Switch(fh, offset, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_write_at_Switch(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+			     MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_WRITE_AT, EEPROBE_RETURN_ADDRESS());
+
+  if (enable == EEPROBE_ENABLE) {
+
+    errno = MPI_File_iwrite_at(fh, offset, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_WRITE_AT,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_write_at(fh, offset, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_WRITE_AT, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_write_all(MPI_File fh, const void *buf, int count,
+		       MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_write_all_Switch(fh, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_write_all_Switch(MPI_File fh, const void *buf, int count,
+			      MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_WRITE_ALL, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_File_iwrite_all(fh, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_WRITE_ALL,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_write_all(fh, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_WRITE_ALL, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_write_at_all(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+			  MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_write_at_all_Switch(fh, offset, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_write_at_all_Switch(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+				 MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_WRITE_AT_ALL, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+
+    errno = MPI_File_iwrite_at_all(fh, offset, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_WRITE_AT_ALL,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_write_at_all(fh, offset, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_WRITE_AT_ALL, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_write_shared(MPI_File fh, const void *buf, int count,
+			  MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_write_shared_Switch(fh, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_write_shared_Switch(MPI_File fh, const void *buf, int count,
+				 MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_WRITE_SHARED, EEPROBE_RETURN_ADDRESS());
+
+  if (enable == EEPROBE_ENABLE) {
+
+    errno = MPI_File_iwrite_shared(fh, buf, count, datatype, &request);
+
+    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_WRITE_SHARED,
+			      MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+			      EEPROBE_getBytes(count, datatype));
+
+  } else {
+
+    errno = MPI_File_write_shared(fh, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_WRITE_SHARED, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+
+int
+EEPROBE_File_write_ordered(MPI_File fh, const void *buf, int count,
+			   MPI_Datatype datatype, MPI_Status *status) {
+  return EEPROBE_File_write_ordered_Switch(fh, buf, count, datatype, status, EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_File_write_ordered_Switch(MPI_File fh, const void *buf, int count,
+				  MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status local_status;
+
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  MPI_Offset offset = 0;
+
+  MPI_Offset end = 0;
+
+  int errno = MPI_SUCCESS;
+
+  int seek_errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  if (status == MPI_STATUS_IGNORE) {
+    status = &local_status;
+  }
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_FILE_WRITE_ORDERED, EEPROBE_RETURN_ADDRESS());
+
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
+    comm = EEPROBE_getFileComm(fh);
+  }
+
+  if (comm != MPI_COMM_NULL) {
+
+    /* MPI has no nonblocking ordered operation: the range is claimed with a
+       nonblocking gather of the sizes, accessed at explicit offsets, and the
+       shared pointer moved past it */
+    errno = EEPROBE_File_claimOrdered(fh, comm, count, datatype, enable,
+				      EEPROBE_FILE_WRITE_ORDERED, &offset, &end);
+
+    if (errno == MPI_SUCCESS) {
+
+      errno = MPI_File_iwrite_at_all(fh, offset, buf, count, datatype, &request);
+
+      if (errno == MPI_SUCCESS) {
+	errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_FILE_WRITE_ORDERED,
+				  MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG,
+				  EEPROBE_getBytes(count, datatype));
+      }
+
+      /* collective, so run even if the access failed */
+      seek_errno = MPI_File_seek_shared(fh, end, MPI_SEEK_SET);
+      if (errno == MPI_SUCCESS) {
+	errno = seek_errno;
+      }
+
+    }
+
+  } else {
+
+    errno = MPI_File_write_ordered(fh, buf, count, datatype, status);
+
+  }
+
+  EEPROBE_recordFileBytes(EEPROBE_FILE_WRITE_ORDERED, errno, status, datatype);
+
+  EEPROBE_endSite(site);
+
+  return errno;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+EEPROBE_Rput(const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+	     int target_rank, MPI_Aint target_disp, int target_count,
+	     MPI_Datatype target_datatype, MPI_Win win) {
+  return EEPROBE_Rput_Switch(origin_addr, origin_count, origin_datatype, target_rank,
+			     target_disp, target_count, target_datatype, win,
+			     EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_Rput_Switch(const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+		    int target_rank, MPI_Aint target_disp, int target_count,
+		    MPI_Datatype target_datatype, MPI_Win win, EEPROBE_Enable enable) {
+
+  MPI_Request request;
+
+  MPI_Status status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_RPUT, EEPROBE_RETURN_ADDRESS());
+
+  errno = MPI_Rput(origin_addr, origin_count, origin_datatype, target_rank,
+		   target_disp, target_count, target_datatype, win, &request);
 
-	current_yield_duration.tv_nsec += _EEPROBE_INC_YIELD_TIME;
-	if (current_yield_duration.tv_nsec > _EEPROBE_MAX_YIELD_TIME) {
-	  current_yield_duration.tv_nsec = _EEPROBE_MAX_YIELD_TIME;
-	}
+  if (errno == MPI_SUCCESS) {
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_RPUT,
+			      MPI_COMM_NULL, target_rank, MPI_ANY_TAG,
+			      EEPROBE_getBytes(origin_count, origin_datatype));
+  }
 
-      }
+  EEPROBE_endSite(site);
 
-    }
+  return errno;
 
-    _EEPROBE_LAST_YIELD_TIME = current_yield_duration.tv_nsec;
+}
 
-  } else {
+/* ---------------------------------------------------------------------------------- */
 
-    errno = MPI_Probe(source, tag, comm, status);
+int
+EEPROBE_Rget(void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+	     int target_rank, MPI_Aint target_disp, int target_count,
+	     MPI_Datatype target_datatype, MPI_Win win) {
+  return EEPROBE_Rget_Switch(origin_addr, origin_count, origin_datatype, target_rank,
+			     target_disp, target_count, target_datatype, win,
+			     EEPROBE_ENABLE);
+}
+
+int
+EEPROBE_Rget_Switch(void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+		    int target_rank, MPI_Aint target_disp, int target_count,
+		    MPI_Datatype target_datatype, MPI_Win win, EEPROBE_Enable enable) {
+
+  MPI_Request request;
 
+  MPI_Status status;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Site * site = NULL;
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_RGET, EEPROBE_RETURN_ADDRESS());
+
+  errno = MPI_Rget(origin_addr, origin_count, origin_datatype, target_rank,
+		   target_disp, target_count, target_datatype, win, &request);
+
+  if (errno == MPI_SUCCESS) {
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_RGET,
+			      MPI_COMM_NULL, target_rank, MPI_ANY_TAG,
+			      EEPROBE_getBytes(origin_count, origin_datatype));
   }
 
+  EEPROBE_endSite(site);
+
   return errno;
-  
+
 }
 
 /* ---------------------------------------------------------------------------------- */
 
+int
+EEPROBE_Raccumulate(const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+		    int target_rank, MPI_Aint target_disp, int target_count,
+		    MPI_Datatype target_datatype, MPI_Op op, MPI_Win win) {
+  return EEPROBE_Raccumulate_Switch(origin_addr, origin_count, origin_datatype,
+				    target_rank, target_disp, target_count,
+				    target_datatype, op, win, EEPROBE_ENABLE);
+}
 
-static int
-EEPROBE_Wait_Core(MPI_Request *request, MPI_Status *status,
-		  EEPROBE_Enable enable, EEPROBE_ACTION action) {
+int
+EEPROBE_Raccumulate_Switch(const void *origin_addr, int origin_count,
+			   MPI_Datatype origin_datatype, int target_rank,
+			   MPI_Aint target_disp, int target_count,
+			   MPI_Datatype target_datatype, MPI_Op op, MPI_Win win,
+			   EEPROBE_Enable enable) {
 
+  MPI_Request request;
 
-#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
-  unsigned long start = 0;
-#endif
-  
-  int flag = 0;
+  MPI_Status status;
 
   int errno = MPI_SUCCESS;
-    
-  struct timespec current_yield_duration;
 
-  if (enable == EEPROBE_ENABLE) {
-    
-    current_yield_duration.tv_sec = 0;
-    current_yield_duration.tv_nsec = _EEPROBE_MIN_YIELD_TIME;
+  EEPROBE_Site * site = NULL;
 
-    while ((flag == 0) && (errno == MPI_SUCCESS)) {
+  site = EEPROBE_beginSite(&enable, EEPROBE_RACCUMULATE, EEPROBE_RETURN_ADDRESS());
 
-      errno = MPI_Test(request, &flag, status);
+  errno = MPI_Raccumulate(origin_addr, origin_count, origin_datatype, target_rank,
+			  target_disp, target_count, target_datatype, op, win, &request);
 
-      if (flag == 0) {
+  if (errno == MPI_SUCCESS) {
+    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_RACCUMULATE,
+			      MPI_COMM_NULL, target_rank, MPI_ANY_TAG,
+			      EEPROBE_getBytes(origin_count, origin_datatype));
+  }
 
-#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
-	start = EEPROBE_getTime();
-#endif
-      
-	clock_nanosleep(CLOCK_MONOTONIC, 0, &current_yield_duration, NULL);
+  EEPROBE_endSite(site);
 
-#if EEPROBE_ENABLE_TOTAL_SLEEP_TIME
-	EEPROBE_updateTotalSleepTime(action, EEPROBE_getTime() - start);
-#endif
+  return errno;
 
-	current_yield_duration.tv_nsec += _EEPROBE_INC_YIELD_TIME;
-	if (current_yield_duration.tv_nsec > _EEPROBE_MAX_YIELD_TIME) {
-	  current_yield_duration.tv_nsec = _EEPROBE_MAX_YIELD_TIME;
-	}
+}
 
-      }
+/* ---------------------------------------------------------------------------------- */
 
-    }
+  /* window attribute holding the communicator of the fence barrier */
+static int _EEPROBE_WIN_COMM_KEYVAL = MPI_KEYVAL_INVALID;
 
-    _EEPROBE_LAST_YIELD_TIME = current_yield_duration.tv_nsec;
+  /* tag of MPI_Comm_create_group for the fence communicators, set apart from
+     the small tags of applications */
+#define _EEPROBE_WIN_COMM_TAG 32765
 
-  } else {
+static int
+EEPROBE_freeWinComm(MPI_Win win, int keyval, void * attribute, void * extra_state) {
 
-    errno = MPI_Wait(request, status);
+  MPI_Comm * comm = attribute;
+
+  int errno = MPI_SUCCESS;
+
+  (void) win;
+  (void) keyval;
+  (void) extra_state;
 
+  if (*comm != MPI_COMM_NULL) {
+    errno = MPI_Comm_free(comm);
   }
+  free(comm);
 
   return errno;
-  
-}
 
-int
-EEPROBE_Wait(MPI_Request *request, MPI_Status *status) {
-  return EEPROBE_Wait_Core(request, status, EEPROBE_ENABLE, EEPROBE_WAIT);
 }
 
+  /**
+   * Returns whether all the processes of group belong to MPI_COMM_WORLD. The
+   * answer is the same on all the processes of group: either they all share
+   * this MPI_COMM_WORLD, or each of them finds a process of another one.
+   */
+static int
+EEPROBE_isWorldGroup(MPI_Group group) {
 
-int
-EEPROBE_Wait_Switch(MPI_Request *request, MPI_Status *status, EEPROBE_Enable enable) {
-  return EEPROBE_Wait_Core(request, status, enable, EEPROBE_WAIT);
-}
+  MPI_Group world_group;
 
-/* ---------------------------------------------------------------------------------- */
+  int * ranks = NULL;
 
+  int * world_ranks = NULL;
+
+  int size = 0;
+
+  int valid = 1;
+
+  int i = 0;
+
+  MPI_Group_size(group, &size);
+
+  ranks = malloc(size * sizeof(int));
+  world_ranks = malloc(size * sizeof(int));
+  assert(ranks && world_ranks);
+
+  for (i = 0; i < size; i++) {
+    ranks[i] = i;
+  }
+
+  MPI_Comm_group(MPI_COMM_WORLD, &world_group);
+  MPI_Group_translate_ranks(group, size, ranks, world_group, world_ranks);
+  MPI_Group_free(&world_group);
+
+  for (i = 0; i < size; i++) {
+    valid = valid && (world_ranks[i] != MPI_UNDEFINED);
+  }
+
+  free(ranks);
+  free(world_ranks);
+
+  return valid;
 
-int
-EEPROBE_Recv(void *buf, int count, MPI_Datatype datatype,
-	     int source, int tag, MPI_Comm comm, MPI_Status *status) {
-  return EEPROBE_Recv_Switch(buf, count, datatype, source, tag, comm, status, EEPROBE_ENABLE);
 }
 
-int
-EEPROBE_Recv_Switch(void *buf, int count, MPI_Datatype datatype,
-		    int source, int tag, MPI_Comm comm, MPI_Status *status,
-		    EEPROBE_Enable enable) {
+  /**
+   * Returns the communicator over the group of a window, created by the first
+   * call on this window. The creation is collective over the group, as the
+   * fence. The communicator is MPI_COMM_NULL when the group is not a subset of
+   * MPI_COMM_WORLD (windows over processes spawned or connected later), as
+   * the library does not know the communicator the window was created on.
+   */
+static int
+EEPROBE_getWinComm(MPI_Win win, MPI_Comm * comm) {
 
-  MPI_Request request;
+  MPI_Group group;
+
+  MPI_Comm * win_comm = NULL;
+
+  int found = 0;
 
   int errno = MPI_SUCCESS;
 
-  if (enable == EEPROBE_ENABLE) {
+  if (_EEPROBE_WIN_COMM_KEYVAL == MPI_KEYVAL_INVALID) {
+    errno = MPI_Win_create_keyval(MPI_WIN_NULL_COPY_FN, EEPROBE_freeWinComm,
+				  &_EEPROBE_WIN_COMM_KEYVAL, NULL);
+    if (errno != MPI_SUCCESS) {
+      return errno;
+    }
+  }
 
-    errno = MPI_Irecv(buf, count, datatype, source, tag, comm, &request);
+  errno = MPI_Win_get_attr(win, _EEPROBE_WIN_COMM_KEYVAL, &win_comm, &found);
+  if (errno != MPI_SUCCESS) {
+    return errno;
+  }
 
-    errno = EEPROBE_Wait_Core(&request, status, enable, EEPROBE_RECV);
+  if (found == 0) {
 
-  } else {
+    win_comm = malloc(sizeof(MPI_Comm));
+    assert(win_comm);
 
-    errno = MPI_Recv(buf, count, datatype, source, tag, comm, status);
+    MPI_Win_get_group(win, &group);
+    if (EEPROBE_isWorldGroup(group)) {
+      errno = MPI_Comm_create_group(MPI_COMM_WORLD, group, _EEPROBE_WIN_COMM_TAG, win_comm);
+    } else {
+      *win_comm = MPI_COMM_NULL;
+    }
+    MPI_Group_free(&group);
+
+    if (errno != MPI_SUCCESS) {
+      free(win_comm);
+      return errno;
+    }
+
+    MPI_Win_set_attr(win, _EEPROBE_WIN_COMM_KEYVAL, win_comm);
 
   }
 
+  *comm = *win_comm;
+
   return errno;
 
 }
 
-/* ---------------------------------------------------------------------------------- */
-
-
 int
-EEPROBE_Reduce(const void *sendbuf, void *recvbuf, int count,
-		      MPI_Datatype datatype, MPI_Op op, int root,
-		      MPI_Comm comm) {
-  return EEPROBE_Reduce_Switch(sendbuf, recvbuf, count, datatype, op, root, comm, EEPROBE_ENABLE);
+EEPROBE_Win_fence(int assert, MPI_Win win) {
+  return EEPROBE_Win_fence_Switch(assert, win, EEPROBE_ENABLE);
 }
 
 int
-EEPROBE_Reduce_Switch(const void *sendbuf, void *recvbuf, int count,
-		      MPI_Datatype datatype, MPI_Op op, int root,
-		      MPI_Comm comm, EEPROBE_Enable enable) {
+EEPROBE_Win_fence_Switch(int assert, MPI_Win win, EEPROBE_Enable enable) {
 
   MPI_Request request;
 
   MPI_Status status;
-  
+
+  MPI_Comm comm;
+
   int errno = MPI_SUCCESS;
 
-  if (enable == EEPROBE_ENABLE) {
+  EEPROBE_Site * site = NULL;
 
-    errno = MPI_Ireduce(sendbuf, recvbuf, count, datatype, op, root, comm, &request);
+  site = EEPROBE_beginSite(&enable, EEPROBE_WIN_FENCE, EEPROBE_RETURN_ADDRESS());
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_REDUCE);
+  if ((enable == EEPROBE_ENABLE) || (site != NULL)) {
 
-  } else {
+    errno = EEPROBE_getWinComm(win, &comm);
 
-    errno = MPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+    /* no barrier communicator: the fence alone, without the micro-sleep */
+    if ((errno == MPI_SUCCESS) && (comm != MPI_COMM_NULL)) {
+      errno = MPI_Ibarrier(comm, &request);
+    }
+
+    if ((errno == MPI_SUCCESS) && (comm != MPI_COMM_NULL)) {
+      errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_WIN_FENCE,
+				comm, MPI_ANY_SOURCE, MPI_ANY_TAG, 0);
+    }
+
+  }
 
+  if (errno == MPI_SUCCESS) {
+    errno = MPI_Win_fence(assert, win);
   }
 
+  EEPROBE_endSite(site);
+
   return errno;
 
 }
 
 /* ---------------------------------------------------------------------------------- */
 
+int
+EEPROBE_Win_wait(MPI_Win win) {
+  return EEPROBE_Win_wait_Switch(win, EEPROBE_ENABLE);
+}
 
 int
-EEPROBE_Allreduce(const void *sendbuf, void *recvbuf, int count,
-                  MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+EEPROBE_Win_wait_Switch(MPI_Win win, EEPROBE_Enable enable) {
 
-  return EEPROBE_Allreduce_Switch(sendbuf, recvbuf, count, datatype, op, comm, EEPROBE_ENABLE);
+  int flag = 0;
 
-}
+  int errno = MPI_SUCCESS;
 
+  EEPROBE_Backoff backoff;
 
-int
-EEPROBE_Allreduce_Switch(const void *sendbuf, void *recvbuf, int count,
-			 MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
-			 EEPROBE_Enable enable) {
+  EEPROBE_Channel * channel = NULL;
 
-  MPI_Request request;
+  EEPROBE_Site * site = NULL;
 
-  MPI_Status status;
-  
-  int errno = MPI_SUCCESS;
+  site = EEPROBE_beginSite(&enable, EEPROBE_WIN_WAIT, EEPROBE_RETURN_ADDRESS());
 
   if (enable == EEPROBE_ENABLE) {
 
-    errno = MPI_Iallreduce(sendbuf, recvbuf, count, datatype, op, comm, &request);
+    EEPROBE_Backoff_init(&backoff);
+
+    channel = EEPROBE_getChannel(EEPROBE_WIN_WAIT, MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG);
+    EEPROBE_startChannel(&backoff, channel);
+
+    while ((flag == 0) && (errno == MPI_SUCCESS)) {
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLREDUCE);
+      errno = MPI_Win_test(win, &flag);
+
+      if (flag == 0) {
+	EEPROBE_Backoff_yield(&backoff, EEPROBE_WIN_WAIT);
+      }
+
+    }
+
+    EEPROBE_endChannel(&backoff, channel);
+    EEPROBE_Backoff_reset(&backoff);
 
   } else {
 
-    errno = MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+    errno = MPI_Win_wait(win);
 
   }
 
+  EEPROBE_endSite(site);
+
   return errno;
 
 }
 
 /* ---------------------------------------------------------------------------------- */
 
+int
+EEPROBE_Win_wait_flag(const volatile int *flag, int value, MPI_Win win) {
+  return EEPROBE_Win_wait_flag_Switch(flag, value, win, EEPROBE_ENABLE);
+}
 
 int
-EEPROBE_Alltoall(const void *sendbuf, int sendcount,
-		 MPI_Datatype sendtype, void *recvbuf, int recvcount,
-		 MPI_Datatype recvtype, MPI_Comm comm) {
+EEPROBE_Win_wait_flag_Switch(const volatile int *flag, int value, MPI_Win win,
+			     EEPROBE_Enable enable) {
 
-  return EEPROBE_Alltoall_Switch(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm,
-				 EEPROBE_ENABLE);
+  int errno = MPI_SUCCESS;
 
-}
+  EEPROBE_Backoff backoff;
 
-int
-EEPROBE_Alltoall_Switch(const void *sendbuf, int sendcount,
-			MPI_Datatype sendtype, void *recvbuf, int recvcount,
-			MPI_Datatype recvtype, MPI_Comm comm,
-			EEPROBE_Enable enable) {
+  EEPROBE_Channel * channel = NULL;
 
-  MPI_Request request;
+  EEPROBE_Site * site = NULL;
 
-  MPI_Status status;
-  
-  int errno = MPI_SUCCESS;
+  assert(flag);
+
+  site = EEPROBE_beginSite(&enable, EEPROBE_WIN_FLAG, EEPROBE_RETURN_ADDRESS());
 
   if (enable == EEPROBE_ENABLE) {
+    EEPROBE_Backoff_init(&backoff);
+    channel = EEPROBE_getChannel(EEPROBE_WIN_FLAG, MPI_COMM_NULL, MPI_ANY_SOURCE, MPI_ANY_TAG);
+    EEPROBE_startChannel(&backoff, channel);
+  }
 
-    errno = MPI_Ialltoall(sendbuf, sendcount, sendtype, recvbuf,
-			  recvcount, recvtype, comm, &request);
+  while (errno == MPI_SUCCESS) {
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLTOALL);
+    errno = MPI_Win_sync(win);
 
-  } else {
+    if (*flag == value) {
+      break;
+    }
 
-    errno = MPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf,
-			 recvcount, recvtype, comm);
+    if (enable == EEPROBE_ENABLE) {
+      EEPROBE_Backoff_yield(&backoff, EEPROBE_WIN_FLAG);
+    }
+
+  }
 
+  if (enable == EEPROBE_ENABLE) {
+    EEPROBE_endChannel(&backoff, channel);
+    EEPROBE_Backoff_reset(&backoff);
   }
 
+  EEPROBE_endSite(site);
+
   return errno;
 
 }
 
 /* ---------------------------------------------------------------------------------- */
 
+#if MPI_VERSION >= 4
 
-int
-EEPROBE_Alltoallv(const void *sendbuf, const int sendcounts[],
-		  const int sdispls[], MPI_Datatype sendtype,
-		  void *recvbuf, const int recvcounts[],
-		  const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm) {
-
-  return EEPROBE_Alltoallv_Switch(sendbuf, sendcounts, sdispls, sendtype,
-				  recvbuf, recvcounts, rdispls, recvtype, comm,
-				  EEPROBE_ENABLE);
-
-}
+static unsigned long _EEPROBE_PARTITION_HISTOGRAMS[EEPROBE_PARTITION_MAX][EEPROBE_PARTITION_NB_BUCKET];
 
-int
-EEPROBE_Alltoallv_Switch(const void *sendbuf, const int sendcounts[],
-			 const int sdispls[], MPI_Datatype sendtype,
-			 void *recvbuf, const int recvcounts[],
-			 const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm,
-			 EEPROBE_Enable enable) {
+static void
+EEPROBE_recordPartition(int partition, unsigned long start_time) {
 
-  MPI_Request request;
+  int bucket = EEPROBE_log2(EEPROBE_getMonotonicTime() - start_time);
 
-  MPI_Status status;
-  
-  int errno = MPI_SUCCESS;
+  if (partition >= EEPROBE_PARTITION_MAX) {
+    partition = EEPROBE_PARTITION_MAX - 1;
+  }
 
-  if (enable == EEPROBE_ENABLE) {
+  if (bucket >= EEPROBE_PARTITION_NB_BUCKET) {
+    bucket = EEPROBE_PARTITION_NB_BUCKET - 1;
+  }
 
-    errno = MPI_Ialltoallv(sendbuf, sendcounts, sdispls, sendtype,
-			   recvbuf, recvcounts, rdispls, recvtype, comm, &request);
+  _EEPROBE_PARTITION_HISTOGRAMS[partition][bucket]++;
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLTOALLV);
+}
 
-  } else {
+void
+EEPROBE_getPartitionHistogram(int partition, unsigned long histogram[]) {
 
-    errno = MPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype,
-			  recvbuf, recvcounts, rdispls, recvtype, comm);
+  assert(partition >= 0);
+  assert(histogram);
 
+  if (partition >= EEPROBE_PARTITION_MAX) {
+    partition = EEPROBE_PARTITION_MAX - 1;
   }
 
-  return errno;
+  memcpy(histogram, _EEPROBE_PARTITION_HISTOGRAMS[partition],
+	 EEPROBE_PARTITION_NB_BUCKET * sizeof(unsigned long));
 
 }
 
-/* ---------------------------------------------------------------------------------- */
+void
+EEPROBE_resetPartitionHistograms() {
+  memset(_EEPROBE_PARTITION_HISTOGRAMS, 0, sizeof(_EEPROBE_PARTITION_HISTOGRAMS));
+}
 
+  /**
+   * Wait for any of the partitions, without call site tracking.
+   */
+static int
+EEPROBE_Parrived_Core(MPI_Request request, int count, const int partitions[],
+		      int *index, EEPROBE_Enable enable) {
 
-int
-EEPROBE_Alltoallw(const void *sendbuf, const int sendcounts[],
-		  const int sdispls[], const MPI_Datatype sendtypes[],
-		  void *recvbuf, const int recvcounts[], const int rdispls[],
-		  const MPI_Datatype recvtypes[], MPI_Comm comm) {
+  unsigned long start_time = EEPROBE_getMonotonicTime();
 
-  return EEPROBE_Alltoallw_Switch(sendbuf, sendcounts, sdispls, sendtypes,
-				  recvbuf, recvcounts, rdispls, recvtypes, comm,
-				  EEPROBE_ENABLE);
+  int flag = 0;
 
-}
+  int i = 0;
 
-int
-EEPROBE_Alltoallw_Switch(const void *sendbuf, const int sendcounts[],
-			 const int sdispls[], const MPI_Datatype sendtypes[],
-			 void *recvbuf, const int recvcounts[], const int rdispls[],
-			 const MPI_Datatype recvtypes[], MPI_Comm comm,
-			 EEPROBE_Enable enable) {
+  int errno = MPI_SUCCESS;
 
-  MPI_Request request;
+  EEPROBE_Backoff backoff;
 
-  MPI_Status status;
-  
-  int errno = MPI_SUCCESS;
+  EEPROBE_Channel * channel = NULL;
 
   if (enable == EEPROBE_ENABLE) {
+    EEPROBE_Backoff_init(&backoff);
+    /* a single partition is predicted on its own channel */
+    channel = EEPROBE_getChannel(EEPROBE_PARRIVED, MPI_COMM_NULL,
+				 (count == 1) ? partitions[0] : MPI_ANY_SOURCE, MPI_ANY_TAG);
+    EEPROBE_startChannel(&backoff, channel);
+  }
 
-    errno = MPI_Ialltoallw(sendbuf, sendcounts, sdispls, sendtypes,
-			   recvbuf, recvcounts, rdispls, recvtypes, comm, &request);
+  while ((flag == 0) && (errno == MPI_SUCCESS)) {
+
+    for (i = 0; (i < count) && (flag == 0) && (errno == MPI_SUCCESS); i++) {
+      errno = MPI_Parrived(request, partitions[i], &flag);
+    }
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLTOALLV);
+    if ((flag == 0) && (enable == EEPROBE_ENABLE)) {
+      EEPROBE_Backoff_yield(&backoff, EEPROBE_PARRIVED);
+    }
 
-  } else {
+  }
 
-    errno = MPI_Alltoallw(sendbuf, sendcounts, sdispls, sendtypes,
-			  recvbuf, recvcounts, rdispls, recvtypes, comm);
+  if (enable == EEPROBE_ENABLE) {
+    EEPROBE_endChannel(&backoff, channel);
+    EEPROBE_Backoff_reset(&backoff);
+  }
 
+  if (flag != 0) {
+    *index = i - 1;
+    EEPROBE_recordPartition(partitions[*index], start_time);
   }
 
   return errno;
 
 }
 
-/* ---------------------------------------------------------------------------------- */
-
 int
-EEPROBE_Bcast(void *buffer, int count, MPI_Datatype datatype,
-	      int root, MPI_Comm comm) {
-
-  return EEPROBE_Bcast_Switch(buffer, count, datatype, root, comm, EEPROBE_ENABLE);
-  
+EEPROBE_Parrived_wait(MPI_Request request, int partition) {
+  return EEPROBE_Parrived_wait_Switch(request, partition, EEPROBE_ENABLE);
 }
 
 int
-EEPROBE_Bcast_Switch(void *buffer, int count, MPI_Datatype datatype,
-		     int root, MPI_Comm comm, EEPROBE_Enable enable) {
+EEPROBE_Parrived_wait_Switch(MPI_Request request, int partition, EEPROBE_Enable enable) {
 
-  MPI_Request request;
+  int index = MPI_UNDEFINED;
 
-  MPI_Status status;
-  
   int errno = MPI_SUCCESS;
 
-  if (enable == EEPROBE_ENABLE) {
-
-    errno = MPI_Ibcast(buffer, count, datatype, root, comm, &request);
-
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_BCAST);
+  EEPROBE_Site * site = NULL;
 
-  } else {
+  site = EEPROBE_beginSite(&enable, EEPROBE_PARRIVED, EEPROBE_RETURN_ADDRESS());
 
-    errno = MPI_Bcast(buffer, count, datatype, root, comm);
+  errno = EEPROBE_Parrived_Core(request, 1, &partition, &index, enable);
 
-  }
+  EEPROBE_endSite(site);
 
   return errno;
-  
-}
 
-/* ---------------------------------------------------------------------------------- */
+}
 
 int
-EEPROBE_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
-		void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
-		MPI_Comm comm) {
-
-  return EEPROBE_Scatter_Switch(sendbuf, sendcount, sendtype,
-				recvbuf, recvcount, recvtype, root, comm,
-				EEPROBE_ENABLE);
-  
+EEPROBE_Parrived_waitany(MPI_Request request, int count, const int partitions[], int *index) {
+  return EEPROBE_Parrived_waitany_Switch(request, count, partitions, index, EEPROBE_ENABLE);
 }
 
 int
-EEPROBE_Scatter_Switch(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
-		       void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
-		       MPI_Comm comm, EEPROBE_Enable enable) {
-
-  MPI_Request request;
+EEPROBE_Parrived_waitany_Switch(MPI_Request request, int count, const int partitions[],
+				int *index, EEPROBE_Enable enable) {
 
-  MPI_Status status;
-  
   int errno = MPI_SUCCESS;
 
-  if (enable == EEPROBE_ENABLE) {
+  EEPROBE_Site * site = NULL;
 
-    errno = MPI_Iscatter(sendbuf, sendcount, sendtype,
-			 recvbuf, recvcount, recvtype, root, comm, &request);
+  assert(index);
+  assert((count == 0) || partitions);
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_SCATTER);
+  *index = MPI_UNDEFINED;
 
-  } else {
+  if (count == 0) {
+    return MPI_SUCCESS;
+  }
 
-    errno = MPI_Scatter(sendbuf, sendcount, sendtype,
-			recvbuf, recvcount, recvtype, root, comm);
+  site = EEPROBE_beginSite(&enable, EEPROBE_PARRIVED, EEPROBE_RETURN_ADDRESS());
 
-  }
+  errno = EEPROBE_Parrived_Core(request, count, partitions, index, enable);
+
+  EEPROBE_endSite(site);
 
   return errno;
-  
+
 }
 
+#endif
+
 /* ---------------------------------------------------------------------------------- */
 
-int
-EEPROBE_Scatterv(const void *sendbuf, const int sendcounts[], const int displs[],
-		 MPI_Datatype sendtype, void *recvbuf, int recvcount,
-		 MPI_Datatype recvtype, int root, MPI_Comm comm) {
+void
+EEPROBE_Reactor_init(EEPROBE_Reactor * reactor, EEPROBE_Enable enable) {
+
+  assert(reactor);
+
+  reactor->nb_request = 0;
+  reactor->capacity = 0;
+  reactor->requests = NULL;
+  reactor->entries = NULL;
+  reactor->completed = NULL;
+  reactor->indices = NULL;
+  reactor->statuses = NULL;
+  reactor->nb_queued = 0;
+  reactor->queued_capacity = 0;
+  reactor->queued_requests = NULL;
+  reactor->queued_entries = NULL;
+  reactor->dispatching = 0;
+  reactor->enable = enable;
+  reactor->stop = 0;
+
+  reactor->stats.nb_dispatch = 0;
+  reactor->stats.nb_poll = 0;
+  reactor->stats.total_dispatch_latency = 0;
+  reactor->stats.max_dispatch_latency = 0;
+  reactor->stats.idle_time = 0;
 
-  return EEPROBE_Scatterv_Switch(sendbuf, sendcounts, displs, sendtype,
-				 recvbuf, recvcount, recvtype, root, comm,
-				 EEPROBE_ENABLE);
-  
 }
 
-int
-EEPROBE_Scatterv_Switch(const void *sendbuf, const int sendcounts[], const int displs[],
-			MPI_Datatype sendtype, void *recvbuf, int recvcount,
-			MPI_Datatype recvtype, int root, MPI_Comm comm,
-			EEPROBE_Enable enable) {
+void
+EEPROBE_Reactor_free(EEPROBE_Reactor * reactor) {
 
-  MPI_Request request;
+  assert(reactor);
+  assert(!reactor->dispatching);
 
-  MPI_Status status;
-  
-  int errno = MPI_SUCCESS;
+  free(reactor->requests);
+  free(reactor->entries);
+  free(reactor->completed);
+  free(reactor->indices);
+  free(reactor->statuses);
+  free(reactor->queued_requests);
+  free(reactor->queued_entries);
 
-  if (enable == EEPROBE_ENABLE) {
+  EEPROBE_Reactor_init(reactor, reactor->enable);
 
-    errno = MPI_Iscatterv(sendbuf, sendcounts, displs, sendtype,
-			  recvbuf, recvcount, recvtype, root, comm, &request);
+}
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_SCATTERV);
+  /**
+   * Queue a request registered from a callback. The arrays walked by the
+   * dispatch loop are left untouched until the batch is over.
+   */
+static void
+EEPROBE_Reactor_queue(EEPROBE_Reactor * reactor, MPI_Request request,
+		      EEPROBE_Callback callback, void * user_data) {
 
-  } else {
+  if (reactor->nb_queued == reactor->queued_capacity) {
 
-    errno = MPI_Scatterv(sendbuf, sendcounts, displs, sendtype,
-			 recvbuf, recvcount, recvtype, root, comm);
+    reactor->queued_capacity = (reactor->queued_capacity == 0) ? 16 : reactor->queued_capacity * 2;
 
-  }
+    reactor->queued_requests = realloc(reactor->queued_requests,
+				       sizeof(MPI_Request) * reactor->queued_capacity);
+    assert(reactor->queued_requests);
 
-  return errno;
-  
-}
+    reactor->queued_entries = realloc(reactor->queued_entries,
+				      sizeof(EEPROBE_ReactorEntry) * reactor->queued_capacity);
+    assert(reactor->queued_entries);
 
-/* ---------------------------------------------------------------------------------- */
+  }
 
-int
-EEPROBE_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
-	       void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
-	       MPI_Comm comm) {
+  reactor->queued_requests[reactor->nb_queued] = request;
+  reactor->queued_entries[reactor->nb_queued].callback = callback;
+  reactor->queued_entries[reactor->nb_queued].user_data = user_data;
+  reactor->nb_queued++;
 
-  return EEPROBE_Gather_Switch(sendbuf, sendcount, sendtype,
-			       recvbuf, recvcount, recvtype, root, comm,
-			       EEPROBE_ENABLE);
-  
 }
 
-int
-EEPROBE_Gather_Switch(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
-		      void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
-		      MPI_Comm comm, EEPROBE_Enable enable) {
+void
+EEPROBE_Reactor_register(EEPROBE_Reactor * reactor, MPI_Request request,
+			 EEPROBE_Callback callback, void * user_data) {
 
-  MPI_Request request;
+  assert(reactor);
+  assert(callback);
 
-  MPI_Status status;
-  
-  int errno = MPI_SUCCESS;
+  if (reactor->dispatching) {
+    EEPROBE_Reactor_queue(reactor, request, callback, user_data);
+    return;
+  }
 
-  if (enable == EEPROBE_ENABLE) {
+  if (reactor->nb_request == reactor->capacity) {
 
-    errno = MPI_Igather(sendbuf, sendcount, sendtype,
-			recvbuf, recvcount, recvtype, root, comm, &request);
+    reactor->capacity = (reactor->capacity == 0) ? 16 : reactor->capacity * 2;
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_GATHER);
+    reactor->requests = realloc(reactor->requests, sizeof(MPI_Request) * reactor->capacity);
+    assert(reactor->requests);
 
-  } else {
+    reactor->entries = realloc(reactor->entries,
+			       sizeof(EEPROBE_ReactorEntry) * reactor->capacity);
+    assert(reactor->entries);
 
-    errno = MPI_Gather(sendbuf, sendcount, sendtype,
-		       recvbuf, recvcount, recvtype, root, comm);
+    reactor->completed = realloc(reactor->completed,
+				 sizeof(EEPROBE_ReactorEntry) * reactor->capacity);
+    assert(reactor->completed);
+
+    reactor->indices = realloc(reactor->indices, sizeof(int) * reactor->capacity);
+    assert(reactor->indices);
+
+    reactor->statuses = realloc(reactor->statuses, sizeof(MPI_Status) * reactor->capacity);
+    assert(reactor->statuses);
 
   }
 
-  return errno;
-  
+  reactor->requests[reactor->nb_request] = request;
+  reactor->entries[reactor->nb_request].callback = callback;
+  reactor->entries[reactor->nb_request].user_data = user_data;
+  reactor->nb_request++;
+
 }
 
-/* ---------------------------------------------------------------------------------- */
+  /**
+   * Test the registered requests one at a time, when MPI_Testsome failed as a
+   * whole. Requests whose MPI_Test completes or fails are reported in the
+   * indices and statuses arrays as MPI_Testsome would, a failed one with the
+   * error in the MPI_ERROR field, since MPI gives no way to tell whether it is
+   * still active. The others stay registered.
+   */
+static int
+EEPROBE_Reactor_testEach(EEPROBE_Reactor * reactor) {
 
-int
-EEPROBE_Gatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
-		void *recvbuf, const int recvcounts[], const int displs[],
-		MPI_Datatype recvtype, int root, MPI_Comm comm) {
+  MPI_Status status;
+
+  int outcount = 0;
+
+  int flag = 0;
+
+  int errno = MPI_SUCCESS;
+
+  int i = 0;
+
+  for (i = 0; i < reactor->nb_request; i++) {
+    flag = 0;
+    errno = MPI_Test(&(reactor->requests[i]), &flag, &status);
+    if ((errno != MPI_SUCCESS) || (flag != 0)) {
+      status.MPI_ERROR = errno;
+      reactor->requests[i] = MPI_REQUEST_NULL;
+      reactor->indices[outcount] = i;
+      reactor->statuses[outcount] = status;
+      outcount++;
+    }
+  }
+
+  return outcount;
 
-  return EEPROBE_Gatherv_Switch(sendbuf, sendcount, sendtype,
-				recvbuf, recvcounts, displs, recvtype, root, comm,
-				EEPROBE_ENABLE);
-  
 }
 
 int
-EEPROBE_Gatherv_Switch(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
-		       void *recvbuf, const int recvcounts[], const int displs[],
-		       MPI_Datatype recvtype, int root, MPI_Comm comm,
-		       EEPROBE_Enable enable) {
+EEPROBE_Reactor_run_once(EEPROBE_Reactor * reactor) {
 
-  MPI_Request request;
+  int outcount = 0;
 
-  MPI_Status status;
-  
-  int errno = MPI_SUCCESS;
+  int i = 0;
 
-  if (enable == EEPROBE_ENABLE) {
+  int j = 0;
 
-    errno = MPI_Igatherv(sendbuf, sendcount, sendtype,
-			 recvbuf, recvcounts, displs, recvtype, root, comm, &request);
+  int errno = MPI_SUCCESS;
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_GATHERV);
+  unsigned long last_poll = 0;
 
-  } else {
+  unsigned long now = 0;
 
-    errno = MPI_Gatherv(sendbuf, sendcount, sendtype,
-			recvbuf, recvcounts, displs, recvtype, root, comm);
+  unsigned long start = 0;
 
-  }
+  EEPROBE_Backoff backoff;
 
-  return errno;
-  
-}
+  assert(reactor);
+  assert(!reactor->dispatching);
 
-/* ---------------------------------------------------------------------------------- */
+  EEPROBE_Backoff_init(&backoff);
 
-int
-EEPROBE_Allgather(const void *sendbuf, int  sendcount,
-		  MPI_Datatype sendtype, void *recvbuf, int recvcount,
-		  MPI_Datatype recvtype, MPI_Comm comm) {
+  last_poll = EEPROBE_getTime();
 
-  return EEPROBE_Allgather_Switch(sendbuf, sendcount, sendtype,
-				  recvbuf, recvcount, recvtype, comm,
-				  EEPROBE_ENABLE);
-  
-}
+  while ((outcount == 0) && (reactor->nb_request > 0)) {
 
-int
-EEPROBE_Allgather_Switch(const void *sendbuf, int  sendcount,
-			 MPI_Datatype sendtype, void *recvbuf, int recvcount,
-			 MPI_Datatype recvtype, MPI_Comm comm, EEPROBE_Enable enable) {
+    start = EEPROBE_getTime();
 
-  MPI_Request request;
+    errno = MPI_Testsome(reactor->nb_request, reactor->requests, &outcount,
+			 reactor->indices, reactor->statuses);
+    reactor->stats.nb_poll++;
 
-  MPI_Status status;
-  
-  int errno = MPI_SUCCESS;
+    if ((errno != MPI_SUCCESS) && (errno != MPI_ERR_IN_STATUS)) {
+      outcount = EEPROBE_Reactor_testEach(reactor);
+    } else if (outcount == MPI_UNDEFINED) {
+      /* only inactive requests left */
+      reactor->nb_request = 0;
+      outcount = 0;
+    }
 
-  if (enable == EEPROBE_ENABLE) {
+    if ((outcount == 0) && (reactor->nb_request > 0)) {
 
-    errno = MPI_Iallgather(sendbuf, sendcount, sendtype,
-			   recvbuf, recvcount, recvtype, comm, &request);
+      last_poll = start;
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLGATHER);
+      if (reactor->enable == EEPROBE_ENABLE) {
+	start = EEPROBE_getTime();
+	EEPROBE_Backoff_yield(&backoff, EEPROBE_REACTOR);
+	reactor->stats.idle_time += EEPROBE_getTime() - start;
+      }
 
-  } else {
+    }
 
-    errno = MPI_Allgather(sendbuf, sendcount, sendtype,
-			  recvbuf, recvcount, recvtype, comm);
+  }
+
+  EEPROBE_Backoff_reset(&backoff);
 
+  if (outcount == 0) {
+    return MPI_SUCCESS;
   }
 
-  return errno;
-  
-}
+  /* failed requests are reported to their callback through MPI_ERROR, the
+     others stay registered */
 
-/* ---------------------------------------------------------------------------------- */
+  if (errno == MPI_SUCCESS) {
+    for (i = 0; i < outcount; i++) {
+      reactor->statuses[i].MPI_ERROR = MPI_SUCCESS;
+    }
+  }
 
-int
-EEPROBE_Allgatherv(const void *sendbuf, int sendcount,
-		   MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
-		   const int displs[], MPI_Datatype recvtype, MPI_Comm comm) {
+  errno = MPI_SUCCESS;
 
-  return EEPROBE_Allgatherv_Switch(sendbuf, sendcount, sendtype,
-				   recvbuf, recvcounts, displs, recvtype, comm,
-				   EEPROBE_ENABLE);
-  
-}
+  /* move the completed entries aside and compact the arrays */
 
-int
-EEPROBE_Allgatherv_Switch(const void *sendbuf, int sendcount,
-			  MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
-			  const int displs[], MPI_Datatype recvtype, MPI_Comm comm,
-			  EEPROBE_Enable enable) {
+  for (i = 0; i < outcount; i++) {
+    reactor->completed[i] = reactor->entries[reactor->indices[i]];
+  }
 
-  MPI_Request request;
+  for (i = 0; i < reactor->nb_request; i++) {
+    if (reactor->requests[i] != MPI_REQUEST_NULL) {
+      reactor->requests[j] = reactor->requests[i];
+      reactor->entries[j] = reactor->entries[i];
+      j++;
+    }
+  }
+  reactor->nb_request = j;
 
-  MPI_Status status;
-  
-  int errno = MPI_SUCCESS;
+  /* registrations made by the callbacks are queued until the batch is over */
 
-  if (enable == EEPROBE_ENABLE) {
+  reactor->dispatching = 1;
 
-    errno = MPI_Iallgatherv(sendbuf, sendcount, sendtype,
-			    recvbuf, recvcounts, displs, recvtype, comm, &request);
+  for (i = 0; i < outcount; i++) {
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_ALLGATHERV);
+    now = EEPROBE_getTime();
 
-  } else {
+    reactor->stats.nb_dispatch++;
+    reactor->stats.total_dispatch_latency += now - last_poll;
+    if (now - last_poll > reactor->stats.max_dispatch_latency) {
+      reactor->stats.max_dispatch_latency = now - last_poll;
+    }
 
-    errno = MPI_Allgatherv(sendbuf, sendcount, sendtype,
-			   recvbuf, recvcounts, displs, recvtype, comm);
+    reactor->completed[i].callback(&(reactor->statuses[i]), reactor->completed[i].user_data);
 
   }
 
-  return errno;
-  
-}
+  reactor->dispatching = 0;
 
-/* ---------------------------------------------------------------------------------- */
+  for (i = 0; i < reactor->nb_queued; i++) {
+    EEPROBE_Reactor_register(reactor, reactor->queued_requests[i],
+			     reactor->queued_entries[i].callback,
+			     reactor->queued_entries[i].user_data);
+  }
+  reactor->nb_queued = 0;
 
-int
-EEPROBE_Barrier(MPI_Comm comm) {
+  return errno;
 
-  return EEPROBE_Barrier_Switch(comm, EEPROBE_ENABLE);
-  
 }
 
 int
-EEPROBE_Barrier_Switch(MPI_Comm comm, EEPROBE_Enable enable) {
-
-  MPI_Request request;
+EEPROBE_Reactor_run(EEPROBE_Reactor * reactor) {
 
-  MPI_Status status;
-  
   int errno = MPI_SUCCESS;
 
-  if (enable == EEPROBE_ENABLE) {
+  assert(reactor);
 
-    errno = MPI_Ibarrier(comm, &request);
+  reactor->stop = 0;
 
-    errno = EEPROBE_Wait_Core(&request, &status, enable, EEPROBE_BARRIER);
+  while ((reactor->stop == 0) && (reactor->nb_request > 0) && (errno == MPI_SUCCESS)) {
+    errno = EEPROBE_Reactor_run_once(reactor);
+  }
 
-  } else {
+  return errno;
 
-    errno = MPI_Barrier(comm);
+}
 
-  }
+void
+EEPROBE_Reactor_stop(EEPROBE_Reactor * reactor) {
+  assert(reactor);
+  reactor->stop = 1;
+}
 
-  return errno;
-  
+int
+EEPROBE_Reactor_pending(const EEPROBE_Reactor * reactor) {
+  assert(reactor);
+  return reactor->nb_request + reactor->nb_queued;
 }
 
 
@@ -32,18 +32,74 @@ extern "C" {
 /* ---------------------------------------------------------------------------------- */
 
   /**
-   * Enum type used to enable or disable the micro-sleep mechanism.
+   * Enum type used to enable or disable the micro-sleep mechanism. With
+   * EEPROBE_AUTO, the _Switch wait functions choose per call site between the
+   * micro-sleep and the plain MPI routine from the observed wait durations (see
+   * EEPROBE_setAutoThreshold). Collectives then always start the nonblocking
+   * operation, as it does not match the blocking one on other ranks, and
+   * either sleep or call MPI_Wait.
    */
-typedef enum {EEPROBE_ENABLE, EEPROBE_DISABLE} EEPROBE_Enable;
+typedef enum {EEPROBE_ENABLE, EEPROBE_DISABLE, EEPROBE_AUTO} EEPROBE_Enable;
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Enum type used to identify the MPI action.
+   */
+typedef enum {
+	      EEPROBE_PROBE,
+	      EEPROBE_WAIT,
+	      EEPROBE_RECV,
+	      EEPROBE_REDUCE,
+	      EEPROBE_ALLREDUCE,
+	      EEPROBE_ALLTOALL,
+	      EEPROBE_ALLTOALLV,
+	      EEPROBE_ALLTOALLW,
+	      EEPROBE_BCAST,
+	      EEPROBE_SCATTER,
+	      EEPROBE_SCATTERV,
+	      EEPROBE_GATHER,
+	      EEPROBE_GATHERV,
+	      EEPROBE_ALLGATHER,
+	      EEPROBE_ALLGATHERV,
+	      EEPROBE_BARRIER,
+	      EEPROBE_SCHEDULER,
+	      EEPROBE_REACTOR,
+	      EEPROBE_SEND,
+	      EEPROBE_SSEND,
+	      EEPROBE_RSEND,
+	      EEPROBE_FILE_READ,
+	      EEPROBE_FILE_WRITE,
+	      EEPROBE_FILE_READ_AT,
+	      EEPROBE_FILE_WRITE_AT,
+	      EEPROBE_FILE_READ_ALL,
+	      EEPROBE_FILE_WRITE_ALL,
+	      EEPROBE_FILE_READ_AT_ALL,
+	      EEPROBE_FILE_WRITE_AT_ALL,
+	      EEPROBE_FILE_READ_SHARED,
+	      EEPROBE_FILE_WRITE_SHARED,
+	      EEPROBE_FILE_READ_ORDERED,
+	      EEPROBE_FILE_WRITE_ORDERED,
+	      EEPROBE_RPUT,
+	      EEPROBE_RGET,
+	      EEPROBE_RACCUMULATE,
+	      EEPROBE_WIN_FENCE,
+	      EEPROBE_WIN_WAIT,
+	      EEPROBE_WIN_FLAG,
+	      EEPROBE_PARRIVED,
+	      EEPROBE_NB_ACTION
+} EEPROBE_ACTION;
 
 /* ---------------------------------------------------------------------------------- */
 
   /**
    * Calculate the total amount of sleep duration since the beginning if set to 1.
-   * Use EEPROBE_getTotalSleepTime() to read this value.
-   * Set to 0 to disable.
+   * Use EEPROBE_getTotalSleepTime() or EEPROBE_getStats() to read this value.
+   * Set to 0 to disable, in this file or with -DEEPROBE_ENABLE_TOTAL_SLEEP_TIME=0.
    */
+#ifndef EEPROBE_ENABLE_TOTAL_SLEEP_TIME
 #define EEPROBE_ENABLE_TOTAL_SLEEP_TIME 1
+#endif
 
 /* ---------------------------------------------------------------------------------- */
 
@@ -67,6 +123,40 @@ EEPROBE_Probe_Switch(int source, int tag, MPI_Comm comm, MPI_Status * status,
 		     EEPROBE_Enable enable);
 
 
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Message pattern matched by EEPROBE_Probe_any.
+   */
+typedef struct {
+  int source;
+  int tag;
+  MPI_Comm comm;
+} EEPROBE_Pattern;
+
+  /**
+   * EEPROBE_Probe_any waits for a message matching any of several
+   * (source, tag, comm) patterns, for instance on a control and a data
+   * communicator. All patterns are polled at each iteration under a single
+   * micro-sleep schedule. Patterns are polled in array order, unless hit counts
+   * are given: patterns are then polled by decreasing recent hit rate, so that
+   * the most frequent pattern is checked first.
+   *
+   * @param patterns Array of patterns.
+   * @param n Number of patterns.
+   * @param hits Array of n decayed hit counts, updated on return, or NULL to poll
+   * in array order. Initialize to 0 and keep it across calls (Switch only).
+   * @param index Index of the matching pattern.
+   * @param status Status object (status).
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Probe_any(const EEPROBE_Pattern * patterns, int n, int * index, MPI_Status * status);
+int
+EEPROBE_Probe_any_Switch(const EEPROBE_Pattern * patterns, int n, unsigned long * hits,
+			 int * index, MPI_Status * status, EEPROBE_Enable enable);
+
 /* ---------------------------------------------------------------------------------- */
 
   /**
@@ -111,6 +201,78 @@ EEPROBE_Recv_Switch(void *buf, int count, MPI_Datatype datatype,
 		    int source, int tag, MPI_Comm comm, MPI_Status *status,
 		    EEPROBE_Enable enable);
 
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * EEPROBE_Send takes the same parameters
+   * as the default MPI Send function and a specific parameter to enable or disable
+   * the micro-sleeping mechanism. This function is synchronous and performs a
+   * standard-mode blocking send.
+   *
+   * @param buf Initial address of send buffer.
+   * @param count Number of elements in send buffer.
+   * @param datatype Datatype of each send buffer element.
+   * @param dest Rank of destination.
+   * @param tag Message tag.
+   * @param comm Communicator (handle).
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Send(const void *buf, int count, MPI_Datatype datatype,
+	     int dest, int tag, MPI_Comm comm);
+int
+EEPROBE_Send_Switch(const void *buf, int count, MPI_Datatype datatype,
+		    int dest, int tag, MPI_Comm comm, EEPROBE_Enable enable);
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * EEPROBE_Ssend takes the same parameters
+   * as the default MPI Ssend function and a specific parameter to enable or disable
+   * the micro-sleeping mechanism. This function is synchronous and performs a
+   * synchronous-mode blocking send, completing once the receive has started.
+   *
+   * @param buf Initial address of send buffer.
+   * @param count Number of elements in send buffer.
+   * @param datatype Datatype of each send buffer element.
+   * @param dest Rank of destination.
+   * @param tag Message tag.
+   * @param comm Communicator (handle).
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Ssend(const void *buf, int count, MPI_Datatype datatype,
+	      int dest, int tag, MPI_Comm comm);
+int
+EEPROBE_Ssend_Switch(const void *buf, int count, MPI_Datatype datatype,
+		     int dest, int tag, MPI_Comm comm, EEPROBE_Enable enable);
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * EEPROBE_Rsend takes the same parameters
+   * as the default MPI Rsend function and a specific parameter to enable or disable
+   * the micro-sleeping mechanism. This function is synchronous and performs a
+   * ready-mode blocking send.
+   *
+   * @param buf Initial address of send buffer.
+   * @param count Number of elements in send buffer.
+   * @param datatype Datatype of each send buffer element.
+   * @param dest Rank of destination.
+   * @param tag Message tag.
+   * @param comm Communicator (handle).
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Rsend(const void *buf, int count, MPI_Datatype datatype,
+	      int dest, int tag, MPI_Comm comm);
+int
+EEPROBE_Rsend_Switch(const void *buf, int count, MPI_Datatype datatype,
+		     int dest, int tag, MPI_Comm comm, EEPROBE_Enable enable);
+
 /* ---------------------------------------------------------------------------------- */
   
 int
@@ -259,6 +421,511 @@ int
 EEPROBE_Barrier_Switch(MPI_Comm comm, EEPROBE_Enable enable);
 
 
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * MPI-IO wrappers. EEPROBE_File_read, EEPROBE_File_write and their _at, _all,
+   * _at_all and _shared variants take the same parameters as the default MPI
+   * functions and a specific parameter to enable or disable the micro-sleeping
+   * mechanism. They start the nonblocking MPI_File_i* variant and wait for it,
+   * so that ranks with little data do not busy-wait for the aggregators. MPI
+   * has no nonblocking ordered operation: the _ordered variants gather the
+   * sizes with MPI_Iallgather, access the file with MPI_File_i*_at_all at the
+   * offsets the ordered routine would use, then move the shared file pointer
+   * with MPI_File_seek_shared. This requires the group of the file to be the
+   * one of MPI_COMM_WORLD or MPI_COMM_SELF, and the file not to be opened with
+   * MPI_MODE_SEQUENTIAL. Otherwise they call the blocking routine and only
+   * account the bytes moved. Each wrapper has its own action
+   * (EEPROBE_FILE_READ, EEPROBE_FILE_WRITE_AT_ALL...).
+   *
+   * @param fh File handle.
+   * @param offset File offset (_at only).
+   * @param buf Initial address of buffer.
+   * @param count Number of elements in buffer.
+   * @param datatype Datatype of each buffer element.
+   * @param status Status object.
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_File_read(MPI_File fh, void *buf, int count,
+		  MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_read_Switch(MPI_File fh, void *buf, int count,
+			 MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_read_at(MPI_File fh, MPI_Offset offset, void *buf, int count,
+		     MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_read_at_Switch(MPI_File fh, MPI_Offset offset, void *buf, int count,
+			    MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_read_all(MPI_File fh, void *buf, int count,
+		      MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_read_all_Switch(MPI_File fh, void *buf, int count,
+			     MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_read_at_all(MPI_File fh, MPI_Offset offset, void *buf, int count,
+			 MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_read_at_all_Switch(MPI_File fh, MPI_Offset offset, void *buf, int count,
+				MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_read_shared(MPI_File fh, void *buf, int count,
+			 MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_read_shared_Switch(MPI_File fh, void *buf, int count,
+				MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_read_ordered(MPI_File fh, void *buf, int count,
+			  MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_read_ordered_Switch(MPI_File fh, void *buf, int count,
+				 MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_write(MPI_File fh, const void *buf, int count,
+		   MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_write_Switch(MPI_File fh, const void *buf, int count,
+			  MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_write_at(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+		      MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_write_at_Switch(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+			     MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_write_all(MPI_File fh, const void *buf, int count,
+		       MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_write_all_Switch(MPI_File fh, const void *buf, int count,
+			      MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_write_at_all(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+			  MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_write_at_all_Switch(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+				 MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_write_shared(MPI_File fh, const void *buf, int count,
+			  MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_write_shared_Switch(MPI_File fh, const void *buf, int count,
+				 MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+int
+EEPROBE_File_write_ordered(MPI_File fh, const void *buf, int count,
+			   MPI_Datatype datatype, MPI_Status *status);
+int
+EEPROBE_File_write_ordered_Switch(MPI_File fh, const void *buf, int count,
+				  MPI_Datatype datatype, MPI_Status *status, EEPROBE_Enable enable);
+
+  /**
+   * Returns the bytes moved by an MPI-IO action since the beginning of the run.
+   * @param action MPI-IO action (EEPROBE_FILE_READ...).
+   * @return Number of bytes.
+   */
+unsigned long EEPROBE_getFileBytes(EEPROBE_ACTION action);
+
+  /**
+   * Returns the bytes moved by an MPI-IO action per second of sleep time of
+   * this action, 0 when it never slept.
+   * @param action MPI-IO action (EEPROBE_FILE_READ...).
+   * @return Bytes per second of sleep.
+   */
+double EEPROBE_getFileBytesPerSleep(EEPROBE_ACTION action);
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * EEPROBE_Rput, EEPROBE_Rget and EEPROBE_Raccumulate take the same parameters
+   * as the MPI request-based RMA operations, without the request, and a
+   * specific parameter to enable or disable the micro-sleeping mechanism. They
+   * start the operation and wait for its local completion: the origin buffer
+   * can be reused, or holds the data read. As MPI_Rput, they are only valid in
+   * a passive target epoch (MPI_Win_lock or MPI_Win_lock_all). Waiting for all
+   * of them replaces a MPI_Win_flush_local, and the remote completion still
+   * requires a flush.
+   *
+   * @param origin_addr Initial address of origin buffer.
+   * @param origin_count Number of entries in origin buffer.
+   * @param origin_datatype Datatype of each entry in origin buffer.
+   * @param target_rank Rank of target.
+   * @param target_disp Displacement from window start to the beginning of the
+   * target buffer.
+   * @param target_count Number of entries in target buffer.
+   * @param target_datatype Datatype of each entry in target buffer.
+   * @param op Reduce operation (Raccumulate only).
+   * @param win Window object.
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Rput(const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+	     int target_rank, MPI_Aint target_disp, int target_count,
+	     MPI_Datatype target_datatype, MPI_Win win);
+int
+EEPROBE_Rput_Switch(const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+		    int target_rank, MPI_Aint target_disp, int target_count,
+		    MPI_Datatype target_datatype, MPI_Win win, EEPROBE_Enable enable);
+
+int
+EEPROBE_Rget(void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+	     int target_rank, MPI_Aint target_disp, int target_count,
+	     MPI_Datatype target_datatype, MPI_Win win);
+int
+EEPROBE_Rget_Switch(void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+		    int target_rank, MPI_Aint target_disp, int target_count,
+		    MPI_Datatype target_datatype, MPI_Win win, EEPROBE_Enable enable);
+
+int
+EEPROBE_Raccumulate(const void *origin_addr, int origin_count, MPI_Datatype origin_datatype,
+		    int target_rank, MPI_Aint target_disp, int target_count,
+		    MPI_Datatype target_datatype, MPI_Op op, MPI_Win win);
+int
+EEPROBE_Raccumulate_Switch(const void *origin_addr, int origin_count,
+			   MPI_Datatype origin_datatype, int target_rank,
+			   MPI_Aint target_disp, int target_count,
+			   MPI_Datatype target_datatype, MPI_Op op, MPI_Win win,
+			   EEPROBE_Enable enable);
+
+  /**
+   * EEPROBE_Win_fence takes the same parameters as the default MPI Win_fence
+   * function. MPI has no nonblocking fence: a nonblocking barrier over the
+   * group of the window is waited for with the micro-sleep, then the fence is
+   * called once all processes arrived. The communicator of the barrier is
+   * created from MPI_COMM_WORLD at the first call and freed with the window.
+   * Windows whose group is not a subset of MPI_COMM_WORLD, such as windows
+   * over processes added with MPI_Comm_spawn or MPI_Comm_connect, get the
+   * plain MPI_Win_fence without the micro-sleep.
+   *
+   * @param assert Program assertion.
+   * @param win Window object.
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Win_fence(int assert, MPI_Win win);
+int
+EEPROBE_Win_fence_Switch(int assert, MPI_Win win, EEPROBE_Enable enable);
+
+  /**
+   * EEPROBE_Win_wait takes the same parameters as the default MPI Win_wait
+   * function. It completes the exposure epoch started by MPI_Win_post, testing
+   * it with MPI_Win_test and sleeping in between. MPI has no test for the
+   * access epoch of MPI_Win_start and MPI_Win_complete, which are not wrapped.
+   *
+   * @param win Window object.
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Win_wait(MPI_Win win);
+int
+EEPROBE_Win_wait_Switch(MPI_Win win, EEPROBE_Enable enable);
+
+  /**
+   * Wait until a flag located in the local memory of a window holds a value,
+   * written by another process with MPI_Put or MPI_Accumulate. The window
+   * memory is synchronized with MPI_Win_sync before each read, so the calling
+   * process must be in a passive target epoch on the window (MPI_Win_lock_all).
+   *
+   * @param flag Address of the flag in the local window memory.
+   * @param value Value to wait for.
+   * @param win Window object.
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Win_wait_flag(const volatile int *flag, int value, MPI_Win win);
+int
+EEPROBE_Win_wait_flag_Switch(const volatile int *flag, int value, MPI_Win win,
+			     EEPROBE_Enable enable);
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Doorbell counters of the calling process: rings sent, futex wake-ups sent,
+   * waits on its own doorbell and waits that ended on the timeout.
+   */
+typedef struct {
+  unsigned long nb_ring;
+  unsigned long nb_wake;
+  unsigned long nb_wait;
+  unsigned long nb_timeout;
+} EEPROBE_DoorbellStats;
+
+  /**
+   * Set up a doorbell for each process of comm in memory shared by the
+   * processes of a node (MPI_COMM_TYPE_SHARED). Collective over comm.
+   * Afterwards, EEPROBE_Send, EEPROBE_Ssend and EEPROBE_Rsend on comm ring the
+   * doorbell of an on-node destination once the message is posted, and
+   * EEPROBE_Probe and EEPROBE_Recv on comm block on their doorbell with a
+   * futex instead of sleeping on a timer when the source is on the node, or is
+   * MPI_ANY_SOURCE and the whole communicator is on the node. Messages sent
+   * without the EEPROBE_ send functions do not ring: the timeout bounds how
+   * late they are detected. The latency target and wake-up grid do not apply
+   * to doorbell waits. The PMPI layer calls this function on MPI_COMM_WORLD in
+   * MPI_Init when the EEPROBE_DOORBELL environment variable is set to the
+   * timeout.
+   * @param comm Communicator of the point-to-point operations.
+   * @param timeout Longest doorbell wait in nanoseconds, must be set within
+   * range ]0;1000000000[
+   * @return MPI routine error value.
+   */
+int EEPROBE_Doorbell_init(MPI_Comm comm, long timeout);
+
+  /**
+   * Release the doorbells. Collective over the communicator given to
+   * EEPROBE_Doorbell_init, must be called before MPI_Finalize.
+   * @return MPI routine error value.
+   */
+int EEPROBE_Doorbell_free();
+
+  /**
+   * Copy the doorbell counters of the calling process.
+   * @param stats Counters.
+   */
+void EEPROBE_getDoorbellStats(EEPROBE_DoorbellStats * stats);
+
+/* ---------------------------------------------------------------------------------- */
+
+#if MPI_VERSION >= 4
+
+  /* experimental: not yet built or run against an MPI 4 library */
+
+  /* number of partitions with their own arrival histogram, higher partitions
+     share the last one */
+#define EEPROBE_PARTITION_MAX 64
+
+  /* histogram buckets are powers of two of the wait duration in nanoseconds */
+#define EEPROBE_PARTITION_NB_BUCKET 32
+
+  /**
+   * Wait until a partition of a started partitioned receive request has
+   * arrived, testing it with MPI_Parrived and sleeping in between. MPI has no
+   * blocking equivalent: when the micro-sleep is disabled, the partition is
+   * busy-polled. The request remains active and is completed as usual with
+   * MPI_Wait or EEPROBE_Wait.
+   *
+   * @param request Partitioned receive request (handle).
+   * @param partition Partition to wait for.
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Parrived_wait(MPI_Request request, int partition);
+int
+EEPROBE_Parrived_wait_Switch(MPI_Request request, int partition, EEPROBE_Enable enable);
+
+  /**
+   * Wait until any of a set of partitions of a partitioned receive request has
+   * arrived. The consumer removes the returned partition from its set before
+   * the next call.
+   *
+   * @param request Partitioned receive request (handle).
+   * @param count Number of partitions in the set.
+   * @param partitions Partitions to wait for.
+   * @param index Index in partitions of the arrived partition, or MPI_UNDEFINED
+   * when count is 0.
+   * @param enable Enable or disable the micro-sleep mechanism (Switch only).
+   * @return MPI routine error value.
+   */
+int
+EEPROBE_Parrived_waitany(MPI_Request request, int count, const int partitions[], int *index);
+int
+EEPROBE_Parrived_waitany_Switch(MPI_Request request, int count, const int partitions[],
+				int *index, EEPROBE_Enable enable);
+
+  /**
+   * Copy the arrival histogram of a partition: bucket i counts the waits that
+   * lasted between 2^i and 2^(i+1) nanoseconds before the partition arrived.
+   * @param partition Partition number.
+   * @param histogram Array of EEPROBE_PARTITION_NB_BUCKET counters.
+   */
+void EEPROBE_getPartitionHistogram(int partition, unsigned long histogram[]);
+
+  /**
+   * Reset the arrival histograms of all partitions.
+   */
+void EEPROBE_resetPartitionHistograms();
+
+#endif
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Callback invoked by a reactor when a registered request completes or
+   * fails. The MPI_ERROR field of the status holds the error of the request.
+   * @param status Status object of the completed request.
+   * @param user_data Pointer given at registration time.
+   */
+typedef void (*EEPROBE_Callback)(MPI_Status * status, void * user_data);
+
+  /**
+   * Per-reactor statistics. Durations are in microseconds, as delivered by
+   * EEPROBE_getTime(). The dispatch latency of a callback is measured from the
+   * last poll that did not see the request completed, which bounds the delay
+   * added by the micro-sleep mechanism.
+   */
+typedef struct {
+  unsigned long nb_dispatch;
+  unsigned long nb_poll;
+  unsigned long total_dispatch_latency;
+  unsigned long max_dispatch_latency;
+  unsigned long idle_time;
+} EEPROBE_ReactorStats;
+
+typedef struct {
+  EEPROBE_Callback callback;
+  void * user_data;
+} EEPROBE_ReactorEntry;
+
+  /**
+   * Completion reactor. Registered requests are kept in flat arrays and tested
+   * in a batch with MPI_Testsome. Callbacks of the completed requests are
+   * dispatched and the micro-sleep is applied only when nothing completed.
+   * Requests registered by a callback are queued and appended to the arrays
+   * once the whole batch is dispatched.
+   * Fields are managed by the EEPROBE_Reactor_* functions.
+   */
+typedef struct {
+  int nb_request;
+  int capacity;
+  MPI_Request * requests;
+  EEPROBE_ReactorEntry * entries;
+  EEPROBE_ReactorEntry * completed;
+  int * indices;
+  MPI_Status * statuses;
+  int nb_queued;
+  int queued_capacity;
+  MPI_Request * queued_requests;
+  EEPROBE_ReactorEntry * queued_entries;
+  int dispatching;
+  EEPROBE_Enable enable;
+  int stop;
+  EEPROBE_ReactorStats stats;
+} EEPROBE_Reactor;
+
+  /**
+   * Initialize an empty reactor.
+   * @param reactor Reactor.
+   * @param enable Enable or disable the micro-sleep mechanism. When disabled,
+   * the reactor busy-polls its registered requests.
+   */
+void EEPROBE_Reactor_init(EEPROBE_Reactor * reactor, EEPROBE_Enable enable);
+
+  /**
+   * Release the memory held by a reactor. Registered requests are not freed.
+   * @param reactor Reactor.
+   */
+void EEPROBE_Reactor_free(EEPROBE_Reactor * reactor);
+
+  /**
+   * Register a request. It can be called from a callback, for instance to post
+   * the next receive from the same peer: the request is then queued and only
+   * tested from the next EEPROBE_Reactor_run_once(). A callback may cancel a
+   * registered request with MPI_Cancel, its callback is then dispatched with
+   * the cancelled status. Callbacks must not call EEPROBE_Reactor_run_once(),
+   * EEPROBE_Reactor_run() or EEPROBE_Reactor_free() on their own reactor.
+   * @param reactor Reactor.
+   * @param request Active request handle, owned by the reactor until completion.
+   * @param callback Function invoked on completion.
+   * @param user_data Pointer passed to the callback.
+   */
+void EEPROBE_Reactor_register(EEPROBE_Reactor * reactor, MPI_Request request,
+			      EEPROBE_Callback callback, void * user_data);
+
+  /**
+   * Wait until at least one registered request completes and dispatch the
+   * callbacks of all completed requests. Returns immediately if no request is
+   * registered. A request that fails is dispatched with the error in the
+   * MPI_ERROR field of its status, the other requests stay registered.
+   * @param reactor Reactor.
+   * @return MPI routine error value.
+   */
+int EEPROBE_Reactor_run_once(EEPROBE_Reactor * reactor);
+
+  /**
+   * Dispatch callbacks until no request is registered anymore or until
+   * EEPROBE_Reactor_stop() is called from a callback.
+   * @param reactor Reactor.
+   * @return MPI routine error value.
+   */
+int EEPROBE_Reactor_run(EEPROBE_Reactor * reactor);
+
+  /**
+   * Make EEPROBE_Reactor_run() return after the current dispatch.
+   * @param reactor Reactor.
+   */
+void EEPROBE_Reactor_stop(EEPROBE_Reactor * reactor);
+
+  /**
+   * Returns the number of requests currently registered.
+   * @param reactor Reactor.
+   * @return Number of registered requests.
+   */
+int EEPROBE_Reactor_pending(const EEPROBE_Reactor * reactor);
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Backoff state of the micro-sleep mechanism. EEPROBE_Probe and EEPROBE_Wait
+   * use it internally. It is exposed for callers running their own polling loop,
+   * for instance to test many requests at once, so that they can apply the same
+   * adaptive sleep between two unsuccessful polls.
+   */
+typedef enum {
+	      EEPROBE_PREDICTION_NONE,
+	      EEPROBE_PREDICTION_PENDING,
+	      EEPROBE_PREDICTION_AWAKE,
+	      EEPROBE_PREDICTION_DENSE
+} EEPROBE_Prediction;
+
+typedef struct {
+  long current_yield_time;
+  EEPROBE_Prediction prediction;
+  unsigned long wake_time;
+  unsigned long dense_until;
+  unsigned long last_delay;
+  EEPROBE_ACTION last_action;
+  long progress_yield_time;
+  unsigned long nb_poll;
+} EEPROBE_Backoff;
+
+  /**
+   * Initialize the backoff state to the current minimum yield time.
+   * @param backoff Backoff state.
+   */
+void EEPROBE_Backoff_init(EEPROBE_Backoff * backoff);
+
+  /**
+   * Sleep for the current yield time, then increment it by the incremental step
+   * up to the maximum yield time. Call this after each unsuccessful poll.
+   * @param backoff Backoff state.
+   * @param action MPI action the sleep duration is accounted to.
+   */
+void EEPROBE_Backoff_yield(EEPROBE_Backoff * backoff, EEPROBE_ACTION action);
+
+  /**
+   * Record the current yield time as the last yield time and restart from the
+   * minimum yield time. Call this after a successful poll.
+   * @param backoff Backoff state.
+   */
+void EEPROBE_Backoff_reset(EEPROBE_Backoff * backoff);
+
 /* ---------------------------------------------------------------------------------- */
 
   /**
@@ -279,6 +946,402 @@ void EEPROBE_setMaxYieldTime(long max_yield_time);
    */
 void EEPROBE_setIncYieldTime(long inc_yield_time);
 
+  /**
+   * Ramp of the yield time between two unsuccessful polls. LINEAR adds the
+   * incremental step, EXPONENTIAL doubles the yield time (adding at least the
+   * incremental step), CONSTANT keeps the minimum yield time and SPIN never
+   * sleeps.
+   */
+typedef enum {
+	      EEPROBE_POLICY_LINEAR,
+	      EEPROBE_POLICY_EXPONENTIAL,
+	      EEPROBE_POLICY_CONSTANT,
+	      EEPROBE_POLICY_SPIN
+} EEPROBE_Policy;
+
+typedef struct {
+  long min_yield_time;
+  long inc_yield_time;
+  long max_yield_time;
+  EEPROBE_Policy policy;
+} EEPROBE_ActionParams;
+
+  /**
+   * Set the yield times and the ramp policy of one action, overriding the
+   * global settings, for instance long sleeps for barriers and short ones for
+   * receives in an inner solver. Overrides can also be given with the
+   * EEPROBE_<ACTION>_PARAMS environment variables as min:inc:max[:policy], for
+   * instance EEPROBE_BARRIER_PARAMS=1000:100000:10000000:exponential.
+   * @param action MPI action.
+   * @param min_yield_time In nanoseconds, must be set within range [0;1000000000[
+   * @param inc_yield_time In nanoseconds, must be set within range ]0;1000000000[
+   * @param max_yield_time In nanoseconds, must be set within range [min_yield_time;1000000000[
+   * @param policy Ramp policy.
+   */
+void EEPROBE_setActionParams(EEPROBE_ACTION action, long min_yield_time, long inc_yield_time,
+			     long max_yield_time, EEPROBE_Policy policy);
+
+  /**
+   * Remove the override of an action, which follows the global settings again.
+   * @param action MPI action.
+   */
+void EEPROBE_resetActionParams(EEPROBE_ACTION action);
+
+  /**
+   * Returns the parameters in use for an action: its override if any, the
+   * global settings with the LINEAR policy otherwise.
+   * @param action MPI action.
+   * @param params Filled with the parameters.
+   */
+void EEPROBE_getActionParams(EEPROBE_ACTION action, EEPROBE_ActionParams * params);
+
+  /**
+   * Set the progress schedule of large operations. Most MPI libraries progress
+   * rendezvous transfers only when the rank calls into MPI, so long sleeps
+   * stall large transfers. Operations moving at least threshold bytes (count
+   * times datatype size, summed over the ranks for collectives) poll with
+   * sleeps of at most yield_time while in flight, 0 meaning no sleep at all.
+   * EEPROBE_Recv of a large message first waits for its envelope with
+   * MPI_Improbe and the usual schedule, as no data moves before the sender
+   * starts. The other operations cannot tell the wait for the peer from the
+   * transfer, and use the short sleeps for the whole wait. Disabled by default
+   * (threshold 0, yield time 10000 ns), also set with the EEPROBE_PROGRESS
+   * environment variable given as bytes:ns, for instance 1048576:10000.
+   * @param threshold In bytes, 0 disables the progress schedule.
+   * @param yield_time In nanoseconds, must be set within range [0;1000000000[
+   */
+void EEPROBE_setProgressParams(long threshold, long yield_time);
+
+  /**
+   * Returns the current progress parameters.
+   * @param threshold Filled with the threshold in bytes.
+   * @param yield_time Filled with the yield time in nanoseconds.
+   */
+void EEPROBE_getProgressParams(long * threshold, long * yield_time);
+
+  /**
+   * Function run by the micro-sleep mechanism instead of sleeping, to overlap
+   * deferrable work (compression, diagnostics...) with MPI waits. It must not
+   * run longer than the given budget and returns how long it actually ran, or 0
+   * if it had nothing to do. The reported duration is deducted from the yield
+   * time, the remaining time is slept.
+   * @param ctx Pointer given to EEPROBE_setIdleCallback().
+   * @param budget Maximum run duration in nanoseconds.
+   * @return Run duration in nanoseconds.
+   */
+typedef long (*EEPROBE_IdleCallback)(void * ctx, long budget);
+
+  /**
+   * Set the idle callback. It is not called recursively when it waits on MPI
+   * itself.
+   * @param callback Idle callback, NULL to disable.
+   * @param ctx Pointer passed to the callback.
+   * @param budget Maximum run duration per call in nanoseconds, must be >= 0.
+   */
+void EEPROBE_setIdleCallback(EEPROBE_IdleCallback callback, void * ctx, long budget);
+
+  /**
+   * Set the yield time above which the idle callback is called instead of
+   * sleeping. Defaults to 0, the callback is called after each unsuccessful poll.
+   * @param threshold In nanoseconds, must be >= 0.
+   */
+void EEPROBE_setIdleThreshold(long threshold);
+
+  /**
+   * Returns the current idle callback threshold.
+   * @return Idle callback threshold in nanoseconds.
+   */
+long EEPROBE_getIdleThreshold();
+
+  /**
+   * Returns the total run duration reported by the idle callback since the
+   * beginning of the run.
+   * @return Total idle callback duration in nanoseconds.
+   */
+unsigned long EEPROBE_getTotalIdleCallbackTime();
+
+  /**
+   * Enum type used to select the primitive the micro-sleep mechanism idles with.
+   * EEPROBE_IDLE_NANOSLEEP: relative clock_nanosleep (default).
+   * EEPROBE_IDLE_NANOSLEEP_ABS: clock_nanosleep to an absolute TIMER_ABSTIME deadline.
+   * EEPROBE_IDLE_YIELD: a single sched_yield, regardless of the yield time.
+   * EEPROBE_IDLE_TIMERFD: one-shot timerfd waited for with epoll_wait.
+   * EEPROBE_IDLE_TPAUSE: x86 WAITPKG tpause in the light C0.1 state.
+   * EEPROBE_IDLE_AUTO: tpause, or sched_yield if not available, below the auto
+   * sleep time set with EEPROBE_setIdleAutoSleepTime(), clock_nanosleep with an
+   * absolute deadline above.
+   * Primitives not available on the machine fall back to EEPROBE_IDLE_NANOSLEEP.
+   */
+typedef enum {
+	      EEPROBE_IDLE_NANOSLEEP,
+	      EEPROBE_IDLE_NANOSLEEP_ABS,
+	      EEPROBE_IDLE_YIELD,
+	      EEPROBE_IDLE_TIMERFD,
+	      EEPROBE_IDLE_TPAUSE,
+	      EEPROBE_IDLE_AUTO
+} EEPROBE_IdlePrimitive;
+
+  /**
+   * Set the idle primitive.
+   * @param primitive Idle primitive.
+   */
+void EEPROBE_setIdlePrimitive(EEPROBE_IdlePrimitive primitive);
+
+  /**
+   * Returns the current idle primitive.
+   * @return Idle primitive.
+   */
+EEPROBE_IdlePrimitive EEPROBE_getIdlePrimitive();
+
+  /**
+   * Check at runtime whether an idle primitive is available on this machine
+   * (CPU features, kernel support).
+   * @param primitive Idle primitive.
+   * @return 1 if available, 0 otherwise.
+   */
+int EEPROBE_isIdlePrimitiveAvailable(EEPROBE_IdlePrimitive primitive);
+
+  /**
+   * Set the yield time from which EEPROBE_IDLE_AUTO sleeps instead of
+   * pausing or yielding. Defaults to 50000 ns, the usual kernel timer slack.
+   * @param sleep_time In nanoseconds, must be set within range [0;1000000000[
+   */
+void EEPROBE_setIdleAutoSleepTime(long sleep_time);
+
+  /**
+   * Returns the current auto sleep time.
+   * @return Auto sleep time in nanoseconds.
+   */
+long EEPROBE_getIdleAutoSleepTime();
+
+  /**
+   * Set the timer slack of the calling thread (PR_SET_TIMERSLACK), which bounds
+   * the overshoot of short sleeps. 0 restores the default slack.
+   * @param timer_slack In nanoseconds.
+   * @return 0 on success, -1 on error.
+   */
+int EEPROBE_setTimerSlack(unsigned long timer_slack);
+
+  /**
+   * Returns the timer slack of the calling thread.
+   * @return Timer slack in nanoseconds, -1 on error.
+   */
+long EEPROBE_getTimerSlack();
+
+  /**
+   * Align the wake-ups on a grid (disabled by default, or set with the
+   * EEPROBE_WAKEUP_GRID environment variable given as grid:threshold). Sleeps
+   * of at least the threshold end on the next multiple of the grid of
+   * CLOCK_MONOTONIC, with clock_nanosleep and TIMER_ABSTIME, instead of using
+   * the idle primitive. The clock is shared by the processes of a node, so
+   * idle ranks wake up in bursts and the node can stay in deep idle states
+   * between bursts. Under a latency target, the deadline is rounded down
+   * instead when rounding up would exceed the target.
+   * @param grid In nanoseconds, within range [0;1000000000[, 0 disables the grid.
+   * @param threshold Shortest sleep aligned on the grid, in nanoseconds.
+   */
+void EEPROBE_setWakeupGrid(long grid, long threshold);
+
+  /**
+   * Returns the current wake-up grid.
+   * @param grid Filled with the grid in nanoseconds, 0 when disabled.
+   * @param threshold Filled with the threshold in nanoseconds.
+   */
+void EEPROBE_getWakeupGrid(long * grid, long * threshold);
+
+  /**
+   * Number of sleep durations measured by EEPROBE_Calibrate().
+   */
+#define EEPROBE_CALIBRATION_NB_SLEEP 7
+
+  /**
+   * Machine measurements taken by EEPROBE_Calibrate() and the yield times derived
+   * from them. All durations are in nanoseconds.
+   */
+typedef struct {
+  long timer_cost;
+  long iprobe_cost_self;
+  long iprobe_cost_world;
+  long test_cost;
+  long sleep_requested[EEPROBE_CALIBRATION_NB_SLEEP];
+  long sleep_measured[EEPROBE_CALIBRATION_NB_SLEEP];
+  long sleep_overshoot;
+  long min_yield_time;
+  long inc_yield_time;
+  long max_yield_time;
+} EEPROBE_Calibration;
+
+  /**
+   * Measure the timer read cost, the MPI_Iprobe and MPI_Test costs and the
+   * actual duration of sleeps from 1 ns to 1 ms with the current idle primitive,
+   * then set the minimum, incremental and maximum yield times accordingly.
+   * MPI must be initialized. Calibration also runs at first use when the
+   * EEPROBE_CALIBRATE environment variable is set to 1, the cache file being
+   * given by EEPROBE_CALIBRATION_FILE. First uses before MPI_Init defer it to
+   * the first wait, and the yield times set in the meantime are kept.
+   * @param cache_path File the measurements are read from if it exists and was
+   * written on the same host, and written to otherwise. NULL to always measure.
+   * @return MPI routine error value.
+   */
+int EEPROBE_Calibrate(const char * cache_path);
+
+  /**
+   * Returns the last calibration.
+   * @param calibration Filled with the last calibration.
+   * @return 1 if EEPROBE_Calibrate() succeeded, 0 otherwise.
+   */
+int EEPROBE_getCalibration(EEPROBE_Calibration * calibration);
+
+  /**
+   * Print the last calibration and the derived yield times on stdout.
+   */
+void EEPROBE_printCalibration();
+
+  /**
+   * Predictor statistics. A prediction is a hit when the message arrives
+   * within the prediction window, an early miss when it arrives before the end
+   * of the long sleep and a late miss when it arrives after the window.
+   */
+typedef struct {
+  unsigned long nb_prediction;
+  unsigned long nb_hit;
+  unsigned long nb_miss_early;
+  unsigned long nb_miss_late;
+} EEPROBE_PredictorStats;
+
+  /**
+   * Enable or disable the predictor (disabled by default, or enabled by setting
+   * the EEPROBE_PREDICTOR environment variable to 1). The predictor tracks the
+   * inter-arrival time of each (comm, source, tag) channel and of each
+   * collective on each communicator. Once the traffic of a channel is periodic,
+   * waits sleep in a single interval up to shortly before the predicted arrival,
+   * then poll at the minimum yield time until the end of the prediction window,
+   * then fall back to the usual ramp.
+   * @param enable Enable or disable the predictor.
+   */
+void EEPROBE_setPredictor(EEPROBE_Enable enable);
+
+  /**
+   * Returns whether the predictor is enabled.
+   * @return EEPROBE_ENABLE or EEPROBE_DISABLE.
+   */
+EEPROBE_Enable EEPROBE_getPredictor();
+
+  /**
+   * Set the minimum half-width of the prediction window. The window is widened
+   * to twice the inter-arrival jitter when larger. Defaults to 100000 ns.
+   * @param guard_time In nanoseconds, must be set within range [0;1000000000[
+   */
+void EEPROBE_setPredictorGuardTime(long guard_time);
+
+  /**
+   * Returns the current predictor guard time.
+   * @return Guard time in nanoseconds.
+   */
+long EEPROBE_getPredictorGuardTime();
+
+  /**
+   * Returns the predictor statistics since the beginning of the run.
+   * @param stats Filled with the statistics.
+   */
+void EEPROBE_getPredictorStats(EEPROBE_PredictorStats * stats);
+
+  /**
+   * Enable or disable warm start (disabled by default, or enabled by setting the
+   * EEPROBE_WARM_START environment variable to 1). The yield time reached at
+   * the end of the waits is kept per (comm, source, tag) channel and per
+   * collective on each communicator, and the next wait on the same channel
+   * starts from half of it instead of the minimum yield time. Channels are kept
+   * in a fixed-size table, the least recently used ones being evicted.
+   * @param enable Enable or disable warm start.
+   */
+void EEPROBE_setWarmStart(EEPROBE_Enable enable);
+
+  /**
+   * Returns whether warm start is enabled.
+   * @return EEPROBE_ENABLE or EEPROBE_DISABLE.
+   */
+EEPROBE_Enable EEPROBE_getWarmStart();
+
+  /**
+   * Set the wait duration above which sleeping is cheaper than spinning for the
+   * EEPROBE_AUTO mode. Each call site, identified by its return address or by
+   * EEPROBE_setCallSite, keeps a decayed histogram of its wait durations,
+   * sampled on one wait in 8 after the first 16. A site
+   * switches to the micro-sleep when 60% of its waits last longer than the
+   * threshold, and back to the plain MPI routine below 40%. Defaults to
+   * 100000 ns.
+   * @param threshold In nanoseconds, must be set within range [0;1000000000[
+   */
+void EEPROBE_setAutoThreshold(long threshold);
+
+  /**
+   * Returns the current EEPROBE_AUTO threshold.
+   * @return Threshold in nanoseconds.
+   */
+long EEPROBE_getAutoThreshold();
+
+  /**
+   * Identify the call site of the next EEPROBE_AUTO wait by an explicit ID
+   * instead of its return address, for instance when the wait is called from a
+   * wrapper shared by several sites.
+   * @param id Site ID, must not be 0.
+   */
+void EEPROBE_setCallSite(unsigned long id);
+
+  /**
+   * Print the EEPROBE_AUTO decision of each call site on stdout: site address or
+   * ID, action, number of samples, fraction of long waits, current mode and
+   * number of mode switches.
+   */
+void EEPROBE_printCallSites();
+
+  /**
+   * Latency statistics of an action under a latency target. Only waits that
+   * slept at least once are counted. A violation is a wait whose last sleep,
+   * which bounds the detection delay of the completion, exceeded the target.
+   */
+typedef struct {
+  unsigned long nb_wait;
+  unsigned long nb_violation;
+} EEPROBE_LatencyStats;
+
+  /**
+   * Bound the detection delay added by the micro-sleeps (disabled by default,
+   * or set with the EEPROBE_LATENCY_TARGET environment variable given as
+   * percentile:latency, for instance 99:20000). The percentile of the sleep
+   * overshoot is estimated online, and each sleep is shortened so that the
+   * requested duration plus the overshoot stays within the target. This caps
+   * the maximum yield time, and waits busy-poll when even the shortest sleep
+   * would exceed the target. This applies on top of the predictor and of the
+   * idle callback.
+   * @param percentile Percentile of the waits meeting the target, within range ]0;100[
+   * @param latency In nanoseconds, 0 disables the latency target.
+   */
+void EEPROBE_setLatencyTarget(double percentile, unsigned long latency);
+
+  /**
+   * Returns the current latency target.
+   * @param percentile Filled with the percentile.
+   * @param latency Filled with the latency in nanoseconds, 0 when disabled.
+   */
+void EEPROBE_getLatencyTarget(double * percentile, unsigned long * latency);
+
+  /**
+   * Returns the current estimate of the sleep overshoot at the target
+   * percentile.
+   * @return Overshoot in nanoseconds.
+   */
+long EEPROBE_getLatencyOvershoot();
+
+  /**
+   * Returns the latency statistics of an action since the last latency target
+   * was set.
+   * @param action MPI action.
+   * @param stats Filled with the statistics.
+   */
+void EEPROBE_getLatencyStats(EEPROBE_ACTION action, EEPROBE_LatencyStats * stats);
+
   /**
    * Returns the current minimum yield time.
    * @return Current minimum yield time in nanoseconds.
@@ -312,6 +1375,14 @@ long EEPROBE_getLastYieldTime();
    */
 unsigned long EEPROBE_getTotalSleepTime();
 
+  /**
+   * Returns the total sleep duration of an action since the beginning of the run.
+   * EEPROBE_ENABLE_TOTAL_SLEEP_TIME must be set to 1 in this file, returns 0 otherwise.
+   * @param action MPI action.
+   * @return Total sleep duration in nanoseconds.
+   */
+unsigned long EEPROBE_getTotalSleepTimeAction(EEPROBE_ACTION action);
+
   /**
    * Returns the total sleep duration using EEPROBE_Probe since the beginning of the run.
    * EEPROBE_ENABLE_TOTAL_SLEEP_TIME must be set to 1 in this file, returns 0 otherwise.
@@ -354,6 +1425,142 @@ unsigned long EEPROBE_getTotalSleepTimeAllgatherv();
 
 unsigned long EEPROBE_getTotalSleepTimeBarrier();
 
+unsigned long EEPROBE_getTotalSleepTimeScheduler();
+
+unsigned long EEPROBE_getTotalSleepTimeReactor();
+
+unsigned long EEPROBE_getTotalSleepTimeSend();
+
+unsigned long EEPROBE_getTotalSleepTimeSsend();
+
+unsigned long EEPROBE_getTotalSleepTimeRsend();
+
+unsigned long EEPROBE_getTotalSleepTimeFileRead();
+
+unsigned long EEPROBE_getTotalSleepTimeFileWrite();
+
+unsigned long EEPROBE_getTotalSleepTimeFileReadAt();
+
+unsigned long EEPROBE_getTotalSleepTimeFileWriteAt();
+
+unsigned long EEPROBE_getTotalSleepTimeFileReadAll();
+
+unsigned long EEPROBE_getTotalSleepTimeFileWriteAll();
+
+unsigned long EEPROBE_getTotalSleepTimeFileReadAtAll();
+
+unsigned long EEPROBE_getTotalSleepTimeFileWriteAtAll();
+
+unsigned long EEPROBE_getTotalSleepTimeFileReadShared();
+
+unsigned long EEPROBE_getTotalSleepTimeFileWriteShared();
+
+unsigned long EEPROBE_getTotalSleepTimeFileReadOrdered();
+
+unsigned long EEPROBE_getTotalSleepTimeFileWriteOrdered();
+
+unsigned long EEPROBE_getTotalSleepTimeRput();
+
+unsigned long EEPROBE_getTotalSleepTimeRget();
+
+unsigned long EEPROBE_getTotalSleepTimeRaccumulate();
+
+unsigned long EEPROBE_getTotalSleepTimeWinFence();
+
+unsigned long EEPROBE_getTotalSleepTimeWinWait();
+
+unsigned long EEPROBE_getTotalSleepTimeWinFlag();
+
+unsigned long EEPROBE_getTotalSleepTimeParrived();
+
+  /**
+   * Returns the name of an action, as used in the EEPROBE_<ACTION>_PARAMS
+   * environment variables in upper case.
+   * @param action MPI action.
+   * @return Action name, for instance "allreduce".
+   */
+const char * EEPROBE_getActionName(EEPROBE_ACTION action);
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Counters of an action: sleep time in microseconds, number of waits that
+   * polled without success at least once, and number of unsuccessful polls.
+   */
+typedef struct {
+  unsigned long sleep_time;
+  unsigned long nb_wait;
+  unsigned long nb_poll;
+} EEPROBE_ActionStats;
+
+  /**
+   * Counters of the calling process. time and cpu_time are in microseconds,
+   * current_yield_time is the yield time of the ongoing wait in nanoseconds, 0
+   * outside of waits.
+   */
+typedef struct {
+  unsigned long time;
+  unsigned long cpu_time;
+  long current_yield_time;
+  EEPROBE_ActionStats actions[EEPROBE_NB_ACTION];
+} EEPROBE_Stats;
+
+  /**
+   * Copy the counters since the last call to EEPROBE_resetStats, or since the
+   * beginning. time is the current EEPROBE_getTime() value and cpu_time the
+   * CPU time of the process since the reset.
+   * @param stats Filled with the counters.
+   */
+void EEPROBE_getStats(EEPROBE_Stats * stats);
+
+  /**
+   * Start counting again from 0 in EEPROBE_getStats. The published segment
+   * and the EEPROBE_getTotalSleepTime* getters are not reset.
+   */
+void EEPROBE_resetStats();
+
+#define EEPROBE_STATS_MAGIC 0x45455354
+
+  /* changes whenever the layout of EEPROBE_StatsSegment changes */
+#define EEPROBE_STATS_VERSION 1
+
+#define EEPROBE_STATS_HOSTNAME_SIZE 64
+
+  /**
+   * Shared memory segment published by a process in
+   * <directory>/eeprobe-stats.<pid>. The counters are written under a seqlock:
+   * seq is odd during an update, and a reader copies stats, then checks that
+   * seq was even and did not change. start_time is the EEPROBE_getTime()
+   * value at creation and rank the rank in MPI_COMM_WORLD, -1 until known.
+   */
+typedef struct {
+  unsigned int magic;
+  unsigned int version;
+  unsigned int size;
+  unsigned int nb_action;
+  int pid;
+  int rank;
+  unsigned long start_time;
+  char hostname[EEPROBE_STATS_HOSTNAME_SIZE];
+  unsigned int seq;
+  EEPROBE_Stats stats;
+} EEPROBE_StatsSegment;
+
+  /**
+   * Publish the counters of the calling process in a shared memory segment,
+   * so that eeprobe-top (C/tools) can read them without changing the
+   * application (disabled by default, or set with the EEPROBE_STATS
+   * environment variable given as the period, and EEPROBE_STATS_DIR for the
+   * directory). The segment is refreshed from the micro-sleep loop at most
+   * once per period, so it lags while the process does not wait, and it is
+   * removed at exit.
+   * @param directory Directory of the segment, NULL for /dev/shm.
+   * @param period Shortest time between two updates in nanoseconds, 0 stops
+   * publishing and removes the segment.
+   * @return 0 on success, -1 if the segment cannot be created.
+   */
+int EEPROBE_setStatsPeriod(const char * directory, long period);
+
 /* ---------------------------------------------------------------------------------- */
   
   /**
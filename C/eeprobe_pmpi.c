@@ -0,0 +1,444 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * PMPI interposition layer. Built as a shared library, it replaces the
+   * blocking MPI operations wrapped by EEProbe with their EEPROBE_ equivalents,
+   * so that unmodified applications use the micro-sleep mechanism:
+   *
+   * mpirun -np 2 -x LD_PRELOAD=./libeeprobe_pmpi.so ./app
+   *
+   * Setting the EEPROBE_PMPI environment variable to 0 forwards the calls to
+   * the MPI library unchanged. The EEPROBE_ functions only call nonblocking MPI
+   * operations when the micro-sleep is enabled, so they do not recurse into
+   * this layer. The ordered MPI-IO operations are not replaced: their
+   * wrappers fall back to the blocking routine for some files, which would
+   * recurse.
+   */
+
+/* getenv, strtol */
+#include <stdlib.h>
+
+/* strcmp */
+#include <string.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+  /* -1: not read yet, 0: forward to the MPI library, 1: use EEProbe */
+static int _EEPROBE_PMPI_ENABLE = -1;
+
+static int
+EEPROBE_isPmpiEnabled() {
+
+  const char * value = NULL;
+
+  if (_EEPROBE_PMPI_ENABLE == -1) {
+    value = getenv("EEPROBE_PMPI");
+    _EEPROBE_PMPI_ENABLE = ((value == NULL) || (strcmp(value, "0") != 0));
+  }
+
+  return _EEPROBE_PMPI_ENABLE;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Set up the doorbells on MPI_COMM_WORLD when the EEPROBE_DOORBELL
+   * environment variable gives their timeout in nanoseconds.
+   */
+static void
+EEPROBE_initPmpiDoorbell() {
+
+  const char * value = getenv("EEPROBE_DOORBELL");
+
+  long timeout = 0;
+
+  if (EEPROBE_isPmpiEnabled() && (value != NULL)) {
+    timeout = strtol(value, NULL, 10);
+    if ((timeout > 0) && (timeout < 1000000000)) {
+      EEPROBE_Doorbell_init(MPI_COMM_WORLD, timeout);
+    }
+  }
+
+}
+
+int
+MPI_Init(int *argc, char ***argv) {
+
+  int errno = PMPI_Init(argc, argv);
+
+  if (errno == MPI_SUCCESS) {
+    EEPROBE_initPmpiDoorbell();
+  }
+
+  return errno;
+
+}
+
+int
+MPI_Init_thread(int *argc, char ***argv, int required, int *provided) {
+
+  int errno = PMPI_Init_thread(argc, argv, required, provided);
+
+  if (errno == MPI_SUCCESS) {
+    EEPROBE_initPmpiDoorbell();
+  }
+
+  return errno;
+
+}
+
+int
+MPI_Finalize() {
+  EEPROBE_Doorbell_free();
+  return PMPI_Finalize();
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Probe(int source, int tag, MPI_Comm comm, MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Probe(source, tag, comm, status);
+  }
+  return PMPI_Probe(source, tag, comm, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Wait(MPI_Request *request, MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Wait(request, status);
+  }
+  return PMPI_Wait(request, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Recv(void *buf, int count, MPI_Datatype datatype, int source, int tag,
+	 MPI_Comm comm, MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Recv(buf, count, datatype, source, tag, comm, status);
+  }
+  return PMPI_Recv(buf, count, datatype, source, tag, comm, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Send(const void *buf, int count, MPI_Datatype datatype, int dest, int tag,
+	 MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Send(buf, count, datatype, dest, tag, comm);
+  }
+  return PMPI_Send(buf, count, datatype, dest, tag, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Ssend(const void *buf, int count, MPI_Datatype datatype, int dest, int tag,
+	  MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Ssend(buf, count, datatype, dest, tag, comm);
+  }
+  return PMPI_Ssend(buf, count, datatype, dest, tag, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Rsend(const void *buf, int count, MPI_Datatype datatype, int dest, int tag,
+	  MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Rsend(buf, count, datatype, dest, tag, comm);
+  }
+  return PMPI_Rsend(buf, count, datatype, dest, tag, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Reduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype,
+	   MPI_Op op, int root, MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+  }
+  return PMPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Allreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype,
+	      MPI_Op op, MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+  }
+  return PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Alltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+	     void *recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+  }
+  return PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Alltoallv(const void *sendbuf, const int sendcounts[], const int sdispls[],
+	      MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
+	      const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm);
+  }
+  return PMPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Alltoallw(const void *sendbuf, const int sendcounts[], const int sdispls[],
+	      const MPI_Datatype sendtypes[], void *recvbuf, const int recvcounts[],
+	      const int rdispls[], const MPI_Datatype recvtypes[], MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Alltoallw(sendbuf, sendcounts, sdispls, sendtypes, recvbuf, recvcounts, rdispls, recvtypes, comm);
+  }
+  return PMPI_Alltoallw(sendbuf, sendcounts, sdispls, sendtypes, recvbuf, recvcounts, rdispls, recvtypes, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Bcast(void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Bcast(buffer, count, datatype, root, comm);
+  }
+  return PMPI_Bcast(buffer, count, datatype, root, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+	    void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+	    MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Scatter(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+  }
+  return PMPI_Scatter(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Scatterv(const void *sendbuf, const int sendcounts[], const int displs[],
+	     MPI_Datatype sendtype, void *recvbuf, int recvcount,
+	     MPI_Datatype recvtype, int root, MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype, root, comm);
+  }
+  return PMPI_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype, root, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+	   void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+	   MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+  }
+  return PMPI_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Gatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+	    void *recvbuf, const int recvcounts[], const int displs[],
+	    MPI_Datatype recvtype, int root, MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, root, comm);
+  }
+  return PMPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, root, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Allgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+	      void *recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+  }
+  return PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Allgatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+	       void *recvbuf, const int recvcounts[], const int displs[],
+	       MPI_Datatype recvtype, MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+  }
+  return PMPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_Barrier(MPI_Comm comm) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_Barrier(comm);
+  }
+  return PMPI_Barrier(comm);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_read(MPI_File fh, void *buf, int count, MPI_Datatype datatype,
+	      MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_read(fh, buf, count, datatype, status);
+  }
+  return PMPI_File_read(fh, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_read_at(MPI_File fh, MPI_Offset offset, void *buf, int count,
+		 MPI_Datatype datatype, MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_read_at(fh, offset, buf, count, datatype, status);
+  }
+  return PMPI_File_read_at(fh, offset, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_read_all(MPI_File fh, void *buf, int count, MPI_Datatype datatype,
+		  MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_read_all(fh, buf, count, datatype, status);
+  }
+  return PMPI_File_read_all(fh, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_read_at_all(MPI_File fh, MPI_Offset offset, void *buf, int count,
+		     MPI_Datatype datatype, MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_read_at_all(fh, offset, buf, count, datatype, status);
+  }
+  return PMPI_File_read_at_all(fh, offset, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_read_shared(MPI_File fh, void *buf, int count, MPI_Datatype datatype,
+		     MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_read_shared(fh, buf, count, datatype, status);
+  }
+  return PMPI_File_read_shared(fh, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_write(MPI_File fh, const void *buf, int count, MPI_Datatype datatype,
+	       MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_write(fh, buf, count, datatype, status);
+  }
+  return PMPI_File_write(fh, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_write_at(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+		  MPI_Datatype datatype, MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_write_at(fh, offset, buf, count, datatype, status);
+  }
+  return PMPI_File_write_at(fh, offset, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_write_all(MPI_File fh, const void *buf, int count, MPI_Datatype datatype,
+		   MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_write_all(fh, buf, count, datatype, status);
+  }
+  return PMPI_File_write_all(fh, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_write_at_all(MPI_File fh, MPI_Offset offset, const void *buf, int count,
+		      MPI_Datatype datatype, MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_write_at_all(fh, offset, buf, count, datatype, status);
+  }
+  return PMPI_File_write_at_all(fh, offset, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+MPI_File_write_shared(MPI_File fh, const void *buf, int count, MPI_Datatype datatype,
+		      MPI_Status *status) {
+  if (EEPROBE_isPmpiEnabled()) {
+    return EEPROBE_File_write_shared(fh, buf, count, datatype, status);
+  }
+  return PMPI_File_write_shared(fh, buf, count, datatype, status);
+}
+
+/* ---------------------------------------------------------------------------------- */
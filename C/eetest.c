@@ -280,6 +280,135 @@ EEPROBE_sendRecv(EEPROBE_Enable enable, unsigned long start_time) {
 
 /* ---------------------------------------------------------------------------------- */
 
+typedef struct {
+  EEPROBE_Reactor * reactor;
+  int source;
+  int buffer;
+  int nb_recv;
+  unsigned long start_time;
+} EEPROBE_Worker;
+
+static void
+EEPROBE_workerCallback(MPI_Status * status, void * user_data) {
+
+  EEPROBE_Worker * worker = user_data;
+
+  MPI_Request request;
+
+  int errno = MPI_SUCCESS;
+
+  assert(status->MPI_ERROR == MPI_SUCCESS);
+
+  fprintf(stdout, "%lu rank %d reactor recv %d from %d\n",
+	  EEPROBE_getTime() - worker->start_time, EEPROBE_RANK_RECV,
+	  worker->nb_recv, status->MPI_SOURCE);
+
+  worker->nb_recv++;
+
+  if (worker->nb_recv < EEPROBE_NB_ITER) {
+
+    errno = MPI_Irecv(&(worker->buffer), 1, MPI_INT, worker->source,
+		      EEPROBE_TAG, MPI_COMM_WORLD, &request);
+    assert(errno == MPI_SUCCESS);
+
+    EEPROBE_Reactor_register(worker->reactor, request, EEPROBE_workerCallback, worker);
+
+  }
+
+}
+
+static void
+EEPROBE_reactor(EEPROBE_Enable enable, unsigned long start_time) {
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int i = 0;
+
+  int errno = MPI_SUCCESS;
+
+  EEPROBE_Reactor reactor;
+
+  EEPROBE_Worker * workers = NULL;
+
+  MPI_Request request;
+
+  struct timespec sender_sleep;
+
+  long sender_delay = 0;
+
+  rank = EEPROBE_getTaskId(MPI_COMM_WORLD);
+  nr = EEPROBE_getTaskNr(MPI_COMM_WORLD);
+
+  fprintf(stdout, "%lu rank %d start reactor\n", EEPROBE_getTime() - start_time, rank);
+
+  if (rank == EEPROBE_RANK_RECV) {
+
+    EEPROBE_Reactor_init(&reactor, enable);
+
+    workers = malloc(sizeof(EEPROBE_Worker) * nr);
+    assert(workers);
+
+    for (i = 0; i < nr; i++) {
+
+      if (i != EEPROBE_RANK_RECV) {
+
+	workers[i].reactor = &reactor;
+	workers[i].source = i;
+	workers[i].nb_recv = 0;
+	workers[i].start_time = start_time;
+
+	errno = MPI_Irecv(&(workers[i].buffer), 1, MPI_INT, i,
+			  EEPROBE_TAG, MPI_COMM_WORLD, &request);
+	assert(errno == MPI_SUCCESS);
+
+	EEPROBE_Reactor_register(&reactor, request, EEPROBE_workerCallback, &(workers[i]));
+
+      }
+
+    }
+
+    errno = EEPROBE_Reactor_run(&reactor);
+    assert(errno == MPI_SUCCESS);
+
+    fprintf(stdout,
+	    "%lu rank %d reactor dispatch %lu poll %lu avg_dispatch_latency %lu max_dispatch_latency %lu idle_time %lu\n",
+	    EEPROBE_getTime() - start_time, rank,
+	    reactor.stats.nb_dispatch, reactor.stats.nb_poll,
+	    reactor.stats.total_dispatch_latency / reactor.stats.nb_dispatch,
+	    reactor.stats.max_dispatch_latency, reactor.stats.idle_time);
+
+    EEPROBE_Reactor_free(&reactor);
+
+    free(workers);
+    workers = NULL;
+
+  } else {
+
+    /* workers answer at different paces */
+    sender_delay = 250000000L * (1 + rank % 4);
+    sender_sleep.tv_sec = sender_delay / 1000000000;
+    sender_sleep.tv_nsec = sender_delay % 1000000000;
+
+    for (i = 0; i < EEPROBE_NB_ITER; i++) {
+
+      errno = clock_nanosleep(CLOCK_MONOTONIC, 0, &sender_sleep, NULL);
+      assert(errno == 0);
+
+      errno = MPI_Send(&i, 1, MPI_INT, EEPROBE_RANK_RECV, EEPROBE_TAG, MPI_COMM_WORLD);
+      assert(errno == MPI_SUCCESS);
+
+    }
+
+  }
+
+  fprintf(stdout, "%lu rank %d end reactor\n", EEPROBE_getTime() - start_time, rank);
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
 
 int
 main(int argc, char *argv[]) {
@@ -313,6 +442,7 @@ main(int argc, char *argv[]) {
 
     EEPROBE_collective(enable, start_time);
     EEPROBE_sendRecv(enable, start_time);
+    EEPROBE_reactor(enable, start_time);
 
   } else {
     fprintf(stdout, "Warning: MPI task nr is %d. Expected >= 2. Usage:\nmpirun -np 4 %s\nmpirun -np 4 %s disable\n",
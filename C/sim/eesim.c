@@ -0,0 +1,544 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Offline policy simulator. A receiver waits for a timeline of message
+   * arrivals with EEPROBE_Probe_Switch or EEPROBE_Wait_Switch, run against a
+   * mock MPI_Iprobe/MPI_Test answering from the timeline and a virtual clock:
+   * the clock and sleep functions of the C library are replaced in this
+   * executable, so that each poll costs a fixed CPU time and each sleep lasts
+   * its duration plus a modeled overshoot (timer slack and exponential jitter)
+   * and costs a wake-up. The real EEProbe backoff code is simulated, without
+   * MPI_Init and without a launcher, in milliseconds. Each policy runs in a
+   * forked process with a fresh library state, and prints one line: polls,
+   * sleeps, simulated CPU time and detection delay (time from the arrival, or
+   * from the start of the wait if later, to its detection).
+   *
+   * ./eesim -t poisson -g 100000 -n 1000
+   * ./eesim -f trace.txt -y 1000:10000:1000000 -p exponential,spin
+   *
+   * -t periodic|poisson|bursty|heavytail  synthetic timeline (poisson)
+   * -f file      recorded timeline, one arrival time in ns per line
+   * -n count     number of synthetic messages (1000)
+   * -g ns        mean gap between two synthetic messages (100000)
+   * -r seed      random seed (1)
+   * -w probe|wait  receiver primitive (probe)
+   * -p list      comma separated policies (linear,exponential,constant,spin)
+   * -y min:inc:max  yield times in ns (library settings)
+   * -s ns        sleep overshoot, timer slack (50000)
+   * -j ns        sleep overshoot, mean of the exponential jitter (5000)
+   * -c ns        CPU cost of a poll or sched_yield (200)
+   * -k ns        CPU cost of a wake-up (2000)
+   * -i nanosleep|abs|yield  idle primitive (nanosleep)
+   *
+   * Only the idle primitives built on clock_nanosleep or sched_yield are
+   * virtualized: EEPROBE_IDLE_TIMERFD (epoll_wait), EEPROBE_IDLE_TPAUSE and
+   * EEPROBE_IDLE_AUTO (which may pick tpause) would sleep in real time and
+   * are rejected.
+   *
+   * The EEPROBE_ environment variables apply, EEPROBE_PREDICTOR=1 for instance.
+   */
+
+/* assert */
+#include <assert.h>
+
+/* malloc, qsort, strtol, strtod, rand_r */
+#include <stdlib.h>
+
+/* fprintf, fopen, fscanf */
+#include <stdio.h>
+
+/* strcmp, strtok */
+#include <string.h>
+
+/* log, pow */
+#include <math.h>
+
+/* getopt, fork */
+#include <unistd.h>
+
+/* waitpid */
+#include <sys/wait.h>
+
+/* gettimeofday */
+#include <sys/time.h>
+
+/* clock_gettime, clock_nanosleep, nanosleep */
+#include <time.h>
+
+/* sched_yield */
+#include <sched.h>
+
+/* MPI */
+#include "mpi.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EESIM_NB_MESSAGE 1000
+
+#define EESIM_MEAN_GAP_NS 100000
+
+#define EESIM_SLACK_NS 50000
+
+#define EESIM_JITTER_NS 5000
+
+#define EESIM_POLL_COST_NS 200
+
+#define EESIM_WAKEUP_COST_NS 2000
+
+  /* messages of a burst, the bursty timeline keeps the mean gap */
+#define EESIM_BURST_SIZE 10
+
+  /* shape of the Pareto gaps of the heavytail timeline */
+#define EESIM_PARETO_ALPHA 1.5
+
+/* ---------------------------------------------------------------------------------- */
+
+  /* virtual clock in nanoseconds, and simulated CPU time */
+static unsigned long _EESIM_NOW = 0;
+
+static unsigned long _EESIM_CPU = 0;
+
+static unsigned long _EESIM_NB_POLL = 0;
+
+static unsigned long _EESIM_NB_SLEEP = 0;
+
+static long _EESIM_SLACK = EESIM_SLACK_NS;
+
+static long _EESIM_JITTER = EESIM_JITTER_NS;
+
+static long _EESIM_POLL_COST = EESIM_POLL_COST_NS;
+
+static long _EESIM_WAKEUP_COST = EESIM_WAKEUP_COST_NS;
+
+static unsigned int _EESIM_SEED = 1;
+
+  /* arrival times of the timeline and next message to detect */
+static unsigned long * _EESIM_ARRIVALS = NULL;
+
+static int _EESIM_NB_ARRIVAL = 0;
+
+static int _EESIM_NEXT = 0;
+
+/* ---------------------------------------------------------------------------------- */
+
+static double
+EESIM_uniform() {
+  /* ]0;1] */
+  return ((double) rand_r(&_EESIM_SEED) + 1.0) / ((double) RAND_MAX + 1.0);
+}
+
+static double
+EESIM_exponential(double mean) {
+  return -mean * log(EESIM_uniform());
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Virtual clock and sleeps, replacing the C library functions called by
+   * EEProbe in this executable.
+   */
+int
+clock_gettime(clockid_t clock_id, struct timespec *tp) {
+  (void) clock_id;
+  tp->tv_sec = _EESIM_NOW / 1000000000;
+  tp->tv_nsec = _EESIM_NOW % 1000000000;
+  return 0;
+}
+
+int
+gettimeofday(struct timeval *restrict tv, void *restrict tz) {
+  (void) tz;
+  tv->tv_sec = _EESIM_NOW / 1000000000;
+  tv->tv_usec = (_EESIM_NOW % 1000000000) / 1000;
+  return 0;
+}
+
+static void
+EESIM_sleep(unsigned long duration) {
+  _EESIM_NOW += duration + _EESIM_SLACK + (unsigned long) EESIM_exponential(_EESIM_JITTER);
+  _EESIM_NOW += _EESIM_WAKEUP_COST;
+  _EESIM_CPU += _EESIM_WAKEUP_COST;
+  _EESIM_NB_SLEEP++;
+}
+
+int
+clock_nanosleep(clockid_t clock_id, int flags, const struct timespec *request,
+		struct timespec *remain) {
+
+  unsigned long deadline = request->tv_sec * 1000000000UL + request->tv_nsec;
+
+  (void) clock_id;
+  (void) remain;
+
+  if (flags & TIMER_ABSTIME) {
+    EESIM_sleep((deadline > _EESIM_NOW) ? deadline - _EESIM_NOW : 0);
+  } else {
+    EESIM_sleep(deadline);
+  }
+
+  return 0;
+
+}
+
+int
+nanosleep(const struct timespec *request, struct timespec *remain) {
+  return clock_nanosleep(CLOCK_MONOTONIC, 0, request, remain);
+}
+
+int
+sched_yield() {
+  _EESIM_NOW += _EESIM_POLL_COST;
+  _EESIM_CPU += _EESIM_POLL_COST;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Mock MPI layer: a poll costs a fixed CPU time and succeeds when the next
+   * message of the timeline has arrived. The message is consumed by the
+   * receiver loop.
+   */
+static int
+EESIM_poll() {
+
+  _EESIM_NOW += _EESIM_POLL_COST;
+  _EESIM_CPU += _EESIM_POLL_COST;
+  _EESIM_NB_POLL++;
+
+  return (_EESIM_NEXT < _EESIM_NB_ARRIVAL) && (_EESIM_ARRIVALS[_EESIM_NEXT] <= _EESIM_NOW);
+
+}
+
+int
+MPI_Iprobe(int source, int tag, MPI_Comm comm, int *flag, MPI_Status *status) {
+
+  (void) comm;
+
+  *flag = EESIM_poll();
+
+  if ((*flag != 0) && (status != MPI_STATUS_IGNORE)) {
+    status->MPI_SOURCE = (source == MPI_ANY_SOURCE) ? 0 : source;
+    status->MPI_TAG = (tag == MPI_ANY_TAG) ? 0 : tag;
+    status->MPI_ERROR = MPI_SUCCESS;
+  }
+
+  return MPI_SUCCESS;
+
+}
+
+int
+MPI_Test(MPI_Request *request, int *flag, MPI_Status *status) {
+
+  *flag = EESIM_poll();
+
+  if (*flag != 0) {
+    *request = MPI_REQUEST_NULL;
+    if (status != MPI_STATUS_IGNORE) {
+      status->MPI_SOURCE = 0;
+      status->MPI_TAG = 0;
+      status->MPI_ERROR = MPI_SUCCESS;
+    }
+  }
+
+  return MPI_SUCCESS;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+static void
+EESIM_generate(const char * kind, int count, double gap) {
+
+  double time = 0.0;
+
+  double intra = gap / 100.0;
+
+  double xm = gap * (EESIM_PARETO_ALPHA - 1.0) / EESIM_PARETO_ALPHA;
+
+  int i = 0;
+
+  _EESIM_ARRIVALS = malloc(count * sizeof(unsigned long));
+  assert(_EESIM_ARRIVALS);
+
+  for (i = 0; i < count; i++) {
+    if (strcmp(kind, "periodic") == 0) {
+      time += gap;
+    } else if (strcmp(kind, "bursty") == 0) {
+      time += ((i % EESIM_BURST_SIZE) == 0) ?
+	EESIM_BURST_SIZE * gap - (EESIM_BURST_SIZE - 1) * intra : intra;
+    } else if (strcmp(kind, "heavytail") == 0) {
+      time += xm / pow(EESIM_uniform(), 1.0 / EESIM_PARETO_ALPHA);
+    } else {
+      time += EESIM_exponential(gap);
+    }
+    _EESIM_ARRIVALS[i] = (unsigned long) time;
+  }
+
+  _EESIM_NB_ARRIVAL = count;
+
+}
+
+static int
+EESIM_load(const char * path) {
+
+  FILE * file = fopen(path, "r");
+
+  unsigned long arrival = 0;
+
+  int capacity = 1024;
+
+  if (file == NULL) {
+    return 0;
+  }
+
+  _EESIM_ARRIVALS = malloc(capacity * sizeof(unsigned long));
+  assert(_EESIM_ARRIVALS);
+
+  while (fscanf(file, "%lu", &arrival) == 1) {
+    if (_EESIM_NB_ARRIVAL == capacity) {
+      capacity *= 2;
+      _EESIM_ARRIVALS = realloc(_EESIM_ARRIVALS, capacity * sizeof(unsigned long));
+      assert(_EESIM_ARRIVALS);
+    }
+    _EESIM_ARRIVALS[_EESIM_NB_ARRIVAL++] = arrival;
+  }
+
+  fclose(file);
+
+  return _EESIM_NB_ARRIVAL;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+static int
+EESIM_compare(const void * a, const void * b) {
+
+  unsigned long x = *((const unsigned long *) a);
+
+  unsigned long y = *((const unsigned long *) b);
+
+  return (x > y) - (x < y);
+
+}
+
+  /**
+   * Only the primitives idling through the replaced C library functions are
+   * accepted.
+   */
+static int
+EESIM_parseIdle(const char * name, EEPROBE_IdlePrimitive * primitive) {
+
+  if (strcmp(name, "nanosleep") == 0) {
+    *primitive = EEPROBE_IDLE_NANOSLEEP;
+  } else if (strcmp(name, "abs") == 0) {
+    *primitive = EEPROBE_IDLE_NANOSLEEP_ABS;
+  } else if (strcmp(name, "yield") == 0) {
+    *primitive = EEPROBE_IDLE_YIELD;
+  } else {
+    return 0;
+  }
+
+  return 1;
+
+}
+
+  /**
+   * Replay the timeline against one policy and print its line.
+   */
+static void
+EESIM_run(const char * name, EEPROBE_Policy policy, const EEPROBE_ActionParams * params,
+	  int wait) {
+
+  MPI_Status status;
+
+  MPI_Request request;
+
+  unsigned long * delays = malloc(_EESIM_NB_ARRIVAL * sizeof(unsigned long));
+
+  unsigned long start = 0;
+
+  unsigned long sum = 0;
+
+  int i = 0;
+
+  assert(delays);
+
+  EEPROBE_setActionParams(wait ? EEPROBE_WAIT : EEPROBE_PROBE, params->min_yield_time,
+			  params->inc_yield_time, params->max_yield_time, policy);
+
+  for (i = 0; i < _EESIM_NB_ARRIVAL; i++) {
+    start = _EESIM_NOW;
+    if (wait) {
+      /* the mock MPI_Test ignores the request handle */
+      request = MPI_REQUEST_NULL;
+      EEPROBE_Wait_Switch(&request, &status, EEPROBE_ENABLE);
+    } else {
+      EEPROBE_Probe_Switch(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status, EEPROBE_ENABLE);
+    }
+    delays[i] = _EESIM_NOW - ((_EESIM_ARRIVALS[i] > start) ? _EESIM_ARRIVALS[i] : start);
+    sum += delays[i];
+    _EESIM_NEXT++;
+  }
+
+  qsort(delays, _EESIM_NB_ARRIVAL, sizeof(unsigned long), EESIM_compare);
+
+  fprintf(stdout, "policy %s messages %d polls %lu sleeps %lu time_ns %lu cpu_ns %lu cpu_percent %.2f delay_mean_ns %lu delay_p50_ns %lu delay_p99_ns %lu delay_max_ns %lu\n",
+	  name, _EESIM_NB_ARRIVAL, _EESIM_NB_POLL, _EESIM_NB_SLEEP, _EESIM_NOW, _EESIM_CPU,
+	  (_EESIM_NOW > 0) ? 100.0 * _EESIM_CPU / _EESIM_NOW : 0.0,
+	  sum / _EESIM_NB_ARRIVAL, delays[_EESIM_NB_ARRIVAL / 2],
+	  delays[(_EESIM_NB_ARRIVAL * 99) / 100], delays[_EESIM_NB_ARRIVAL - 1]);
+
+  free(delays);
+
+}
+
+static int
+EESIM_parsePolicy(const char * name, EEPROBE_Policy * policy) {
+
+  if (strcmp(name, "linear") == 0) {
+    *policy = EEPROBE_POLICY_LINEAR;
+  } else if (strcmp(name, "exponential") == 0) {
+    *policy = EEPROBE_POLICY_EXPONENTIAL;
+  } else if (strcmp(name, "constant") == 0) {
+    *policy = EEPROBE_POLICY_CONSTANT;
+  } else if (strcmp(name, "spin") == 0) {
+    *policy = EEPROBE_POLICY_SPIN;
+  } else {
+    return 0;
+  }
+
+  return 1;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  EEPROBE_ActionParams params;
+
+  EEPROBE_Policy policy = EEPROBE_POLICY_LINEAR;
+
+  EEPROBE_IdlePrimitive primitive = EEPROBE_IDLE_NANOSLEEP;
+
+  char policies[256] = "linear,exponential,constant,spin";
+
+  const char * kind = "poisson";
+
+  const char * path = NULL;
+
+  char * name = NULL;
+
+  int count = EESIM_NB_MESSAGE;
+
+  double gap = EESIM_MEAN_GAP_NS;
+
+  int wait = 0;
+
+  int option = 0;
+
+  pid_t pid = 0;
+
+  EEPROBE_getActionParams(EEPROBE_PROBE, &params);
+
+  while ((option = getopt(argc, argv, "t:f:n:g:r:w:p:y:s:j:c:k:i:")) != -1) {
+    switch (option) {
+    case 't': kind = optarg; break;
+    case 'f': path = optarg; break;
+    case 'n': count = strtol(optarg, NULL, 10); break;
+    case 'g': gap = strtod(optarg, NULL); break;
+    case 'r': _EESIM_SEED = strtoul(optarg, NULL, 10); break;
+    case 'w': wait = (strcmp(optarg, "wait") == 0); break;
+    case 'p': snprintf(policies, sizeof(policies), "%s", optarg); break;
+    case 'y':
+      if (sscanf(optarg, "%ld:%ld:%ld", &params.min_yield_time, &params.inc_yield_time,
+		 &params.max_yield_time) != 3) {
+	fprintf(stderr, "eesim: -y expects min:inc:max\n");
+	return 1;
+      }
+      break;
+    case 's': _EESIM_SLACK = strtol(optarg, NULL, 10); break;
+    case 'j': _EESIM_JITTER = strtol(optarg, NULL, 10); break;
+    case 'c': _EESIM_POLL_COST = strtol(optarg, NULL, 10); break;
+    case 'k': _EESIM_WAKEUP_COST = strtol(optarg, NULL, 10); break;
+    case 'i':
+      if (!EESIM_parseIdle(optarg, &primitive)) {
+	fprintf(stderr, "eesim: idle primitive %s is not simulated (nanosleep, abs or yield)\n", optarg);
+	return 1;
+      }
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-t periodic|poisson|bursty|heavytail] [-f file] [-n count] [-g gap_ns] [-r seed] [-w probe|wait] [-p policies] [-y min:inc:max] [-s slack_ns] [-j jitter_ns] [-c poll_cost_ns] [-k wakeup_cost_ns] [-i nanosleep|abs|yield]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  EEPROBE_setIdlePrimitive(primitive);
+
+  if (path != NULL) {
+    if (EESIM_load(path) == 0) {
+      fprintf(stderr, "eesim: no arrival read from %s\n", path);
+      return 1;
+    }
+  } else if (count > 0) {
+    EESIM_generate(kind, count, gap);
+  } else {
+    fprintf(stderr, "eesim: -n must be > 0\n");
+    return 1;
+  }
+
+  for (name = strtok(policies, ","); name != NULL; name = strtok(NULL, ",")) {
+
+    if (!EESIM_parsePolicy(name, &policy)) {
+      fprintf(stderr, "eesim: unknown policy %s\n", name);
+      return 1;
+    }
+
+    fflush(stdout);
+
+    pid = fork();
+    assert(pid >= 0);
+
+    if (pid == 0) {
+      EESIM_run(name, policy, &params, wait);
+      fflush(stdout);
+      _exit(0);
+    }
+
+    waitpid(pid, NULL, 0);
+
+  }
+
+  free(_EESIM_ARRIVALS);
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
@@ -0,0 +1,562 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Live monitor of the EEProbe counters published by the processes of a node
+   * (EEPROBE_STATS environment variable or EEPROBE_setStatsPeriod). The
+   * segments are mapped read-only and copied under their seqlock, so the
+   * monitored processes are neither stopped nor slowed down. Each refresh
+   * shows rates over the interval between the last two updates of a segment,
+   * or since the start of the process on the first refresh:
+   *
+   * rank view: CPU use, fraction of time asleep, waits and unsuccessful polls
+   * per second, current yield time, action with the most sleep and age of the
+   * last update, per process;
+   * node view: the same sums per host;
+   * action view: sleep, waits and polls per action, summed over the processes.
+   *
+   * Processes that exited without removing their segment are shown as dead.
+   *
+   * EEPROBE_STATS=100000000 mpirun -np 8 ./app
+   * ./eeprobe-top -v node -i 500
+   *
+   * -d dir       directory of the segments (/dev/shm)
+   * -i ms        refresh interval (1000)
+   * -n count     number of refreshes, 0 for no limit (0)
+   * -v rank|node|action  view (rank)
+   * -b           batch mode: append the refreshes instead of clearing the screen
+   */
+
+/* assert */
+#include <assert.h>
+
+/* realloc, strtol, qsort */
+#include <stdlib.h>
+
+/* fprintf, snprintf */
+#include <stdio.h>
+
+/* strcmp, strncmp, memcpy */
+#include <string.h>
+
+/* nanosleep */
+#include <time.h>
+
+/* getopt, close */
+#include <unistd.h>
+
+/* open */
+#include <fcntl.h>
+
+/* opendir, readdir */
+#include <dirent.h>
+
+/* kill */
+#include <signal.h>
+
+/* fstat */
+#include <sys/stat.h>
+
+/* mmap, munmap */
+#include <sys/mman.h>
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.h"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EETOP_INTERVAL_MS 1000
+
+  /* attempts to read a consistent copy before skipping a segment */
+#define EETOP_NB_RETRY 1000
+
+#define EETOP_PREFIX "eeprobe-stats."
+
+typedef enum {EETOP_VIEW_RANK, EETOP_VIEW_NODE, EETOP_VIEW_ACTION} EETOP_View;
+
+  /**
+   * Last copy of a segment and the rates computed from the copy before.
+   */
+typedef struct {
+  int pid;
+  int rank;
+  int alive;
+  unsigned long start_time;
+  char hostname[EEPROBE_STATS_HOSTNAME_SIZE];
+  EEPROBE_Stats stats;
+  double cpu;
+  double sleep;
+  double wait;
+  double poll;
+  double action_sleep[EEPROBE_NB_ACTION];
+  double action_wait[EEPROBE_NB_ACTION];
+  double action_poll[EEPROBE_NB_ACTION];
+} EETOP_Entry;
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Map a segment read-only and copy it under its seqlock. Returns 0 on
+   * success, -1 if the file is not a segment of this version or stays
+   * inconsistent.
+   */
+static int
+EETOP_readSegment(const char * path, EETOP_Entry * entry) {
+
+  EEPROBE_StatsSegment * segment = NULL;
+
+  struct stat st;
+
+  unsigned int seq = 0;
+
+  int fd = -1;
+
+  int valid = 0;
+
+  int i = 0;
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+
+  if ((fstat(fd, &st) != 0) || (st.st_size != sizeof(EEPROBE_StatsSegment))) {
+    close(fd);
+    return -1;
+  }
+
+  segment = mmap(NULL, sizeof(EEPROBE_StatsSegment), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED) {
+    return -1;
+  }
+
+  if ((__atomic_load_n(&(segment->magic), __ATOMIC_ACQUIRE) == EEPROBE_STATS_MAGIC) &&
+      (segment->version == EEPROBE_STATS_VERSION) &&
+      (segment->size == sizeof(EEPROBE_StatsSegment)) &&
+      (segment->nb_action == EEPROBE_NB_ACTION)) {
+
+    for (i = 0; (i < EETOP_NB_RETRY) && !valid; i++) {
+      seq = __atomic_load_n(&(segment->seq), __ATOMIC_ACQUIRE);
+      memcpy(&(entry->stats), (const void *) &(segment->stats), sizeof(EEPROBE_Stats));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      valid = ((seq % 2) == 0) &&
+	(__atomic_load_n(&(segment->seq), __ATOMIC_RELAXED) == seq);
+    }
+
+    entry->pid = segment->pid;
+    entry->rank = segment->rank;
+    entry->start_time = segment->start_time;
+    memcpy(entry->hostname, segment->hostname, EEPROBE_STATS_HOSTNAME_SIZE);
+    entry->hostname[EEPROBE_STATS_HOSTNAME_SIZE - 1] = '\0';
+    entry->alive = (kill(entry->pid, 0) == 0);
+
+  }
+
+  munmap(segment, sizeof(EEPROBE_StatsSegment));
+
+  return valid ? 0 : -1;
+
+}
+
+  /**
+   * Compute the rates of an entry from the previous copy of the same process,
+   * keep the previous rates if the segment was not updated in between.
+   */
+static void
+EETOP_computeRates(EETOP_Entry * entry, const EETOP_Entry * previous) {
+
+  EEPROBE_Stats base;
+
+  double elapsed = 0.0;
+
+  int i = 0;
+
+  if ((previous != NULL) && (previous->stats.time == entry->stats.time)) {
+    memcpy(entry, previous, sizeof(EETOP_Entry));
+    entry->alive = (kill(entry->pid, 0) == 0);
+    return;
+  }
+
+  if (previous != NULL) {
+    base = previous->stats;
+  } else {
+    memset(&base, 0, sizeof(EEPROBE_Stats));
+    base.time = entry->start_time;
+  }
+
+  elapsed = (entry->stats.time > base.time) ? (entry->stats.time - base.time) / 1e6 : 0.0;
+
+  entry->sleep = 0.0;
+  entry->wait = 0.0;
+  entry->poll = 0.0;
+  entry->cpu = 0.0;
+
+  if (elapsed <= 0.0) {
+    memset(entry->action_sleep, 0, sizeof(entry->action_sleep));
+    memset(entry->action_wait, 0, sizeof(entry->action_wait));
+    memset(entry->action_poll, 0, sizeof(entry->action_poll));
+    return;
+  }
+
+  entry->cpu = (entry->stats.cpu_time - base.cpu_time) / 1e6 / elapsed;
+
+  for (i = 0; i < EEPROBE_NB_ACTION; i++) {
+    entry->action_sleep[i] =
+      (entry->stats.actions[i].sleep_time - base.actions[i].sleep_time) / 1e6 / elapsed;
+    entry->action_wait[i] =
+      (entry->stats.actions[i].nb_wait - base.actions[i].nb_wait) / elapsed;
+    entry->action_poll[i] =
+      (entry->stats.actions[i].nb_poll - base.actions[i].nb_poll) / elapsed;
+    entry->sleep += entry->action_sleep[i];
+    entry->wait += entry->action_wait[i];
+    entry->poll += entry->action_poll[i];
+  }
+
+}
+
+static int
+EETOP_compareEntries(const void * a, const void * b) {
+
+  const EETOP_Entry * ea = a;
+
+  const EETOP_Entry * eb = b;
+
+  int cmp = strcmp(ea->hostname, eb->hostname);
+
+  if (cmp != 0) {
+    return cmp;
+  }
+  if (ea->rank != eb->rank) {
+    return (ea->rank < eb->rank) ? -1 : 1;
+  }
+  return (ea->pid < eb->pid) ? -1 : (ea->pid > eb->pid);
+
+}
+
+  /**
+   * Read all the segments of the directory into entries, computing the rates
+   * against the previous refresh. Returns the number of entries.
+   */
+static int
+EETOP_scan(const char * directory, EETOP_Entry ** entries, int * capacity,
+	   const EETOP_Entry * previous, int nb_previous) {
+
+  DIR * dir = NULL;
+
+  struct dirent * file = NULL;
+
+  char path[1024];
+
+  const EETOP_Entry * match = NULL;
+
+  int nb_entry = 0;
+
+  int i = 0;
+
+  dir = opendir(directory);
+  if (dir == NULL) {
+    return 0;
+  }
+
+  while ((file = readdir(dir)) != NULL) {
+
+    if (strncmp(file->d_name, EETOP_PREFIX, strlen(EETOP_PREFIX)) != 0) {
+      continue;
+    }
+
+    if (nb_entry == *capacity) {
+      *capacity = (*capacity == 0) ? 64 : 2 * (*capacity);
+      *entries = realloc(*entries, *capacity * sizeof(EETOP_Entry));
+      assert(*entries);
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", directory, file->d_name);
+    if (EETOP_readSegment(path, &((*entries)[nb_entry])) != 0) {
+      continue;
+    }
+
+    /* the start time tells a reused pid apart */
+    match = NULL;
+    for (i = 0; (i < nb_previous) && (match == NULL); i++) {
+      if ((previous[i].pid == (*entries)[nb_entry].pid) &&
+	  (previous[i].start_time == (*entries)[nb_entry].start_time)) {
+	match = &(previous[i]);
+      }
+    }
+
+    EETOP_computeRates(&((*entries)[nb_entry]), match);
+    nb_entry++;
+
+  }
+
+  closedir(dir);
+
+  qsort(*entries, nb_entry, sizeof(EETOP_Entry), EETOP_compareEntries);
+
+  return nb_entry;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+static void
+EETOP_printRanks(const EETOP_Entry * entries, int nb_entry, unsigned long now) {
+
+  const char * action = NULL;
+
+  double best = 0.0;
+
+  int i = 0;
+
+  int a = 0;
+
+  fprintf(stdout, "%-16s %6s %8s %7s %7s %10s %10s %10s %-12s %6s\n", "HOST", "RANK", "PID",
+	  "CPU%", "SLEEP%", "WAIT/s", "POLL/s", "YIELD_NS", "TOP_ACTION", "AGE_S");
+
+  for (i = 0; i < nb_entry; i++) {
+
+    /* the action with the most sleep, or with the most polls if none slept */
+    action = "-";
+    best = 0.0;
+    for (a = 0; a < EEPROBE_NB_ACTION; a++) {
+      if (entries[i].action_sleep[a] > best) {
+	best = entries[i].action_sleep[a];
+	action = EEPROBE_getActionName(a);
+      }
+    }
+    for (a = 0; (a < EEPROBE_NB_ACTION) && (best == 0.0); a++) {
+      if (entries[i].action_poll[a] > 0.0) {
+	best = entries[i].action_poll[a];
+	action = EEPROBE_getActionName(a);
+      }
+    }
+
+    fprintf(stdout, "%-16.16s %6d %8d %7.1f %7.1f %10.1f %10.1f %10ld %-12s ",
+	    entries[i].hostname, entries[i].rank, entries[i].pid,
+	    100.0 * entries[i].cpu, 100.0 * entries[i].sleep, entries[i].wait,
+	    entries[i].poll, entries[i].stats.current_yield_time, action);
+
+    if (entries[i].alive) {
+      fprintf(stdout, "%6.1f\n",
+	      (now > entries[i].stats.time) ? (now - entries[i].stats.time) / 1e6 : 0.0);
+    } else {
+      fprintf(stdout, "%6s\n", "dead");
+    }
+
+  }
+
+}
+
+static void
+EETOP_printNodes(const EETOP_Entry * entries, int nb_entry) {
+
+  double cpu = 0.0;
+
+  double sleep = 0.0;
+
+  double wait = 0.0;
+
+  double poll = 0.0;
+
+  int nb_rank = 0;
+
+  int i = 0;
+
+  fprintf(stdout, "%-16s %6s %8s %8s %10s %10s\n", "HOST", "RANKS", "CPU%", "SLEEP%",
+	  "WAIT/s", "POLL/s");
+
+  /* entries are sorted by host */
+  for (i = 0; i < nb_entry; i++) {
+
+    if (entries[i].alive) {
+      nb_rank++;
+      cpu += entries[i].cpu;
+      sleep += entries[i].sleep;
+      wait += entries[i].wait;
+      poll += entries[i].poll;
+    }
+
+    if ((i == nb_entry - 1) || (strcmp(entries[i].hostname, entries[i + 1].hostname) != 0)) {
+      fprintf(stdout, "%-16.16s %6d %8.1f %8.1f %10.1f %10.1f\n", entries[i].hostname,
+	      nb_rank, 100.0 * cpu, 100.0 * sleep, wait, poll);
+      nb_rank = 0;
+      cpu = 0.0;
+      sleep = 0.0;
+      wait = 0.0;
+      poll = 0.0;
+    }
+
+  }
+
+}
+
+static void
+EETOP_printActions(const EETOP_Entry * entries, int nb_entry) {
+
+  double sleep = 0.0;
+
+  double wait = 0.0;
+
+  double poll = 0.0;
+
+  int i = 0;
+
+  int a = 0;
+
+  fprintf(stdout, "%-20s %8s %10s %10s\n", "ACTION", "SLEEP%", "WAIT/s", "POLL/s");
+
+  for (a = 0; a < EEPROBE_NB_ACTION; a++) {
+
+    sleep = 0.0;
+    wait = 0.0;
+    poll = 0.0;
+    for (i = 0; i < nb_entry; i++) {
+      if (entries[i].alive) {
+	sleep += entries[i].action_sleep[a];
+	wait += entries[i].action_wait[a];
+	poll += entries[i].action_poll[a];
+      }
+    }
+
+    if ((sleep > 0.0) || (wait > 0.0) || (poll > 0.0)) {
+      fprintf(stdout, "%-20s %8.1f %10.1f %10.1f\n", EEPROBE_getActionName(a),
+	      100.0 * sleep, wait, poll);
+    }
+
+  }
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  EETOP_View view = EETOP_VIEW_RANK;
+
+  EETOP_Entry * entries = NULL;
+
+  EETOP_Entry * previous = NULL;
+
+  EETOP_Entry * swap = NULL;
+
+  const char * directory = "/dev/shm";
+
+  struct timespec interval;
+
+  long interval_ms = EETOP_INTERVAL_MS;
+
+  long nb_refresh = 0;
+
+  long refresh = 0;
+
+  int capacity = 0;
+
+  int previous_capacity = 0;
+
+  int swap_capacity = 0;
+
+  int nb_entry = 0;
+
+  int nb_previous = 0;
+
+  int batch = 0;
+
+  int valid = 1;
+
+  int option = 0;
+
+  while ((option = getopt(argc, argv, "d:i:n:v:b")) != -1) {
+    switch (option) {
+    case 'd': directory = optarg; break;
+    case 'i': interval_ms = strtol(optarg, NULL, 10); break;
+    case 'n': nb_refresh = strtol(optarg, NULL, 10); break;
+    case 'v':
+      if (strcmp(optarg, "rank") == 0) {
+	view = EETOP_VIEW_RANK;
+      } else if (strcmp(optarg, "node") == 0) {
+	view = EETOP_VIEW_NODE;
+      } else if (strcmp(optarg, "action") == 0) {
+	view = EETOP_VIEW_ACTION;
+      } else {
+	valid = 0;
+      }
+      break;
+    case 'b': batch = 1; break;
+    default: valid = 0; break;
+    }
+  }
+
+  if (!valid || (interval_ms <= 0) || (nb_refresh < 0)) {
+    fprintf(stderr, "Usage: %s [-d dir] [-i interval_ms] [-n count] [-v rank|node|action] [-b]\n",
+	    argv[0]);
+    return 1;
+  }
+
+  interval.tv_sec = interval_ms / 1000;
+  interval.tv_nsec = (interval_ms % 1000) * 1000000;
+
+  for (refresh = 0; (nb_refresh == 0) || (refresh < nb_refresh); refresh++) {
+
+    if (refresh > 0) {
+      nanosleep(&interval, NULL);
+    }
+
+    nb_entry = EETOP_scan(directory, &entries, &capacity, previous, nb_previous);
+
+    if (!batch) {
+      fprintf(stdout, "\033[H\033[J");
+    }
+    fprintf(stdout, "eeprobe-top %s: %d process(es)\n", directory, nb_entry);
+
+    switch (view) {
+    case EETOP_VIEW_NODE:
+      EETOP_printNodes(entries, nb_entry);
+      break;
+    case EETOP_VIEW_ACTION:
+      EETOP_printActions(entries, nb_entry);
+      break;
+    default:
+      EETOP_printRanks(entries, nb_entry, EEPROBE_getTime());
+      break;
+    }
+    fprintf(stdout, "\n");
+    fflush(stdout);
+
+    swap = previous;
+    previous = entries;
+    entries = swap;
+    nb_previous = nb_entry;
+    swap_capacity = previous_capacity;
+    previous_capacity = capacity;
+    capacity = swap_capacity;
+
+  }
+
+  free(entries);
+  free(previous);
+
+  return 0;
+
+}
+
+/* ---------------------------------------------------------------------------------- */
@@ -0,0 +1,524 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+
+#ifndef EEPROBE_HPP
+#define EEPROBE_HPP
+
+/* coroutine_handle, suspend_always */
+#include <coroutine>
+
+/* exception_ptr */
+#include <exception>
+
+/* logic_error */
+#include <stdexcept>
+
+/* size_t */
+#include <cstddef>
+
+/* exchange */
+#include <utility>
+
+/* vector */
+#include <vector>
+
+/* MPI, EEPROBE_Backoff */
+#include "eeprobe.h"
+
+namespace eeprobe {
+
+/* ---------------------------------------------------------------------------------- */
+
+class scheduler;
+
+  /**
+   * Coroutine type run by the EEProbe scheduler. A task is created by calling a
+   * coroutine function returning eeprobe::task and is handed to
+   * scheduler::spawn(). It does not start before the scheduler runs it.
+   */
+class task {
+
+public:
+
+  struct promise_type {
+
+    scheduler * sched = nullptr;
+
+    std::size_t index = 0;
+
+    std::exception_ptr exception;
+
+    task get_return_object() {
+      return task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    std::suspend_always final_suspend() noexcept { return {}; }
+
+    void return_void() noexcept {}
+
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+  };
+
+  using handle = std::coroutine_handle<promise_type>;
+
+  task(task && other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+  task(const task &) = delete;
+
+  task & operator=(const task &) = delete;
+
+  ~task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  handle release() noexcept { return std::exchange(handle_, nullptr); }
+
+private:
+
+  explicit task(handle h) noexcept : handle_(h) {}
+
+  handle handle_;
+
+};
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Single-threaded scheduler multiplexing the MPI requests of many tasks.
+   * Pending requests are kept in a flat array and tested in a batch with
+   * MPI_Testsome. Tasks whose request completed are resumed, and the EEProbe
+   * micro-sleep is applied only when no task is runnable. Thousands of
+   * outstanding requests therefore cost a single polling loop.
+   */
+class scheduler {
+
+public:
+
+  /**
+   * @param enable Enable or disable the micro-sleep mechanism. When disabled,
+   * the scheduler busy-polls its pending requests.
+   */
+  explicit scheduler(EEPROBE_Enable enable = EEPROBE_ENABLE) : enable_(enable) {}
+
+  scheduler(const scheduler &) = delete;
+
+  scheduler & operator=(const scheduler &) = delete;
+
+  /**
+   * Destroy the remaining tasks, for instance after run() threw. Their
+   * outstanding operations still write into buffers of the task frames, so
+   * they are completed first: receives are cancelled, other operations are
+   * waited for.
+   */
+  ~scheduler() {
+
+    int finalized = 0;
+
+    MPI_Finalized(&finalized);
+
+    for (std::size_t i = 0; (i < requests_.size()) && (finalized == 0); i++) {
+      if (slots_[i].cancel) {
+	MPI_Cancel(&requests_[i]);
+      }
+      MPI_Wait(&requests_[i], MPI_STATUS_IGNORE);
+    }
+
+    for (task::handle h : tasks_) {
+      h.destroy();
+    }
+
+  }
+
+  /**
+   * Hand a task over to the scheduler. The task starts during the next run().
+   * @param t Task to schedule.
+   */
+  void spawn(task t) {
+    task::handle h = t.release();
+    h.promise().sched = this;
+    h.promise().index = tasks_.size();
+    tasks_.push_back(h);
+    ready_.push_back(h);
+  }
+
+  /**
+   * Run the scheduled tasks until all of them have returned. An exception
+   * escaping from a task is rethrown here, once the other runnable tasks of
+   * the same batch have run. The remaining tasks stay scheduled, and run()
+   * can be called again. A task whose operation fails
+   * resumes with the MPI error code from co_await, the other tasks keep
+   * waiting for their own operations.
+   */
+  void run() {
+
+    EEPROBE_Backoff backoff;
+
+    std::vector<task::handle> runnable;
+
+    int completed = 0;
+
+    EEPROBE_Backoff_init(&backoff);
+
+    while (!tasks_.empty()) {
+
+      runnable.swap(ready_);
+      for (task::handle h : runnable) {
+	resume(h);
+      }
+      runnable.clear();
+
+      if (exception_) {
+	std::rethrow_exception(std::exchange(exception_, nullptr));
+      }
+
+      if (tasks_.empty()) {
+	break;
+      }
+
+      if (requests_.empty()) {
+	if (ready_.empty()) {
+	  throw std::logic_error("eeprobe::scheduler: tasks suspended without pending request");
+	}
+	continue;
+      }
+
+      completed = poll();
+
+      if ((completed == 0) && ready_.empty()) {
+	if (enable_ == EEPROBE_ENABLE) {
+	  EEPROBE_Backoff_yield(&backoff, EEPROBE_SCHEDULER);
+	}
+      } else {
+	EEPROBE_Backoff_reset(&backoff);
+      }
+
+    }
+
+  }
+
+  /**
+   * Returns the number of requests currently tracked by the scheduler.
+   * @return Number of pending requests.
+   */
+  std::size_t pending() const noexcept { return requests_.size(); }
+
+  /**
+   * Register a started request. Used by the awaitables of this header.
+   * @param request Active request handle.
+   * @param waiter Task resumed when the request completes.
+   * @param status Status object filled on completion, or MPI_STATUS_IGNORE.
+   * @param err MPI routine error value written on completion.
+   * @param cancel Whether the request can be cancelled with MPI_Cancel when the
+   * scheduler is destroyed before it completes.
+   */
+  void submit(MPI_Request request, task::handle waiter, MPI_Status * status, int * err,
+	      bool cancel = false) {
+    requests_.push_back(request);
+    slots_.push_back(slot{waiter, status, err, cancel});
+  }
+
+private:
+
+  struct slot {
+    task::handle waiter;
+    MPI_Status * status;
+    int * err;
+    bool cancel;
+  };
+
+  /**
+   * Run a task until its next suspension. The exception of a task that threw
+   * is kept until the end of the batch, only the first one is rethrown.
+   */
+  void resume(task::handle h) {
+
+    std::exception_ptr exception;
+
+    std::size_t index = 0;
+
+    h.resume();
+
+    if (h.done()) {
+      exception = h.promise().exception;
+      index = h.promise().index;
+      tasks_[index] = tasks_.back();
+      tasks_[index].promise().index = index;
+      tasks_.pop_back();
+      h.destroy();
+      if (exception && !exception_) {
+	exception_ = exception;
+      }
+    }
+
+  }
+
+  /**
+   * Test the pending requests in a batch and queue the tasks of the completed
+   * ones. When MPI_Testsome reports errors in the statuses, the failed
+   * requests complete with their own error and the others stay pending. On any
+   * other failure the requests are tested one by one, so that only those
+   * whose MPI_Test completes or fails resume, and the operations still running
+   * on their buffers stay tracked.
+   */
+  int poll() {
+
+    int outcount = 0;
+
+    int count = static_cast<int>(requests_.size());
+
+    int err = MPI_SUCCESS;
+
+    indices_.resize(requests_.size());
+    statuses_.resize(requests_.size());
+
+    err = MPI_Testsome(count, requests_.data(), &outcount,
+		       indices_.data(), statuses_.data());
+
+    if ((err != MPI_SUCCESS) && (err != MPI_ERR_IN_STATUS)) {
+      return poll_each();
+    }
+
+    if (outcount == MPI_UNDEFINED) {
+      return 0;
+    }
+
+    for (int k = 0; k < outcount; k++) {
+      slot & s = slots_[indices_[k]];
+      if (s.status != MPI_STATUS_IGNORE) {
+	*s.status = statuses_[k];
+      }
+      *s.err = (err == MPI_ERR_IN_STATUS) ? statuses_[k].MPI_ERROR : MPI_SUCCESS;
+      ready_.push_back(s.waiter);
+    }
+
+    compact();
+
+    return outcount;
+
+  }
+
+  /**
+   * Test the pending requests one at a time. A request whose MPI_Test fails is
+   * dropped with the error, MPI giving no way to tell whether it is still
+   * active.
+   */
+  int poll_each() {
+
+    MPI_Status status;
+
+    int completed = 0;
+
+    int flag = 0;
+
+    int err = MPI_SUCCESS;
+
+    for (std::size_t i = 0; i < requests_.size(); i++) {
+      flag = 0;
+      err = MPI_Test(&requests_[i], &flag, &status);
+      if ((err != MPI_SUCCESS) || (flag != 0)) {
+	slot & s = slots_[i];
+	if ((flag != 0) && (s.status != MPI_STATUS_IGNORE)) {
+	  *s.status = status;
+	}
+	*s.err = err;
+	requests_[i] = MPI_REQUEST_NULL;
+	ready_.push_back(s.waiter);
+	completed++;
+      }
+    }
+
+    compact();
+
+    return completed;
+
+  }
+
+  /**
+   * Remove the completed requests, set to MPI_REQUEST_NULL, from the arrays.
+   */
+  void compact() {
+
+    std::size_t j = 0;
+
+    for (std::size_t i = 0; i < requests_.size(); i++) {
+      if (requests_[i] != MPI_REQUEST_NULL) {
+	requests_[j] = requests_[i];
+	slots_[j] = slots_[i];
+	j++;
+      }
+    }
+    requests_.resize(j);
+    slots_.resize(j);
+
+  }
+
+  EEPROBE_Enable enable_;
+
+  std::vector<task::handle> tasks_;
+
+  std::vector<task::handle> ready_;
+
+  std::vector<MPI_Request> requests_;
+
+  std::vector<slot> slots_;
+
+  std::vector<int> indices_;
+
+  std::vector<MPI_Status> statuses_;
+
+  std::exception_ptr exception_;
+
+};
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Awaitable starting a nonblocking MPI operation and suspending the calling
+   * task until the operation completes. The request is tested once before
+   * suspending so that already completed operations do not go through the
+   * scheduler. co_await returns the MPI routine error value. Only receives are
+   * marked as cancellable, MPI_Cancel being erroneous on collectives and
+   * deprecated on sends.
+   */
+template <typename Start>
+class request_awaiter {
+
+public:
+
+  request_awaiter(Start start, MPI_Status * status, bool cancel = false)
+    : start_(start), status_(status), cancel_(cancel) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  bool await_suspend(task::handle h) {
+
+    MPI_Request request = MPI_REQUEST_NULL;
+
+    int flag = 0;
+
+    err_ = start_(&request);
+
+    if (err_ == MPI_SUCCESS) {
+      err_ = MPI_Test(&request, &flag, status_);
+    }
+
+    if ((err_ != MPI_SUCCESS) || (flag != 0)) {
+      return false;
+    }
+
+    h.promise().sched->submit(request, h, status_, &err_, cancel_);
+
+    return true;
+
+  }
+
+  int await_resume() const noexcept { return err_; }
+
+private:
+
+  Start start_;
+
+  MPI_Status * status_;
+
+  bool cancel_;
+
+  int err_ = MPI_SUCCESS;
+
+};
+
+/* ---------------------------------------------------------------------------------- */
+
+  /**
+   * Wait for an already started request. The request handle is set to
+   * MPI_REQUEST_NULL, as MPI_Wait does.
+   */
+inline auto
+wait(MPI_Request * request, MPI_Status * status = MPI_STATUS_IGNORE) {
+  auto start = [request](MPI_Request * r) {
+    *r = *request;
+    *request = MPI_REQUEST_NULL;
+    return MPI_SUCCESS;
+  };
+  return request_awaiter<decltype(start)>(start, status);
+}
+
+inline auto
+recv(void * buf, int count, MPI_Datatype datatype, int source, int tag,
+     MPI_Comm comm, MPI_Status * status = MPI_STATUS_IGNORE) {
+  auto start = [=](MPI_Request * r) {
+    return MPI_Irecv(buf, count, datatype, source, tag, comm, r);
+  };
+  return request_awaiter<decltype(start)>(start, status, true);
+}
+
+inline auto
+send(const void * buf, int count, MPI_Datatype datatype, int dest, int tag,
+     MPI_Comm comm) {
+  auto start = [=](MPI_Request * r) {
+    return MPI_Isend(buf, count, datatype, dest, tag, comm, r);
+  };
+  return request_awaiter<decltype(start)>(start, MPI_STATUS_IGNORE);
+}
+
+inline auto
+reduce(const void * sendbuf, void * recvbuf, int count, MPI_Datatype datatype,
+       MPI_Op op, int root, MPI_Comm comm) {
+  auto start = [=](MPI_Request * r) {
+    return MPI_Ireduce(sendbuf, recvbuf, count, datatype, op, root, comm, r);
+  };
+  return request_awaiter<decltype(start)>(start, MPI_STATUS_IGNORE);
+}
+
+inline auto
+allreduce(const void * sendbuf, void * recvbuf, int count, MPI_Datatype datatype,
+	  MPI_Op op, MPI_Comm comm) {
+  auto start = [=](MPI_Request * r) {
+    return MPI_Iallreduce(sendbuf, recvbuf, count, datatype, op, comm, r);
+  };
+  return request_awaiter<decltype(start)>(start, MPI_STATUS_IGNORE);
+}
+
+inline auto
+bcast(void * buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) {
+  auto start = [=](MPI_Request * r) {
+    return MPI_Ibcast(buffer, count, datatype, root, comm, r);
+  };
+  return request_awaiter<decltype(start)>(start, MPI_STATUS_IGNORE);
+}
+
+inline auto
+barrier(MPI_Comm comm) {
+  auto start = [=](MPI_Request * r) {
+    return MPI_Ibarrier(comm, r);
+  };
+  return request_awaiter<decltype(start)>(start, MPI_STATUS_IGNORE);
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+} // namespace eeprobe
+
+#endif
@@ -0,0 +1,181 @@
+
+    /* EEProbe: Energy Efficient Probe for MPI */
+    /* Copyright (C) 2020 Loïc Cudennec */
+
+    /* This program is free software: you can redistribute it and/or modify */
+    /* it under the terms of the GNU General Public License as published by */
+    /* the Free Software Foundation, either version 3 of the License, or */
+    /* any later version. */
+
+    /* This program is distributed in the hope that it will be useful, */
+    /* but WITHOUT ANY WARRANTY; without even the implied warranty of */
+    /* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the */
+    /* GNU General Public License for more details. */
+
+    /* You should have received a copy of the GNU General Public License */
+    /* along with this program.  If not, see <https://www.gnu.org/licenses/>. */
+
+
+/* ---------------------------------------------------------------------------------- */
+
+/* assert */
+#include <cassert>
+
+/* fprintf */
+#include <cstdio>
+
+/* strcmp */
+#include <cstring>
+
+/* clock_nanosleep */
+#include <time.h>
+
+/* vector */
+#include <vector>
+
+/* ---------------------------------------------------------------------------------- */
+
+#include "eeprobe.hpp"
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEPROBE_RANK_SEND 0
+
+#define EEPROBE_RANK_RECV 1
+
+/* ---------------------------------------------------------------------------------- */
+
+#define EEPROBE_NB_ITER 12
+
+#define EEPROBE_NB_TASKS 1000
+
+#define EEPROBE_INTER_MSG_SLEEP_S 1
+#define EEPROBE_INTER_MSG_SLEEP_NS 0
+
+/* ---------------------------------------------------------------------------------- */
+
+static eeprobe::task
+EEPROBE_sender(std::vector<int> & buffer, unsigned long start_time) {
+
+  struct timespec sender_sleep;
+
+  int err = MPI_SUCCESS;
+
+  sender_sleep.tv_sec = EEPROBE_INTER_MSG_SLEEP_S;
+  sender_sleep.tv_nsec = EEPROBE_INTER_MSG_SLEEP_NS;
+
+  for (int i = 0; i < EEPROBE_NB_ITER; i++) {
+
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &sender_sleep, NULL);
+
+    for (int t = 0; t < EEPROBE_NB_TASKS; t++) {
+      buffer[t] = i;
+      err = co_await eeprobe::send(&buffer[t], 1, MPI_INT, EEPROBE_RANK_RECV, t,
+				   MPI_COMM_WORLD);
+      assert(err == MPI_SUCCESS);
+    }
+
+    fprintf(stdout, "%lu rank %d send %d x %d\n", EEPROBE_getTime() - start_time,
+	    EEPROBE_RANK_SEND, i, EEPROBE_NB_TASKS);
+
+  }
+
+}
+
+static eeprobe::task
+EEPROBE_receiver(int tag, int & received) {
+
+  int value = 0;
+
+  int err = MPI_SUCCESS;
+
+  for (int i = 0; i < EEPROBE_NB_ITER; i++) {
+    err = co_await eeprobe::recv(&value, 1, MPI_INT, EEPROBE_RANK_SEND, tag,
+				 MPI_COMM_WORLD);
+    assert(err == MPI_SUCCESS);
+    assert(value == i);
+    received++;
+  }
+
+}
+
+static eeprobe::task
+EEPROBE_collective(int rank, unsigned long start_time) {
+
+  int value = 0;
+
+  int result = 0;
+
+  int err = MPI_SUCCESS;
+
+  for (int i = 0; i < EEPROBE_NB_ITER; i++) {
+    value = rank + 1 + i;
+    err = co_await eeprobe::allreduce(&value, &result, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    assert(err == MPI_SUCCESS);
+    fprintf(stdout, "%lu rank %d allreduce %d result %d total_sleep_time %lu\n",
+	    EEPROBE_getTime() - start_time, rank, i, result,
+	    EEPROBE_getTotalSleepTimeScheduler());
+  }
+
+}
+
+/* ---------------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[]) {
+
+  int rank = 0;
+
+  int nr = 0;
+
+  int received = 0;
+
+  EEPROBE_Enable enable = EEPROBE_ENABLE;
+
+  unsigned long start_time = 0;
+
+  std::vector<int> buffer(EEPROBE_NB_TASKS);
+
+  start_time = EEPROBE_getTime();
+
+  if ((argc > 1) && (strcmp(argv[1], "disable") == 0)) {
+    enable = EEPROBE_DISABLE;
+  }
+
+  MPI_Init(&argc, &argv);
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nr);
+
+  if (nr >= 2) {
+
+    eeprobe::scheduler sched(enable);
+
+    if (rank == EEPROBE_RANK_SEND) {
+      sched.spawn(EEPROBE_sender(buffer, start_time));
+    } else if (rank == EEPROBE_RANK_RECV) {
+      for (int t = 0; t < EEPROBE_NB_TASKS; t++) {
+	sched.spawn(EEPROBE_receiver(t, received));
+      }
+    }
+
+    sched.spawn(EEPROBE_collective(rank, start_time));
+
+    sched.run();
+
+    if (rank == EEPROBE_RANK_RECV) {
+      fprintf(stdout, "%lu rank %d received %d messages total_sleep_time %lu\n",
+	      EEPROBE_getTime() - start_time, rank, received, EEPROBE_getTotalSleepTime());
+    }
+
+  } else {
+    fprintf(stdout, "Warning: MPI task nr is %d. Expected >= 2. Usage:\nmpirun -np 2 %s\nmpirun -np 2 %s disable\n",
+	    nr, argv[0], argv[0]);
+  }
+
+  MPI_Finalize();
+
+  return 0;
+}
+
+/* ---------------------------------------------------------------------------------- */
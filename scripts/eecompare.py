@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+
+    # EEProbe: Energy Efficient Probe for MPI
+    # Copyright (C) 2020 Loic Cudennec
+
+    # This program is free software: you can redistribute it and/or modify
+    # it under the terms of the GNU General Public License as published by
+    # the Free Software Foundation, either version 3 of the License, or
+    # any later version.
+
+    # This program is distributed in the hope that it will be useful,
+    # but WITHOUT ANY WARRANTY; without even the implied warranty of
+    # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    # GNU General Public License for more details.
+
+    # You should have received a copy of the GNU General Public License
+    # along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+
+# ----------------------------------------------------------------------------------
+
+# Comparison of EEProbe with the idle modes of the MPI runtime. The runtime
+# behind mpirun is detected from its version string (Open MPI, MPICH or Intel
+# MPI), and the eedriver benchmark (C/bench/eedriver) runs the same scenario
+# with the EEProbe micro-sleep and with each idle mode of the runtime, set
+# through its environment variables. The EEProbe runs use the default
+# busy-polling mode of the runtime. The output is a table of latency and CPU
+# time per pattern and message size, and optionally the combined runs as CSV,
+# readable by eeplot.py.
+#
+# python3 ./eecompare.py --np 4 --driver ../C/bench/eedriver --driver-args "-p pingpong,collectives -d poisson"
+# python3 ./eecompare.py --np 8 --mpirun-args "--oversubscribe" --output compare.csv
+
+# argv
+import sys
+
+# environ, remove
+import os
+
+# ArgumentParser
+import argparse
+
+# DictWriter
+import csv
+
+# load
+import json
+
+# split
+import shlex
+
+# run
+import subprocess
+
+# mkstemp
+import tempfile
+
+# defaultdict
+from collections import defaultdict
+
+
+# ----------------------------------------------------------------------------------
+
+# version string of mpirun --version, checked in this order
+runtime_signatures = [('intel', 'Intel(R) MPI'),
+                      ('openmpi', 'Open MPI'),
+                      ('openmpi', 'OpenRTE'),
+                      ('mpich', 'HYDRA'),
+                      ('mpich', 'MPICH')]
+
+# idle modes of each runtime, the first one is the busy-polling default used by
+# the EEProbe runs
+runtime_modes = {
+    'openmpi': [('busy', {'OMPI_MCA_mpi_yield_when_idle': '0'}),
+                ('yield', {'OMPI_MCA_mpi_yield_when_idle': '1'})],
+    'mpich': [('busy', {}),
+              ('yield', {'MPIR_CVAR_POLLS_BEFORE_YIELD': '1'}),
+              ('async', {'MPIR_CVAR_ASYNC_PROGRESS': '1'})],
+    'intel': [('busy', {}),
+              ('wait', {'I_MPI_WAIT_MODE': '1'}),
+              ('async', {'I_MPI_ASYNC_PROGRESS': '1'})],
+    'unknown': [('busy', {})]}
+
+eeprobe_modes = ['enable', 'auto']
+
+table_columns = [('config', '%-24s', lambda row, base: row['config']),
+                 ('p50 (us)', '%10s', lambda row, base: '%.1f' % (row['latency_p50_ns'] / 1000.0)),
+                 ('p99 (us)', '%10s', lambda row, base: '%.1f' % (row['latency_p99_ns'] / 1000.0)),
+                 ('cpu (s)', '%10s', lambda row, base: '%.4f' % row['cpu_s']),
+                 ('cpu/busy', '%9s', lambda row, base: ('%.2f' % (row['cpu_s'] / base['cpu_s'])) if base and base['cpu_s'] > 0 else '-'),
+                 ('wakeups', '%9s', lambda row, base: '%d' % row['wakeups'])]
+
+
+# ----------------------------------------------------------------------------------
+
+def detectRuntime(mpirun):
+    try:
+        result = subprocess.run([mpirun, '--version'], capture_output=True, text=True)
+    except OSError:
+        return 'unknown'
+    version = result.stdout + result.stderr
+    for runtime, signature in runtime_signatures:
+        if signature in version:
+            return runtime
+    return 'unknown'
+
+
+def getConfigs(runtime):
+    modes = runtime_modes[runtime]
+    configs = []
+    for mode in eeprobe_modes:
+        configs.append(('eeprobe-' + mode, mode, modes[0][1]))
+    for name, env in modes:
+        configs.append((runtime + '-' + name, 'disable', env))
+    return configs
+
+
+# ----------------------------------------------------------------------------------
+
+def runConfig(args, label, mode, env):
+    fd, path = tempfile.mkstemp(suffix='.json')
+    os.close(fd)
+    command = ([args.mpirun, '-np', str(args.np)] + shlex.split(args.mpirun_args)
+               + [args.driver] + shlex.split(args.driver_args)
+               + ['-m', mode, '-l', label, '-o', 'json', '-f', path])
+    print('eecompare: ' + ' '.join(key + '=' + value for key, value in env.items())
+          + (' ' if env else '') + ' '.join(command))
+    try:
+        result = subprocess.run(command, env=dict(os.environ, **env))
+        if result.returncode != 0:
+            print('eecompare: ' + label + ' failed with code ' + str(result.returncode))
+            return []
+        with open(path, 'r') as fr:
+            rows = json.load(fr)
+    finally:
+        os.remove(path)
+    for row in rows:
+        row['runtime_env'] = ' '.join(key + '=' + value for key, value in env.items())
+    return rows
+
+
+# ----------------------------------------------------------------------------------
+
+def printTable(rows, baseline):
+    groups = defaultdict(list)
+    for row in rows:
+        groups[(row['pattern'], int(row['bytes']))].append(row)
+    header = ' '.join(fmt % name for name, fmt, value in table_columns)
+    for pattern, size in sorted(groups):
+        base = None
+        for row in groups[(pattern, size)]:
+            if row['config'] == baseline:
+                base = row
+        print('')
+        print(pattern + ' ' + str(size) + ' B')
+        print(header)
+        for row in groups[(pattern, size)]:
+            print(' '.join(fmt % value(row, base) for name, fmt, value in table_columns))
+
+
+def writeRows(rows, output):
+    with open(output, 'w', newline='') as fw:
+        writer = csv.DictWriter(fw, fieldnames=list(rows[0].keys()))
+        writer.writeheader()
+        writer.writerows(rows)
+    print('eecompare: ' + str(len(rows)) + ' run(s) written to ' + output)
+
+
+# ----------------------------------------------------------------------------------
+
+def main(argv):
+
+    parser = argparse.ArgumentParser(description='Compare EEProbe with the idle modes of the MPI runtime', usage='python3 ./eecompare.py [options]')
+    parser.add_argument('--np', type=int, default=2,
+                        help='number of MPI ranks (2)')
+    parser.add_argument('--mpirun', type=str, default='mpirun',
+                        help='MPI launcher (mpirun)')
+    parser.add_argument('--mpirun-args', type=str, default='',
+                        help='extra launcher arguments, e.g. "--oversubscribe"')
+    parser.add_argument('--driver', type=str, default=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'C', 'bench', 'eedriver'),
+                        help='path to the eedriver binary (../C/bench/eedriver)')
+    parser.add_argument('--driver-args', type=str, default='-p pingpong,fanout,allreduce -s 8 -d poisson -g 1000000 -n 1000',
+                        help='scenario passed to eedriver, without -m, -l, -o and -f')
+    parser.add_argument('--runtime', type=str, default='detect',
+                        choices=['detect'] + sorted(runtime_modes),
+                        help='MPI runtime whose idle modes are compared (detect)')
+    parser.add_argument('--output', type=str, default='',
+                        help='CSV file receiving the combined runs')
+    args = parser.parse_args()
+
+    runtime = args.runtime
+    if runtime == 'detect':
+        runtime = detectRuntime(args.mpirun)
+    print('eecompare: runtime ' + runtime)
+
+    rows = []
+    for label, mode, env in getConfigs(runtime):
+        rows += runConfig(args, label, mode, env)
+
+    if rows:
+        printTable(rows, runtime + '-' + runtime_modes[runtime][0][0])
+        if args.output:
+            writeRows(rows, args.output)
+
+
+# ----------------------------------------------------------------------------------
+
+if __name__  == "__main__":
+    main(sys.argv)
+
+
+# ----------------------------------------------------------------------------------
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+
+    # EEProbe: Energy Efficient Probe for MPI
+    # Copyright (C) 2020 Loic Cudennec
+
+    # This program is free software: you can redistribute it and/or modify
+    # it under the terms of the GNU General Public License as published by
+    # the Free Software Foundation, either version 3 of the License, or
+    # any later version.
+
+    # This program is distributed in the hope that it will be useful,
+    # but WITHOUT ANY WARRANTY; without even the implied warranty of
+    # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    # GNU General Public License for more details.
+
+    # You should have received a copy of the GNU General Public License
+    # along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+
+# ----------------------------------------------------------------------------------
+
+# Energy/latency trade-off of the eedriver benchmark (C/bench/eedriver). Each
+# configuration (micro-sleep mode, yield times, policy) is a point per pattern
+# and message size: its cost on the x axis, the RAPL energy when measured and
+# the CPU time of all ranks otherwise, and its latency on the y axis.
+#
+# python3 ./eeplot.py --output tradeoff.png enable.csv disable.csv spin.json
+
+# argv
+import sys
+
+# ArgumentParser
+import argparse
+
+# DictReader
+import csv
+
+# load
+import json
+
+# defaultdict
+from collections import defaultdict
+
+
+# ----------------------------------------------------------------------------------
+
+def loadFile(path):
+    with open(path, 'r') as fr:
+        if path.endswith('.json'):
+            rows = json.load(fr)
+        else:
+            rows = list(csv.DictReader(fr))
+    for row in rows:
+        for key in row:
+            try:
+                row[key] = float(row[key])
+            except (TypeError, ValueError):
+                pass
+    return rows
+
+
+# ----------------------------------------------------------------------------------
+
+def plotRows(rows, output, percentile):
+
+    # imported here, so that --help works without matplotlib
+    import matplotlib
+    matplotlib.use('Agg')
+    import matplotlib.pyplot as plt
+
+    groups = defaultdict(list)
+    for row in rows:
+        groups[(row['pattern'], int(row['bytes']))].append(row)
+
+    # energy only if measured for every run
+    energy = all(row['energy_j'] >= 0 for row in rows)
+    xkey = 'energy_j' if energy else 'cpu_s'
+    xlabel = 'energy (J)' if energy else 'CPU time of all ranks (s)'
+    ykey = 'latency_' + percentile + '_ns'
+
+    ncol = min(3, len(groups))
+    nrow = (len(groups) + ncol - 1) // ncol
+    fig, axes = plt.subplots(nrow, ncol, figsize=(5 * ncol, 4 * nrow), squeeze=False)
+
+    for ax, (pattern, size) in zip(axes.flat, sorted(groups)):
+        for row in sorted(groups[(pattern, size)], key=lambda r: r[xkey]):
+            ax.scatter(row[xkey], row[ykey] / 1000.0)
+            ax.annotate(row['config'], (row[xkey], row[ykey] / 1000.0), fontsize=7)
+        ax.set_title(pattern + ' ' + str(size) + ' B')
+        ax.set_xlabel(xlabel)
+        ax.set_ylabel(percentile + ' latency (us)')
+        ax.set_yscale('log')
+
+    for ax in list(axes.flat)[len(groups):]:
+        ax.axis('off')
+
+    fig.tight_layout()
+    fig.savefig(output)
+    print('eeplot: ' + str(len(rows)) + ' run(s) plotted to ' + output)
+
+
+# ----------------------------------------------------------------------------------
+
+def main(argv):
+
+    parser = argparse.ArgumentParser(description='Plot the energy/latency trade-off of eedriver runs', usage='python3 ./eeplot.py [options] file [file ...]')
+    parser.add_argument('files', nargs='+',
+                        help='CSV or JSON output files of eedriver')
+    parser.add_argument('--output', type=str, default='eeplot.png',
+                        help='image file to write (eeplot.png)')
+    parser.add_argument('--percentile', type=str, default='p99',
+                        choices=['mean', 'p50', 'p90', 'p99', 'max'],
+                        help='latency shown on the y axis (p99)')
+    args = parser.parse_args()
+
+    rows = []
+    for path in args.files:
+        rows += loadFile(path)
+
+    if rows:
+        plotRows(rows, args.output, args.percentile)
+
+
+# ----------------------------------------------------------------------------------
+
+if __name__  == "__main__":
+    main(sys.argv)
+
+
+# ----------------------------------------------------------------------------------
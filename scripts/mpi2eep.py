@@ -29,6 +29,9 @@ import argparse
 # glob
 import glob
 
+# sub, escape
+import re
+
 
 # ----------------------------------------------------------------------------------
 
@@ -47,7 +50,40 @@ dic_c = {'MPI_Probe': 'EEPROBE_Probe',
          'MPI_Gatherv' : 'EEPROBE_Gatherv',
          'MPI_Allgather' : 'EEPROBE_Allgather',
          'MPI_Allgatherv' : 'EEPROBE_Allgatherv',
-         'MPI_Barrier' : 'EEPROBE_Barrier'}
+         'MPI_Barrier' : 'EEPROBE_Barrier',
+         'MPI_Send' : 'EEPROBE_Send',
+         'MPI_Ssend' : 'EEPROBE_Ssend',
+         'MPI_Rsend' : 'EEPROBE_Rsend',
+         'MPI_File_read' : 'EEPROBE_File_read',
+         'MPI_File_read_at' : 'EEPROBE_File_read_at',
+         'MPI_File_read_all' : 'EEPROBE_File_read_all',
+         'MPI_File_read_at_all' : 'EEPROBE_File_read_at_all',
+         'MPI_File_read_shared' : 'EEPROBE_File_read_shared',
+         'MPI_File_read_ordered' : 'EEPROBE_File_read_ordered',
+         'MPI_File_write' : 'EEPROBE_File_write',
+         'MPI_File_write_at' : 'EEPROBE_File_write_at',
+         'MPI_File_write_all' : 'EEPROBE_File_write_all',
+         'MPI_File_write_at_all' : 'EEPROBE_File_write_at_all',
+         'MPI_File_write_shared' : 'EEPROBE_File_write_shared',
+         'MPI_File_write_ordered' : 'EEPROBE_File_write_ordered'}
+
+# per-operation sleep counters printed before MPI_Finalize (label, getter suffix)
+counters_c = [('probe', 'Probe'), ('wait', 'Wait'), ('reduce', 'Reduce'),
+              ('allreduce', 'Allreduce'), ('alltoall', 'Alltoall'),
+              ('alltoallv', 'Alltoallv'), ('bcast', 'Bcast'), ('send', 'Send'),
+              ('ssend', 'Ssend'), ('rsend', 'Rsend'),
+              ('file_read', 'FileRead'), ('file_write', 'FileWrite'),
+              ('file_read_at', 'FileReadAt'), ('file_write_at', 'FileWriteAt'),
+              ('file_read_all', 'FileReadAll'), ('file_write_all', 'FileWriteAll'),
+              ('file_read_at_all', 'FileReadAtAll'), ('file_write_at_all', 'FileWriteAtAll'),
+              ('file_read_shared', 'FileReadShared'), ('file_write_shared', 'FileWriteShared'),
+              ('file_read_ordered', 'FileReadOrdered'), ('file_write_ordered', 'FileWriteOrdered')]
+
+finalize_c = ("printf(\"rank %d EEProbe sleep time (ns)"
+              + "".join(" " + label + " %lu" for label, _ in counters_c)
+              + "\\n\", my_rank"
+              + "".join(", EEPROBE_getTotalSleepTime" + getter + "()" for _, getter in counters_c)
+              + ");\nMPI_Finalize();")
 
 # ----------------------------------------------------------------------------------
 
@@ -59,10 +95,11 @@ def processFiles(files, filetype, dic, includepath=""):
         if filedata:
             count = 0
             for mpi_key in dic:
-                count += filedata.count(mpi_key)
-                filedata = filedata.replace(mpi_key, dic[mpi_key])
+                # whole words only, so that MPI_Send does not match MPI_Sendrecv
+                filedata, n = re.subn(r'\b' + re.escape(mpi_key) + r'\b', dic[mpi_key], filedata)
+                count += n
             if count > 0:
-                filedata = filedata.replace("MPI_Finalize();", "printf(\"rank %d EEProbe sleep time (ns) probe %lu wait %lu reduce %lu allreduce %lu alltoall %lu alltoallv %lu bcast %lu\\n\", my_rank, EEPROBE_getTotalSleepTimeProbe(), EEPROBE_getTotalSleepTimeWait(), EEPROBE_getTotalSleepTimeReduce(), EEPROBE_getTotalSleepTimeAllreduce(), EEPROBE_getTotalSleepTimeAlltoall(), EEPROBE_getTotalSleepTimeAlltoallv(), EEPROBE_getTotalSleepTimeBcast());\nMPI_Finalize();")
+                filedata = filedata.replace("MPI_Finalize();", finalize_c)
                 with open(fpath, 'w') as fw:
                     fw.write("#include \""+includepath+"eeprobe.h\"\n" + filedata)
                     print('file type ' + filetype + ' path ' + fpath + ' replaced ' + str(count) + ' MPI operation(s)')